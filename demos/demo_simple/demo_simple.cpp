@@ -8,10 +8,13 @@
 
 #define LOG_TAG "demo_simple"
 
+#include <math.h>
+
 #include <hltypes/henum.h>
 #include <hltypes/hfile.h>
 #include <hltypes/hlog.h>
 #include <hltypes/hstring.h>
+#include <hltypes/hthread.h>
 
 #include <liteser/liteser.h>
 #include <liteser/Serializable.h>
@@ -19,24 +22,38 @@
 #if defined(_WIN32) && !defined(_WINRT)
 #define TEST_FILENAME "../../bin/demo_simple.ls2"
 #define XML_FILENAME "../../bin/demo_simple.lsx"
+#define MAPPED_FILENAME "../../bin/demo_simple"
 #else
 #define TEST_FILENAME "demo_simple.ls2"
 #define XML_FILENAME "demo_simple.lsx"
+#define MAPPED_FILENAME "demo_simple"
 #endif
 
 static int __test_count = 0;
 
+static void __fail(chstr name)
+{
+	hlog::warn(LOG_TAG, "NO MATCH: " + name);
+	__test_count++;
+}
+
+static void __finishTest(chstr name)
+{
+	if (__test_count == 0)
+	{
+		hlog::write(LOG_TAG, name + " test was successful.");
+	}
+}
+
 #define CHECK_VALUE(name) \
 	if (this->name != other.name) \
 	{ \
-		hlog::warn(LOG_TAG, "NO MATCH: " #name); \
-		__test_count++; \
+		__fail(#name); \
 	}
 #define CHECK_VALUE_HARRAY_OBJECTS(name) \
 	if (this->name.size() != other.name.size()) \
 	{ \
-		hlog::warn(LOG_TAG, "NO MATCH: " #name); \
-		__test_count++; \
+		__fail(#name); \
 	} \
 	else \
 	{ \
@@ -45,6 +62,14 @@ static int __test_count = 0;
 			this->name[i]->check(*other.name[i]); \
 		} \
 	}
+// packed values only keep their precision, half floats are relative and fixed point values are absolute
+#define CHECK_VALUE_NEAR(name, tolerance) \
+	if (fabs(this->name - other.name) > (tolerance)) \
+	{ \
+		__fail(#name); \
+	}
+#define HALF_TOLERANCE(value) (fabs(value) * 0.001f)
+#define FIXED_TOLERANCE 0.01f
 
 class Type4
 {
@@ -199,6 +224,16 @@ public:
 		CHECK_VALUE(v_enum);
 	}
 
+	void change()
+	{
+		this->v_int32 = 64;
+		this->v_float = 3.0f;
+		this->v_bool = false;
+		this->v_harray_int += 16;
+		this->v_harray_type3 += new Type3();
+		this->v_hmap_hstr_int["changed"] = 1;
+	}
+
 protected:
 
 	LS_VARS
@@ -226,6 +261,308 @@ protected:
 };
 LS_CLASS_DEFINE(Type1);
 
+class Type5 : public liteser::Serializable
+{
+public:
+	LS_CLASS_DECLARE(Type5);
+	static int constructed;
+	static int destroyed;
+
+	Type5() : liteser::Serializable(), child(NULL), other(NULL)
+	{
+		++Type5::constructed;
+	}
+	~Type5()
+	{
+		delete this->child;
+		++Type5::destroyed;
+	}
+
+	LS_VARS
+	(
+		liteser::Serializable,
+		(Type5*) child,
+		(Type5*) other
+	);
+
+};
+LS_CLASS_DEFINE(Type5);
+int Type5::constructed = 0;
+int Type5::destroyed = 0;
+
+class Type6 : public liteser::Serializable
+{
+public:
+	LS_CLASS_DECLARE(Type6);
+	Type6() : liteser::Serializable()
+	{
+		this->name = "LAZY OWNER";
+	}
+	~Type6()
+	{
+		// an object that was never accessed was never created either
+		if (this->lazy.isLoaded())
+		{
+			delete this->lazy.get();
+		}
+	}
+
+	LS_VARS
+	(
+		liteser::Serializable,
+		(hstr) name,
+		(liteser::Lazy<Type3>) lazy
+	);
+
+};
+LS_CLASS_DEFINE(Type6);
+
+typedef liteser::Fixed<float, 100> FixedFloat;
+typedef liteser::Fixed<gvec2f, 100> FixedGvec2f;
+
+class Type7 : public liteser::Serializable
+{
+public:
+	LS_CLASS_DECLARE(Type7);
+	Type7() : liteser::Serializable()
+	{
+		this->halfFloat = 0.333333f;
+		this->halfVec3 = gvec3f(1.5f, -2.25f, 1000.0f);
+		this->fixedFloat = -12.34f;
+		this->fixedVec2 = gvec2f(0.5f, 300.01f);
+		for_iter (i, 0, 20)
+		{
+			this->halfFloats += liteser::Half<float>(i * 0.37f);
+			this->fixedFloats += FixedFloat(i * -1.23f);
+		}
+	}
+	~Type7() { }
+
+	void check(const Type7& other)
+	{
+		CHECK_VALUE_NEAR(halfFloat.value, HALF_TOLERANCE(this->halfFloat.value));
+		CHECK_VALUE_NEAR(halfVec3->x, HALF_TOLERANCE(this->halfVec3->x));
+		CHECK_VALUE_NEAR(halfVec3->y, HALF_TOLERANCE(this->halfVec3->y));
+		CHECK_VALUE_NEAR(halfVec3->z, HALF_TOLERANCE(this->halfVec3->z));
+		CHECK_VALUE_NEAR(fixedFloat.value, FIXED_TOLERANCE);
+		CHECK_VALUE_NEAR(fixedVec2->x, FIXED_TOLERANCE);
+		CHECK_VALUE_NEAR(fixedVec2->y, FIXED_TOLERANCE);
+		if (this->halfFloats.size() != other.halfFloats.size() || this->fixedFloats.size() != other.fixedFloats.size())
+		{
+			__fail("packed arrays");
+			return;
+		}
+		for_iter (i, 0, this->halfFloats.size())
+		{
+			CHECK_VALUE_NEAR(halfFloats[i].value, HALF_TOLERANCE(this->halfFloats[i].value));
+			CHECK_VALUE_NEAR(fixedFloats[i].value, FIXED_TOLERANCE);
+		}
+	}
+
+protected:
+	LS_VARS
+	(
+		liteser::Serializable,
+		(liteser::Half<float>) halfFloat,
+		(liteser::Half<gvec3f>) halfVec3,
+		(FixedFloat) fixedFloat,
+		(FixedGvec2f) fixedVec2,
+		(harray<liteser::Half<float> >) halfFloats,
+		(harray<FixedFloat>) fixedFloats
+	);
+
+};
+LS_CLASS_DEFINE(Type7);
+
+class Type8 : public liteser::Serializable
+{
+public:
+	LS_CLASS_DECLARE(Type8);
+	Type8() : liteser::Serializable()
+	{
+		// slowly changing samples with a few jumps and repeats
+		for_iter (i, 0, 1000)
+		{
+			this->samples += liteser::Series<double>(i % 100 == 0 ? -1000.0 : 20.0 + i * 0.01);
+			this->floatSamples += liteser::Series<float>((float)(i / 10));
+		}
+	}
+	~Type8() { }
+
+	void check(const Type8& other)
+	{
+		if (this->samples.size() != other.samples.size() || this->floatSamples.size() != other.floatSamples.size())
+		{
+			__fail("series");
+			return;
+		}
+		for_iter (i, 0, this->samples.size())
+		{
+			CHECK_VALUE(samples[i].value);
+			CHECK_VALUE(floatSamples[i].value);
+		}
+	}
+
+protected:
+	LS_VARS
+	(
+		liteser::Serializable,
+		(harray<liteser::Series<double> >) samples,
+		(harray<liteser::Series<float> >) floatSamples
+	);
+
+};
+LS_CLASS_DEFINE(Type8);
+
+class Type9 : public liteser::Serializable
+{
+public:
+	LS_CLASS_DECLARE(Type9);
+	Type9() : liteser::Serializable()
+	{
+		this->number = 9;
+		this->removed += new Type3();
+		this->removed += new Type3();
+		this->removedAgain += new Type3();
+		this->name = "OLDER LAYOUT";
+		this->object = new Type3();
+		this->sameObject = this->object;
+		// the string was first written within the removed objects
+		this->label = "NO WAY";
+	}
+	~Type9()
+	{
+		foreach (Type3*, it, this->removed)
+		{
+			delete (*it);
+		}
+		foreach (Type3*, it, this->removedAgain)
+		{
+			delete (*it);
+		}
+		delete this->object;
+	}
+
+	LS_VARS
+	(
+		liteser::Serializable,
+		(int) number,
+		(harray<Type3*>) removed,
+		(harray<Type3*>) removedAgain,
+		(hstr) name,
+		(Type3*) object,
+		(Type3*) sameObject,
+		(hstr) label
+	);
+
+};
+LS_CLASS_DEFINE(Type9);
+
+// a newer layout of Type9 with reordered, removed and added variables
+class Type10 : public liteser::Serializable
+{
+public:
+	LS_CLASS_DECLARE(Type10);
+	Type10() : liteser::Serializable()
+	{
+		this->number = 0;
+		this->added = 10;
+		this->object = NULL;
+		this->sameObject = NULL;
+	}
+	~Type10()
+	{
+		delete this->object;
+	}
+
+	void check(const Type9& other)
+	{
+		CHECK_VALUE(name);
+		CHECK_VALUE(number);
+		CHECK_VALUE(label);
+		if (this->added != 10)
+		{
+			__fail("added");
+		}
+		// objects and strings after the removed variables still have to resolve their references
+		if (this->object == NULL || this->sameObject != this->object)
+		{
+			__fail("object");
+		}
+		else
+		{
+			this->object->check(*other.object);
+		}
+	}
+
+	LS_VARS
+	(
+		liteser::Serializable,
+		(hstr) name,
+		(int) number,
+		(int) added,
+		(Type3*) object,
+		(Type3*) sameObject,
+		(hstr) label
+	);
+
+};
+LS_CLASS_DEFINE(Type10);
+
+static void __write(liteser::Serializable* object, const liteser::Options& options = liteser::Options())
+{
+	hfile file;
+	file.open(TEST_FILENAME, hfile::WRITE);
+	liteser::serialize(&file, object, options);
+	file.close();
+}
+
+template <typename T>
+static T* __load()
+{
+	T* loaded = NULL;
+	hfile file;
+	file.open(TEST_FILENAME);
+	liteser::deserialize(&file, (liteser::Serializable**)&loaded);
+	file.close();
+	return loaded;
+}
+
+template <typename T>
+static void __checkReload(T* object, const liteser::Options& options = liteser::Options())
+{
+	__write(object, options);
+	T* loaded = __load<T>();
+	object->check(*loaded);
+	delete loaded;
+}
+
+static Type10* __loadNewerLayout()
+{
+	// the stored class is created as the newer class that was registered with its name
+	liteser::Factory::Register<Type10> newer("Type9");
+	Type10* loaded = __load<Type10>();
+	liteser::Factory::Register<Type9> older("Type9");
+	return loaded;
+}
+
+class LoadThread : public hthread
+{
+public:
+	Type1* loaded;
+
+	LoadThread() : hthread(&LoadThread::_process), loaded(NULL)
+	{
+	}
+
+protected:
+	static void _process(hthread* thread)
+	{
+		((LoadThread*)thread)->loaded = __load<Type1>();
+	}
+
+};
+
 int main(int argc, char **argv)
 {
 	hfile file;
@@ -249,10 +586,7 @@ int main(int argc, char **argv)
 	file.close();
 	__test_count = 0;
 	type1.check(*loaded);
-	if (__test_count == 0)
-	{
-		hlog::write(LOG_TAG, "Serialization test was successful.");
-	}
+	__finishTest("Serialization");
 	delete loaded;
 	loaded = NULL;
 	// XML test
@@ -264,10 +598,7 @@ int main(int argc, char **argv)
 	file.close();
 	__test_count = 0;
 	type1.check(*loaded);
-	if (__test_count == 0)
-	{
-		hlog::write(LOG_TAG, "Serialization XML test was successful.");
-	}
+	__finishTest("Serialization XML");
 	delete loaded;
 	loaded = NULL;
 	// clone test
@@ -275,11 +606,266 @@ int main(int argc, char **argv)
 	liteser::clone(&type1, (liteser::Serializable**)&cloned);
 	__test_count = 0;
 	type1.check(*cloned);
-	if (__test_count == 0)
+	__finishTest("Cloning");
+	delete cloned;
+	// layout mismatch test
+	Type9 older;
+	__write(&older);
+	Type10* newer = __loadNewerLayout();
+	__test_count = 0;
+	newer->check(older);
+	delete newer;
+	__finishTest("Layout mismatch");
+	// thread test
+	__write(&type1);
+	LoadThread thread;
+	thread.start();
+	// both threads load at the same time, each with its own context
+	loaded = __load<Type1>();
+	thread.join();
+	__test_count = 0;
+	type1.check(*loaded);
+	type1.check(*thread.loaded);
+	delete loaded;
+	delete thread.loaded;
+	loaded = NULL;
+	__finishTest("Thread");
+	// mapped file test
+	file.open(MAPPED_FILENAME ".ls3", hfile::WRITE);
+	liteser::serialize(&file, &type1);
+	file.close();
+	__test_count = 0;
+	// the path is given without its extension and the file is decoded straight from mapped memory
+	if (!liteser::loadObjectFromFile(MAPPED_FILENAME, (liteser::Serializable**)&loaded) || loaded == NULL)
 	{
-		hlog::write(LOG_TAG, "Cloning test was successful.");
+		__fail("mapped object");
 	}
-	delete cloned;
+	else
+	{
+		type1.check(*loaded);
+	}
+	delete loaded;
+	loaded = NULL;
+	Type1 other;
+	harray<liteser::Serializable*> objects;
+	objects += &type1;
+	objects += &other;
+	file.open(MAPPED_FILENAME ".ls3", hfile::WRITE);
+	liteser::serialize(&file, objects);
+	file.close();
+	harray<liteser::Serializable*> loadedObjects;
+	if (!liteser::loadArrayFromFile(MAPPED_FILENAME, &loadedObjects) || loadedObjects.size() != objects.size())
+	{
+		__fail("mapped array");
+	}
+	else
+	{
+		for_iter (i, 0, objects.size())
+		{
+			((Type1*)objects[i])->check(*(Type1*)loadedObjects[i]);
+		}
+	}
+	foreach (liteser::Serializable*, it, loadedObjects)
+	{
+		delete (*it);
+	}
+	__finishTest("Mapped file");
+	// compression test
+	liteser::Options compressedOptions;
+	compressedOptions.compressed = true;
+	__test_count = 0;
+	__checkReload(&type1, compressedOptions);
+	// enough data for several batches of blocks
+	harray<int> numbers;
+	for_iter (i, 0, 1000000)
+	{
+		numbers += i * 7 % 1000;
+	}
+	Type1 large(numbers, harray<Type3*>(), arg3);
+	__checkReload(&large, compressedOptions);
+	__finishTest("Compression");
+	// indexed loading test
+	harray<liteser::Serializable*> elements;
+	for_iter (i, 0, 4)
+	{
+		elements += new Type5();
+	}
+	((Type5*)elements[0])->child = new Type5();
+	((Type5*)elements[3])->other = ((Type5*)elements[0])->child;
+	file.open(TEST_FILENAME, hfile::WRITE);
+	liteser::serializeIndexed(&file, elements);
+	file.close();
+	foreach (liteser::Serializable*, it, elements)
+	{
+		delete (*it);
+	}
+	elements.clear();
+	Type5::constructed = 0;
+	Type5::destroyed = 0;
+	// the element with the referenced object has to be loaded as well and is added after the requested one
+	file.open(TEST_FILENAME);
+	liteser::deserializeElements(&file, 3, 1, &elements);
+	file.close();
+	__test_count = 0;
+	if (elements.size() != 2 || ((Type5*)elements[0])->other == NULL || ((Type5*)elements[0])->other != ((Type5*)elements[1])->child)
+	{
+		__fail("referenced element");
+	}
+	foreach (liteser::Serializable*, it, elements)
+	{
+		delete (*it);
+	}
+	elements.clear();
+	Type5* element = NULL;
+	file.open(TEST_FILENAME);
+	liteser::deserializeElement(&file, 3, (liteser::Serializable**)&element, &elements);
+	file.close();
+	if (element == NULL || elements.size() != 1 || element->other != ((Type5*)elements[0])->child)
+	{
+		__fail("single referenced element");
+	}
+	delete element;
+	foreach (liteser::Serializable*, it, elements)
+	{
+		delete (*it);
+	}
+	elements.clear();
+	if (Type5::constructed != Type5::destroyed)
+	{
+		__fail(hsprintf("%d objects were created and %d were destroyed", Type5::constructed, Type5::destroyed));
+	}
+	__finishTest("Indexed loading");
+	// skipped variable test
+	liteser::Options prefixedOptions;
+	prefixedOptions.lengthPrefixed = true;
+	__write(&older, prefixedOptions);
+	// removed variables are skipped in one step unless they contain strings or classes that were not written before
+	newer = __loadNewerLayout();
+	__test_count = 0;
+	newer->check(older);
+	delete newer;
+	__finishTest("Skipped variable");
+	// lazy loading test
+	Type6 lazyOwner;
+	lazyOwner.lazy = new Type3();
+	__write(&lazyOwner);
+	Type6* lazyLoaded = __load<Type6>();
+	__test_count = 0;
+	if (lazyLoaded->name != lazyOwner.name || lazyLoaded->lazy.isLoaded())
+	{
+		__fail("lazy object");
+	}
+	// the object is decoded on first access, after the file was closed
+	else if (lazyLoaded->lazy.get() == NULL)
+	{
+		__fail("lazy object was not loaded");
+	}
+	else
+	{
+		lazyOwner.lazy->check(*lazyLoaded->lazy.get());
+	}
+	delete lazyLoaded;
+	__finishTest("Lazy loading");
+	// delta test
+	Type1 original;
+	__write(&original);
+	loaded = __load<Type1>();
+	liteser::Snapshot snapshot;
+	liteser::takeSnapshot(&original, &snapshot);
+	original.change();
+	file.open(TEST_FILENAME, hfile::WRITE);
+	liteser::serializeDelta(&file, &original, &snapshot);
+	file.close();
+	file.open(TEST_FILENAME);
+	liteser::applyDelta(&file, loaded);
+	file.close();
+	__test_count = 0;
+	original.check(*loaded);
+	delete loaded;
+	loaded = NULL;
+	__finishTest("Delta");
+	// string pool size test
+	liteser::Options poolOptions;
+	poolOptions.stringPoolSize = true;
+	__test_count = 0;
+	__checkReload(&type1, poolOptions);
+	poolOptions.compressed = true;
+	__checkReload(&large, poolOptions);
+	__finishTest("String pool size");
+	// columnar test
+	harray<liteser::Serializable*> rows;
+	for_iter (i, 0, 100)
+	{
+		harray<int> values;
+		values += i;
+		values += i * 3;
+		rows += new Type1(values, harray<Type3*>(), arg3);
+	}
+	file.open(TEST_FILENAME, hfile::WRITE);
+	liteser::serializeColumnar(&file, rows);
+	file.close();
+	harray<liteser::Serializable*> loadedRows;
+	file.open(TEST_FILENAME);
+	liteser::deserialize(&file, &loadedRows);
+	file.close();
+	__test_count = 0;
+	if (loadedRows.size() != rows.size())
+	{
+		__fail("columnar rows");
+	}
+	else
+	{
+		for_iter (i, 0, rows.size())
+		{
+			((Type1*)rows[i])->check(*(Type1*)loadedRows[i]);
+		}
+	}
+	foreach (liteser::Serializable*, it, rows)
+	{
+		delete (*it);
+	}
+	foreach (liteser::Serializable*, it, loadedRows)
+	{
+		delete (*it);
+	}
+	__finishTest("Columnar");
+	// packed number test
+	Type7 packed;
+	__test_count = 0;
+	__checkReload(&packed);
+	file.open(XML_FILENAME, hfile::WRITE);
+	liteser::xml::serialize(&file, &packed);
+	file.close();
+	Type7* loadedPacked = NULL;
+	file.open(XML_FILENAME);
+	liteser::xml::deserialize(&file, (liteser::Serializable**)&loadedPacked);
+	file.close();
+	packed.check(*loadedPacked);
+	delete loadedPacked;
+	__finishTest("Packed number");
+	// encoded array test
+	liteser::Options encodedOptions;
+	encodedOptions.encodedArrays = true;
+	__test_count = 0;
+	__checkReload(&type1, encodedOptions);
+	__checkReload(&large, encodedOptions);
+	encodedOptions.compressed = true;
+	__checkReload(&large, encodedOptions);
+	__finishTest("Encoded array");
+	// series test
+	Type8 series;
+	__test_count = 0;
+	__checkReload(&series);
+	__checkReload(&series, encodedOptions);
+	__finishTest("Series");
+	// compact integer test
+	liteser::Options compactOptions;
+	compactOptions.compactIntegers = true;
+	__test_count = 0;
+	__checkReload(&type1, compactOptions);
+	__checkReload(&large, compactOptions);
+	__checkReload(&packed, compactOptions);
+	__finishTest("Compact integer");
 	// finished
 	system("pause");
 	return 0;
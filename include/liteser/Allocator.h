@@ -0,0 +1,55 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines an interface for providing the memory of objects that are created while loading.
+
+#ifndef LITESER_ALLOCATOR_H
+#define LITESER_ALLOCATOR_H
+
+#include <hltypes/hstring.h>
+
+#include "liteserExport.h"
+
+namespace liteser
+{
+	class Serializable;
+
+	/// @brief Provides the memory of objects that Factory creates while one is set with Factory::setAllocator().
+	/// @note Objects that were placed in an allocator are destroyed by it and must not be deleted. Owners that delete the objects they were loaded with have to use Factory::release() instead, which also deletes objects that were created with new.
+	class liteserExport Allocator
+	{
+	public:
+		Allocator();
+		virtual ~Allocator();
+
+		/// @brief Gets memory for an object of the given class.
+		/// @param[in] classId ID of the class from Factory::getClassId().
+		/// @return Memory aligned for any type or NULL if the object should be created with new.
+		virtual void* allocate(int classId, chstr className, int size) = 0;
+		/// @brief Called once an object was constructed in memory from allocate().
+		virtual void addObject(Serializable* object) = 0;
+		/// @brief Called with the memory from allocate() when the object in it was released or could not be constructed, it must not be destroyed again.
+		virtual void release(void* memory) = 0;
+		/// @brief Destroys all objects and releases all memory at once.
+		virtual void clear() = 0;
+
+		/// @return The allocator that handed out the memory or NULL if it does not belong to any allocator.
+		/// @note While any allocator has memory, this takes a lock and searches the memory of all allocators, so it is only used by Factory::release().
+		static Allocator* _find(void* memory);
+
+	protected:
+		/// @brief Makes the memory that allocate() hands out from known so Factory::release() can find the allocator of an object.
+		void _addBlock(unsigned char* block, int size);
+		void _removeBlock(unsigned char* block);
+
+	};
+
+}
+#endif
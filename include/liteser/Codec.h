@@ -0,0 +1,305 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines the statically typed variable functions that the codecs generated by LS_VARS call.
+
+#ifndef LITESER_CODEC_H
+#define LITESER_CODEC_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <gtypes/Rectangle.h>
+#include <gtypes/Vector2.h>
+#include <gtypes/Vector3.h>
+#include <hltypes/harray.h>
+#include <hltypes/henum.h>
+#include <hltypes/hmap.h>
+#include <hltypes/hstring.h>
+#include <hltypes/hversion.h>
+
+#include "Lazy.h"
+#include "liteserExport.h"
+#include "Packed.h"
+#include "Ptr.h"
+#include "templates.h"
+#include "Type.h"
+
+namespace liteser
+{
+	class Serializable;
+
+	/// @brief The free memory in the output buffer of the current call, the codecs generated by LS_VARS write fixed size values directly into it.
+	struct FieldWriter
+	{
+		unsigned char* current;
+		unsigned char* end;
+		/// @brief Whether integers are stored as varints, which are written by the library.
+		bool compactIntegers;
+
+	};
+
+	/// @brief The data of the current call that can be read without refilling, the codecs generated by LS_VARS read fixed size values directly from it.
+	struct FieldReader
+	{
+		const unsigned char* current;
+		const unsigned char* end;
+		/// @brief Whether integers are stored as varints, which are read by the library.
+		bool compactIntegers;
+
+	};
+
+	// values that are not written directly, the library continues the writer after them
+	liteserExport void _dumpFieldValue(FieldWriter& writer, char* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, unsigned char* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, short* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, unsigned short* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, int* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, unsigned int* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, int64_t* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, uint64_t* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, float* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, double* value);
+	liteserExport void _dumpFieldValue(FieldWriter& writer, bool* value);
+	liteserExport void _dumpField(FieldWriter& writer, hstr* value);
+	liteserExport void _dumpField(FieldWriter& writer, hversion* value);
+	liteserExport void _dumpField(FieldWriter& writer, henum* value);
+	liteserExport void _dumpField(FieldWriter& writer, grectf* value);
+	liteserExport void _dumpField(FieldWriter& writer, gvec2f* value);
+	liteserExport void _dumpField(FieldWriter& writer, gvec3f* value);
+	liteserExport void _dumpField(FieldWriter& writer, grecti* value);
+	liteserExport void _dumpField(FieldWriter& writer, gvec2i* value);
+	liteserExport void _dumpField(FieldWriter& writer, gvec3i* value);
+	liteserExport void _dumpField(FieldWriter& writer, grectd* value);
+	liteserExport void _dumpField(FieldWriter& writer, gvec2d* value);
+	liteserExport void _dumpField(FieldWriter& writer, gvec3d* value);
+	liteserExport void _dumpField(FieldWriter& writer, Serializable* value);
+	liteserExport void _dumpField(FieldWriter& writer, Serializable** value);
+	liteserExport void _dumpField(FieldWriter& writer, LazyBase* value);
+	liteserExport void _dumpField(FieldWriter& writer, void* value, Type* type);
+
+	// values that are not read directly, the library continues the reader after them
+	liteserExport void _loadFieldValue(FieldReader& reader, char* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, unsigned char* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, short* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, unsigned short* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, int* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, unsigned int* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, int64_t* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, uint64_t* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, float* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, double* value);
+	liteserExport void _loadFieldValue(FieldReader& reader, bool* value);
+	liteserExport void _loadField(FieldReader& reader, hstr* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, hversion* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, henum* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, grectf* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, gvec2f* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, gvec3f* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, grecti* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, gvec2i* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, gvec3i* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, grectd* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, gvec2d* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, gvec3d* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, Serializable* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, Serializable** value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, LazyBase* value, const char* name);
+	liteserExport void _loadField(FieldReader& reader, void* value, Type* type, const char* name);
+
+	/// @brief Gets the type that is shared by all threads for a container or a packed value, creating it with the given function on first use.
+	liteserExport Type* _getSharedFieldType(Type** type, void (*assign)(Type*));
+
+	template <typename T>
+	inline void _assignFieldType(Type* type)
+	{
+		type->assign((VPtr<T>*)NULL);
+	}
+
+	/// @brief Gets the type of a container or a packed value, it is created only once for every C++ type and never for every object.
+	/// @note Every thread gets the shared type only once, since creating it has to be locked.
+	template <typename T>
+	inline Type* _getFieldType()
+	{
+		static Type* sharedType = NULL;
+		static LITESER_THREAD_LOCAL Type* type = NULL;
+		if (type == NULL)
+		{
+			type = _getSharedFieldType(&sharedType, &_assignFieldType<T>);
+		}
+		return type;
+	}
+
+	/// @brief Writes a value as it is in memory if there is enough room, the library makes room otherwise.
+	template <typename T>
+	inline void _dumpFieldDirect(FieldWriter& writer, T* value)
+	{
+#ifndef LITESER_BIG_ENDIAN
+		if ((size_t)(writer.end - writer.current) >= sizeof(T))
+		{
+			memcpy(writer.current, value, sizeof(T));
+			writer.current += sizeof(T);
+			return;
+		}
+#endif
+		_dumpFieldValue(writer, value);
+	}
+
+	/// @brief Reads a value as it is in memory if enough data is available, the library refills the data otherwise.
+	template <typename T>
+	inline void _loadFieldDirect(FieldReader& reader, T* value)
+	{
+#ifndef LITESER_BIG_ENDIAN
+		if ((size_t)(reader.end - reader.current) >= sizeof(T))
+		{
+			memcpy(value, reader.current, sizeof(T));
+			reader.current += sizeof(T);
+			return;
+		}
+#endif
+		_loadFieldValue(reader, value);
+	}
+
+	inline void _dumpField(FieldWriter& writer, char* value)			{ _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, unsigned char* value)	{ _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, float* value)			{ _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, double* value)			{ _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, short* value)			{ writer.compactIntegers ? _dumpFieldValue(writer, value) : _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, unsigned short* value)	{ writer.compactIntegers ? _dumpFieldValue(writer, value) : _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, int* value)				{ writer.compactIntegers ? _dumpFieldValue(writer, value) : _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, unsigned int* value)	{ writer.compactIntegers ? _dumpFieldValue(writer, value) : _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, int64_t* value)			{ writer.compactIntegers ? _dumpFieldValue(writer, value) : _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, uint64_t* value)		{ writer.compactIntegers ? _dumpFieldValue(writer, value) : _dumpFieldDirect(writer, value); }
+	inline void _dumpField(FieldWriter& writer, bool* value)
+	{
+		if (writer.current != writer.end)
+		{
+			*writer.current = (*value ? 1 : 0);
+			++writer.current;
+			return;
+		}
+		_dumpFieldValue(writer, value);
+	}
+
+	inline void _loadField(FieldReader& reader, char* value, const char*)			{ _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, unsigned char* value, const char*)	{ _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, float* value, const char*)			{ _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, double* value, const char*)			{ _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, short* value, const char*)			{ reader.compactIntegers ? _loadFieldValue(reader, value) : _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, unsigned short* value, const char*)	{ reader.compactIntegers ? _loadFieldValue(reader, value) : _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, int* value, const char*)			{ reader.compactIntegers ? _loadFieldValue(reader, value) : _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, unsigned int* value, const char*)	{ reader.compactIntegers ? _loadFieldValue(reader, value) : _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, int64_t* value, const char*)		{ reader.compactIntegers ? _loadFieldValue(reader, value) : _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, uint64_t* value, const char*)		{ reader.compactIntegers ? _loadFieldValue(reader, value) : _loadFieldDirect(reader, value); }
+	inline void _loadField(FieldReader& reader, bool* value, const char*)
+	{
+		if (reader.current != reader.end)
+		{
+			*value = (*reader.current != 0);
+			++reader.current;
+			return;
+		}
+		_loadFieldValue(reader, value);
+	}
+
+	template <typename T>
+	inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, henum>::value, void>::type _dumpField(FieldWriter& writer, T* value)
+	{
+		_dumpField(writer, (henum*)value);
+	}
+	template <typename T>
+	inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, Serializable>::value, void>::type _dumpField(FieldWriter& writer, T* value)
+	{
+		_dumpField(writer, (Serializable*)value);
+	}
+	template <typename T>
+	inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, Serializable>::value, void>::type _dumpField(FieldWriter& writer, T** value)
+	{
+		_dumpField(writer, (Serializable**)value);
+	}
+	template <typename T>
+	inline void _dumpField(FieldWriter& writer, Lazy<T>* value)
+	{
+		_dumpField(writer, (LazyBase*)value);
+	}
+	template <typename T>
+	inline void _dumpField(FieldWriter& writer, Half<T>* value)
+	{
+		_dumpField(writer, (void*)value, _getFieldType<Half<T> >());
+	}
+	template <typename T, int Scale>
+	inline void _dumpField(FieldWriter& writer, Fixed<T, Scale>* value)
+	{
+		_dumpField(writer, (void*)value, _getFieldType<Fixed<T, Scale> >());
+	}
+	template <typename T>
+	inline void _dumpField(FieldWriter& writer, Series<T>* value)
+	{
+		_dumpField(writer, (void*)value, _getFieldType<Series<T> >());
+	}
+	template <typename T>
+	inline void _dumpField(FieldWriter& writer, harray<T>* value)
+	{
+		_dumpField(writer, (void*)value, _getFieldType<harray<T> >());
+	}
+	template <typename K, typename V>
+	inline void _dumpField(FieldWriter& writer, hmap<K, V>* value)
+	{
+		_dumpField(writer, (void*)value, _getFieldType<hmap<K, V> >());
+	}
+
+	template <typename T>
+	inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, henum>::value, void>::type _loadField(FieldReader& reader, T* value, const char* name)
+	{
+		_loadField(reader, (henum*)value, name);
+	}
+	template <typename T>
+	inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, Serializable>::value, void>::type _loadField(FieldReader& reader, T* value, const char* name)
+	{
+		_loadField(reader, (Serializable*)value, name);
+	}
+	template <typename T>
+	inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, Serializable>::value, void>::type _loadField(FieldReader& reader, T** value, const char* name)
+	{
+		_loadField(reader, (Serializable**)value, name);
+	}
+	template <typename T>
+	inline void _loadField(FieldReader& reader, Lazy<T>* value, const char* name)
+	{
+		_loadField(reader, (LazyBase*)value, name);
+	}
+	template <typename T>
+	inline void _loadField(FieldReader& reader, Half<T>* value, const char* name)
+	{
+		_loadField(reader, (void*)value, _getFieldType<Half<T> >(), name);
+	}
+	template <typename T, int Scale>
+	inline void _loadField(FieldReader& reader, Fixed<T, Scale>* value, const char* name)
+	{
+		_loadField(reader, (void*)value, _getFieldType<Fixed<T, Scale> >(), name);
+	}
+	template <typename T>
+	inline void _loadField(FieldReader& reader, Series<T>* value, const char* name)
+	{
+		_loadField(reader, (void*)value, _getFieldType<Series<T> >(), name);
+	}
+	template <typename T>
+	inline void _loadField(FieldReader& reader, harray<T>* value, const char* name)
+	{
+		_loadField(reader, (void*)value, _getFieldType<harray<T> >(), name);
+	}
+	template <typename K, typename V>
+	inline void _loadField(FieldReader& reader, hmap<K, V>* value, const char* name)
+	{
+		_loadField(reader, (void*)value, _getFieldType<hmap<K, V> >(), name);
+	}
+
+}
+#endif
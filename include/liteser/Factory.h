@@ -13,6 +13,8 @@
 #ifndef LITESER_FACTORY_H
 #define LITESER_FACTORY_H
 
+#include <new>
+
 #include <hltypes/harray.h>
 #include <hltypes/hstring.h>
 
@@ -20,6 +22,7 @@
 
 namespace liteser
 {
+	class Allocator;
 	class Serializable;
 
 	class liteserExport Factory
@@ -28,9 +31,11 @@ namespace liteser
 		template <typename T>
 		struct Register
 		{
-			inline Register(chstr name)
+			/// @brief Index of the class, assigned in order of registration and the same for every registration of the same name.
+			int id;
+
+			inline Register(chstr name) : id(Factory::_register(name, &_create<T>, &_construct<T>, (int)sizeof(T)))
 			{
-				Factory::_register(name, &_create<T>);
 			}
 
 			inline ~Register()
@@ -43,13 +48,27 @@ namespace liteser
 
 		template <typename T>
 		static inline Serializable* _create() { return new T(); }
+		template <typename T>
+		static inline Serializable* _construct(void* memory) { return new (memory) T(); }
 
 		static Serializable* create(chstr name);
+		/// @brief Creates an object of a class by its ID which does not need any name lookup.
+		static Serializable* create(int classId);
+		/// @brief Destroys an object that was created by create() and passes its memory back to the Allocator it was placed in or deletes it if it was created with new.
+		/// @note Objects that may have been placed in an Allocator must be released with this instead of delete, e.g. in the destructor of the object that owns them.
+		static void release(Serializable* object);
+		/// @return ID of a registered class or -1 if there is no class with that name.
+		/// @note IDs depend on the order of registration, so only names are stored in streams and mapped to IDs once per stream.
+		static int getClassId(chstr name);
+		/// @brief Sets where objects that are created on the current thread are placed, NULL creates them with new.
+		/// @note Objects within lazy objects are created when they are accessed, so they use the allocator that is set then.
+		static void setAllocator(Allocator* allocator);
+		static Allocator* getAllocator();
 
 	protected:
 		Factory();
 
-		static void _register(chstr name, Serializable* (*constructor)());
+		static int _register(chstr name, Serializable* (*constructor)(), Serializable* (*placementConstructor)(void*), int size);
 
 	};
 
@@ -16,6 +16,7 @@
 #include <hltypes/hversion.h>
 
 #include "liteserExport.h"
+#include "Options.h"
 
 namespace liteser
 {
@@ -25,9 +26,30 @@ namespace liteser
 		hversion version;
 		bool allowMultiReferencing;
 		bool stringPooling;
+		/// @brief Whether the data after the header is split into independently compressed blocks.
+		bool compressed;
+		/// @brief Whether the data is an object array with an index that allows loading single elements.
+		bool indexed;
+		/// @brief Whether objects and containers are prefixed with their size so they can be skipped without decoding them.
+		bool lengthPrefixed;
+		/// @brief Whether the data only contains the variables that changed since a snapshot.
+		bool delta;
+		/// @brief Number of pooled strings and their total length so the string pool can be allocated at once when loading, 0 if unknown.
+		unsigned int stringCount;
+		unsigned int stringSize;
+		/// @brief Whether stringCount and stringSize are determined when writing, they are only stored if this is used.
+		bool stringPoolSize;
+		/// @brief Whether the data is an object array of a single class with every variable of all objects stored together.
+		bool columnar;
+		/// @brief Whether integer arrays are stored with an encoding that is chosen for their values.
+		bool encodedArrays;
+		/// @brief Whether integers, IDs, sizes and counts are stored as varints so small values take a single byte.
+		bool compactIntegers;
 
 		Header();
 		Header(bool allowMultiReferencing, bool stringPooling);
+		/// @brief Creates the header for the given options, the formats of specific calls are set afterwards.
+		Header(const Options& options);
 		~Header();
 
 	};
@@ -0,0 +1,78 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents an object pointer that is only decoded when it is accessed.
+
+#ifndef LITESER_LAZY_H
+#define LITESER_LAZY_H
+
+#include <stdint.h>
+
+#include <hltypes/hltypesUtil.h>
+
+#include "liteserExport.h"
+
+namespace liteser
+{
+	class LazySlot;
+	class Serializable;
+
+	/// @brief Base of Lazy, keeps the object or the binary data it is decoded from.
+	/// @note Copies share the same object so it is decoded only once. Decoding is not thread-safe.
+	class liteserExport LazyBase
+	{
+	public:
+		LazyBase();
+		LazyBase(const LazyBase& other);
+		~LazyBase();
+		LazyBase& operator=(const LazyBase& other);
+
+		/// @return True if the object does not have to be decoded anymore.
+		bool isLoaded() const;
+		/// @brief Gets the object and decodes it on first access.
+		Serializable* get();
+		/// @brief Sets the object, the data it would have been decoded from is dropped.
+		void set(Serializable* object);
+
+		inline LazySlot* _getSlot() const { return this->slot; }
+		/// @brief Replaces the object with data that is decoded on first access, the reference to the slot is taken over.
+		void _setSlot(LazySlot* slot);
+
+	protected:
+		LazySlot* slot;
+
+	};
+
+	/// @brief Object pointer that is loaded from binary data only when it is first accessed.
+	/// @note Use it instead of T* in LS_VARS for large parts of data that are rarely used. The object is decoded from the
+	/// buffer or mapped file of the original call which is kept in memory as long as there are lazy objects that were not decoded.
+	/// Objects within a lazy object can reference objects that were written before it, but objects that are first written
+	/// within a lazy object cannot be referenced from outside of it.
+	template <typename T>
+	class Lazy : public LazyBase
+	{
+	public:
+		inline Lazy(T* object = NULL) : LazyBase()
+		{
+			if (object != NULL)
+			{
+				this->set(object);
+			}
+		}
+
+		inline T* get() { return (T*)LazyBase::get(); }
+		inline T* operator->() { return this->get(); }
+		inline operator T*() { return this->get(); }
+		inline Lazy<T>& operator=(T* object) { this->set(object); return (*this); }
+
+	};
+
+}
+#endif
@@ -0,0 +1,89 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents an allocator that packs objects into large blocks of memory.
+
+#ifndef LITESER_OBJECT_ARENA_H
+#define LITESER_OBJECT_ARENA_H
+
+#include <hltypes/harray.h>
+#include <hltypes/hmutex.h>
+#include <hltypes/hstring.h>
+
+#include "Allocator.h"
+#include "liteserExport.h"
+
+namespace liteser
+{
+	class Serializable;
+
+	/// @brief Places objects one after another in the order they are created, which is also the order they are loaded in.
+	/// @note Objects that are passed to Factory::release(), e.g. by the destructor of the object that owns them, are only destroyed and clear() skips them.
+	/// @note clear() destroys objects in the order they were created, so objects that release others have to be created before them, which is the case for objects that are loaded as variables of their owner.
+	/// @note Objects can be created and released on any thread, but clear() must not be called while objects are still created.
+	class liteserExport ObjectArena : public Allocator
+	{
+	public:
+		/// @param[in] blockSize Size of the memory blocks, larger objects get a block of their own.
+		/// @param[in] classPools Whether every class gets its own blocks, which keeps objects of the same class together and reuses the memory of released objects.
+		ObjectArena(int blockSize = 65536, bool classPools = false);
+		~ObjectArena();
+
+		/// @return Number of objects in the arena that were not released.
+		inline int getObjectCount() const { return this->objectCount; }
+
+		void* allocate(int classId, chstr className, int size);
+		void addObject(Serializable* object);
+		void release(void* memory);
+		/// @brief Destroys the objects in order of their creation and frees the blocks.
+		void clear();
+
+	protected:
+		/// @brief Free memory in the last block of a class and memory of released objects of the class.
+		struct Pool
+		{
+			unsigned char* current;
+			int remaining;
+			harray<unsigned char*> freeMemory;
+
+			Pool();
+
+		};
+
+		/// @brief Placed in front of every object.
+		struct Slot
+		{
+			/// @brief Index of the object in objects.
+			int index;
+			/// @brief Pool the memory is returned to when the object is released, NULL if there are no class pools.
+			Pool* pool;
+
+		};
+
+		int blockSize;
+		bool classPools;
+		harray<unsigned char*> blocks;
+		/// @brief Free memory in the last block if there are no class pools.
+		unsigned char* current;
+		int remaining;
+		/// @brief Pools by class ID, NULL for classes that were not created yet.
+		harray<Pool*> pools;
+		/// @brief Objects in order of their creation, NULL for those that were released.
+		harray<Serializable*> objects;
+		int objectCount;
+		/// @brief Guards all members since released objects can belong to the allocator of another thread.
+		hmutex mutex;
+
+		unsigned char* _allocate(unsigned char** current, int* remaining, int size);
+
+	};
+
+}
+#endif
@@ -0,0 +1,48 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines the options that select how data is serialized.
+
+#ifndef LITESER_OPTIONS_H
+#define LITESER_OPTIONS_H
+
+namespace liteser
+{
+	/// @brief Selects how data is written, all serialization calls take their options like this.
+	/// @note Calls ignore the options they do not support, e.g. XML only uses allowMultiReferencing.
+	class Options
+	{
+	public:
+		/// @brief Whether objects that are referenced more than once are only written the first time.
+		bool allowMultiReferencing;
+		/// @brief Whether every string is only written the first time it is used.
+		bool stringPooling;
+		/// @brief Whether the data after the header is split into blocks that are compressed independently.
+		bool compressed;
+		/// @brief Whether objects and containers are prefixed with their size so they can be skipped when loading.
+		/// @note Sizes are filled in once a block is finished and the outermost block is only finished at the end, so compressed data that is length prefixed is kept in memory and compressed at once instead of while it is written.
+		bool lengthPrefixed;
+		/// @brief Whether integer arrays are stored with an encoding that is chosen for their values.
+		bool encodedArrays;
+		/// @brief Whether integers, IDs, sizes and counts are stored as varints.
+		bool compactIntegers;
+		/// @brief Whether the number and total size of pooled strings are stored in the header so loading can allocate the string pool at once.
+		/// @note The header is completed at the end so the stream has to be seekable.
+		bool stringPoolSize;
+
+		inline Options() : allowMultiReferencing(true), stringPooling(true), compressed(false), lengthPrefixed(false), encodedArrays(false), compactIntegers(false), stringPoolSize(false) { }
+		/// @brief Creates the options that the calls without an Options parameter use.
+		inline Options(bool allowMultiReferencing, bool stringPooling) : allowMultiReferencing(allowMultiReferencing), stringPooling(stringPooling), compressed(false),
+			lengthPrefixed(false), encodedArrays(false), compactIntegers(false), stringPoolSize(false) { }
+
+	};
+
+}
+#endif
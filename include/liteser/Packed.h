@@ -0,0 +1,91 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents variables that are stored differently than they are kept in memory.
+
+#ifndef LITESER_PACKED_H
+#define LITESER_PACKED_H
+
+// normalized values use the largest scale that keeps 1.0 within 16 bits
+#define LITESER_NORM16_SCALE 32767
+
+namespace liteser
+{
+	/// @brief Variable that is stored as 16 bit floats, e.g. Half<gvec3f> instead of gvec3f in LS_VARS.
+	/// @note Supported types are float, gvec2f, gvec3f and grectf. Harrays of it are converted in blocks since it has
+	/// the same layout as the wrapped type.
+	template <typename T>
+	class Half
+	{
+	public:
+		T value;
+
+		inline Half() : value() { }
+		inline Half(const T& value) : value(value) { }
+
+		inline Half& operator=(const T& value) { this->value = value; return *this; }
+		inline operator T&() { return this->value; }
+		inline operator const T&() const { return this->value; }
+		inline T* operator->() { return &this->value; }
+		inline const T* operator->() const { return &this->value; }
+
+	};
+
+	/// @brief Variable that is stored as 16 bit fixed point numbers, e.g. Fixed<gvec3f, 100> keeps two decimals between -327.68 and 327.67.
+	/// @note Supported types are the same as for Half. Values outside of the range are clamped. The scale is stored with the
+	/// type so data that was written with another scale is converted when it is loaded.
+	template <typename T, int Scale>
+	class Fixed
+	{
+	public:
+		T value;
+
+		inline Fixed() : value() { }
+		inline Fixed(const T& value) : value(value) { }
+
+		inline Fixed& operator=(const T& value) { this->value = value; return *this; }
+		inline operator T&() { return this->value; }
+		inline operator const T&() const { return this->value; }
+		inline T* operator->() { return &this->value; }
+		inline const T* operator->() const { return &this->value; }
+
+	};
+
+	/// @brief Sample of a series that is stored as the XOR with the previous sample, e.g. harray<Series<double> > instead of harray<double> in LS_VARS.
+	/// @note Supported types are float and double. Samples that only differ in their lowest bits take a few bits each, single values are stored as usual.
+	template <typename T>
+	class Series
+	{
+	public:
+		T value;
+
+		inline Series() : value() { }
+		inline Series(const T& value) : value(value) { }
+
+		inline Series& operator=(const T& value) { this->value = value; return *this; }
+		inline operator T&() { return this->value; }
+		inline operator const T&() const { return this->value; }
+
+	};
+
+	/// @brief Variable with components between -1 and 1 that is stored as normalized 16 bit integers, e.g. for directions.
+	template <typename T>
+	class Norm16 : public Fixed<T, LITESER_NORM16_SCALE>
+	{
+	public:
+		inline Norm16() : Fixed<T, LITESER_NORM16_SCALE>() { }
+		inline Norm16(const T& value) : Fixed<T, LITESER_NORM16_SCALE>(value) { }
+
+		inline Norm16& operator=(const T& value) { this->value = value; return *this; }
+
+	};
+
+}
+#endif
@@ -40,16 +40,5 @@ namespace liteser
 
 	};
 
-	template <typename T>
-	class CPtr : public Ptr
-	{
-	public:
-		harray<T>* data;
-
-		inline CPtr(harray<T>* data) { this->data = data; }
-		inline ~CPtr() { delete this->data; }
-
-	};
-
 }
 #endif
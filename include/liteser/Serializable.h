@@ -17,18 +17,23 @@
 
 #include <hltypes/hsbase.h>
 
+#include "Codec.h"
 #include "Factory.h"
 #include "liteserExport.h"
 #include "macros.h"
 #include "Variable.h"
 
 #define LS_CLASS_DECLARE(classe) \
-	LS_CLASS_DECLARE_ABSTRACT(classe); \
-	static liteser::Factory::Register<classe> _lsRegister;
+	__LS_CLASS_NAME(classe); \
+	static liteser::Factory::Register<classe> _lsRegister; \
+	inline int _lsClassId() const { return _lsRegister.id; }
 #define LS_CLASS_DEFINE(classe) \
 	liteser::Factory::Register<classe> classe::_lsRegister(#classe);
 /// @brief Use this instead of LS_CLASS_DECLARE if class contains pure virtual methods. In this case LS_CLASS_DEFINE is not needed.
 #define LS_CLASS_DECLARE_ABSTRACT(classe) \
+	__LS_CLASS_NAME(classe); \
+	inline int _lsClassId() const { return -1; }
+#define __LS_CLASS_NAME(classe) \
 	inline hstr _lsName() const { return #classe; }
 
 #define LS_CLASS_DECLARE_CLONEABLE(classe) \
@@ -45,16 +50,41 @@
 		harray<liteser::Variable*> variables = superclass::_lsVars(); \
 		__LS_FOREACH(__LS_REF, (__VA_ARGS__)) \
 		return variables; \
+	} \
+	inline int _lsVarCount() const { return superclass::_lsVarCount() + __LS_VA_ARGC(__VA_ARGS__); } \
+	inline void _lsDumpVars(liteser::FieldWriter& writer) \
+	{ \
+		superclass::_lsDumpVars(writer); \
+		__LS_FOREACH(__LS_DUMP, (__VA_ARGS__)) \
+	} \
+	inline void _lsLoadVars(liteser::FieldReader& reader) \
+	{ \
+		superclass::_lsLoadVars(reader); \
+		__LS_FOREACH(__LS_LOAD, (__VA_ARGS__)) \
 	}
 #define LS_VARS_DECLARE(...) \
 	__LS_FOREACH(__LS_VAR, (__VA_ARGS__)) \
-	harray<liteser::Variable*> _lsVars();
+	harray<liteser::Variable*> _lsVars(); \
+	int _lsVarCount() const; \
+	void _lsDumpVars(liteser::FieldWriter& writer); \
+	void _lsLoadVars(liteser::FieldReader& reader);
 #define LS_VARS_DEFINE(classe, superclass, ...) \
 	harray<liteser::Variable*> classe::_lsVars() \
 	{ \
 		harray<liteser::Variable*> variables = superclass::_lsVars(); \
 		__LS_FOREACH(__LS_REF, (__VA_ARGS__)) \
 		return variables; \
+	} \
+	int classe::_lsVarCount() const { return superclass::_lsVarCount() + __LS_VA_ARGC(__VA_ARGS__); } \
+	void classe::_lsDumpVars(liteser::FieldWriter& writer) \
+	{ \
+		superclass::_lsDumpVars(writer); \
+		__LS_FOREACH(__LS_DUMP, (__VA_ARGS__)) \
+	} \
+	void classe::_lsLoadVars(liteser::FieldReader& reader) \
+	{ \
+		superclass::_lsLoadVars(reader); \
+		__LS_FOREACH(__LS_LOAD, (__VA_ARGS__)) \
 	}
 #define LS_FORCE_REGISTER(classe, name) \
 	static classe __lsRegisterObject ## name;
@@ -72,7 +102,16 @@ namespace liteser
 		virtual ~Serializable();
 
 		virtual inline hstr _lsName() const { return "liteser::Serializer"; }
+		/// @brief Index of the class in the Factory, -1 if the class is not registered.
+		virtual inline int _lsClassId() const { return -1; }
 		virtual inline harray<Variable*> _lsVars() { return harray<Variable*>(); }
+		/// @brief Number of variables that _lsDumpVars() and _lsLoadVars() handle.
+		/// @note The generated functions are only used if _lsVars() returns exactly the variables that LS_VARS created, in their order and with this count. Otherwise, e.g. if a class builds its variable list by hand, the variables are handled one by one through their types.
+		virtual inline int _lsVarCount() const { return 0; }
+		/// @brief Writes all variables in the order of _lsVars() with the functions for their C++ types, generated by LS_VARS.
+		virtual inline void _lsDumpVars(FieldWriter&) { }
+		/// @brief Reads all variables in the order of _lsVars() with the functions for their C++ types, generated by LS_VARS.
+		virtual inline void _lsLoadVars(FieldReader&) { }
 
 	protected:
 		virtual Serializable* clone();
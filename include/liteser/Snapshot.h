@@ -0,0 +1,51 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents the state of an object graph that deltas are written against.
+
+#ifndef LITESER_SNAPSHOT_H
+#define LITESER_SNAPSHOT_H
+
+#include <hltypes/harray.h>
+
+#include "liteserExport.h"
+
+namespace liteser
+{
+	class Schema;
+	class Serializable;
+
+	/// @brief The encoded variables of every object of a graph at the time the snapshot was taken.
+	/// @note The objects are only referenced, the snapshot does not keep them alive.
+	class liteserExport Snapshot
+	{
+	public:
+		/// @brief Objects in order of their IDs, the first one is the object the snapshot was taken of.
+		harray<Serializable*> objects;
+		/// @brief Class of every object, used to notice objects that were deleted and replaced at the same address.
+		harray<Schema*> schemas;
+		/// @brief Index of the first variable of every object in offsets.
+		harray<int> fields;
+		/// @brief Where the encoded value of every variable starts in data, followed by the end of the last one.
+		harray<int> offsets;
+		harray<unsigned char> data;
+
+		Snapshot();
+		~Snapshot();
+
+		/// @return True if the snapshot was not taken yet.
+		bool isEmpty() const;
+		/// @brief Drops the state so a new snapshot has to be taken before the next delta.
+		void clear();
+
+	};
+
+}
+#endif
@@ -17,6 +17,7 @@
 
 #include <gtypes/Rectangle.h>
 #include <gtypes/Vector2.h>
+#include <gtypes/Vector3.h>
 #include <hltypes/harray.h>
 #include <hltypes/henum.h>
 #include <hltypes/hltypesUtil.h>
@@ -24,8 +25,11 @@
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Lazy.h"
 #include "liteserExport.h"
+#include "Packed.h"
 #include "Ptr.h"
+#include "templates.h"
 
 namespace liteser
 {
@@ -51,6 +55,7 @@ namespace liteser
 			HL_ENUM_DECLARE(Identifier, Bool);
 			HL_ENUM_DECLARE(Identifier, ValueObject);
 			HL_ENUM_DECLARE(Identifier, Object);
+			HL_ENUM_DECLARE(Identifier, LazyObject);
 			HL_ENUM_DECLARE(Identifier, Hstr);
 			HL_ENUM_DECLARE(Identifier, Hversion);
 			HL_ENUM_DECLARE(Identifier, Henum);
@@ -63,12 +68,24 @@ namespace liteser
 			HL_ENUM_DECLARE(Identifier, Grectd);
 			HL_ENUM_DECLARE(Identifier, Gvec2d);
 			HL_ENUM_DECLARE(Identifier, Gvec3d);
+			HL_ENUM_DECLARE(Identifier, HalfFloat);
+			HL_ENUM_DECLARE(Identifier, HalfGvec2f);
+			HL_ENUM_DECLARE(Identifier, HalfGvec3f);
+			HL_ENUM_DECLARE(Identifier, HalfGrectf);
+			HL_ENUM_DECLARE(Identifier, FixedFloat);
+			HL_ENUM_DECLARE(Identifier, FixedGvec2f);
+			HL_ENUM_DECLARE(Identifier, FixedGvec3f);
+			HL_ENUM_DECLARE(Identifier, FixedGrectf);
+			HL_ENUM_DECLARE(Identifier, SeriesFloat);
+			HL_ENUM_DECLARE(Identifier, SeriesDouble);
 			HL_ENUM_DECLARE(Identifier, Harray);
 			HL_ENUM_DECLARE(Identifier, Hmap);
 		));
 
 		Identifier identifier;
 		harray<Type*> subTypes;
+		/// @brief Scale of fixed point values, 0 for all other types.
+		int scale;
 
 		Type();
 		~Type();
@@ -98,6 +115,47 @@ namespace liteser
 		void assign(VPtr<gvec3d>* arg);
 		void assign(VPtr<Serializable>* arg);
 		void assign(VPtr<Serializable*>* arg);
+		void assign(VPtr<LazyBase>* arg);
+		void assign(VPtr<Half<float> >* arg);
+		void assign(VPtr<Half<gvec2f> >* arg);
+		void assign(VPtr<Half<gvec3f> >* arg);
+		void assign(VPtr<Half<grectf> >* arg);
+		void assign(VPtr<Series<float> >* arg);
+		void assign(VPtr<Series<double> >* arg);
+		void _assignFixed(VPtr<float>* arg, int scale);
+		void _assignFixed(VPtr<gvec2f>* arg, int scale);
+		void _assignFixed(VPtr<gvec3f>* arg, int scale);
+		void _assignFixed(VPtr<grectf>* arg, int scale);
+		template <typename T>
+		inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, henum>::value, void>::type assign(VPtr<T>* arg)
+		{
+			this->assign((VPtr<henum>*)NULL);
+		}
+		template <typename T>
+		inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, Serializable>::value, void>::type assign(VPtr<T>* arg)
+		{
+			this->assign((VPtr<Serializable>*)NULL);
+		}
+		template <typename T>
+		inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, Serializable>::value, void>::type assign(VPtr<T*>* arg)
+		{
+			this->assign((VPtr<Serializable*>*)NULL);
+		}
+		template <typename T>
+		inline void assign(VPtr<Lazy<T> >* arg)
+		{
+			this->assign((VPtr<LazyBase>*)NULL);
+		}
+		template <typename T, int Scale>
+		inline void assign(VPtr<Fixed<T, Scale> >* arg)
+		{
+			this->_assignFixed((VPtr<T>*)NULL, Scale);
+		}
+		template <typename T>
+		inline void assign(VPtr<Norm16<T> >* arg)
+		{
+			this->_assignFixed((VPtr<T>*)NULL, LITESER_NORM16_SCALE);
+		}
 		template <typename T>
 		inline void assign(VPtr<harray<T> >* arg)
 		{
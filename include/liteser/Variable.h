@@ -23,6 +23,7 @@
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Lazy.h"
 #include "liteser.h"
 #include "liteserExport.h"
 #include "Ptr.h"
@@ -39,10 +40,12 @@ namespace liteser
 		hstr name;
 		Type* type;
 		Ptr* ptr;
-		harray<Variable*> subVariables;
+		/// @brief Number of elements in the container at the time of assignment, elements are accessed directly through the container.
 		unsigned int containerSize;
+		/// @brief Position of the variable in the codec generated by LS_VARS, -1 if the variable was not created by LS_VARS.
+		int codecIndex;
 
-		Variable(chstr name = "");
+		Variable(chstr name = "", int codecIndex = -1);
 		~Variable();
 
 		Variable* assign(VPtr<char>* ptr); // char is always 8 bits
@@ -110,16 +113,78 @@ namespace liteser
 			return this;
 		}
 		template <typename T>
+		inline Variable* assign(VPtr<Lazy<T> >* ptr)
+		{
+			this->type->assign((VPtr<LazyBase>*)NULL);
+			this->ptr = ptr;
+			return this;
+		}
+		template <typename T>
+		inline Variable* assign(VPtr<Half<T> >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			return this;
+		}
+		template <typename T, int Scale>
+		inline Variable* assign(VPtr<Fixed<T, Scale> >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			return this;
+		}
+		template <typename T>
+		inline Variable* assign(VPtr<Norm16<T> >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			return this;
+		}
+		template <typename T>
+		inline Variable* assign(VPtr<Series<T> >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			return this;
+		}
+		template <typename T>
+		inline Variable* assign(VPtr<harray<Half<T> > >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			this->containerSize = ptr->value->size();
+			return this;
+		}
+		template <typename T, int Scale>
+		inline Variable* assign(VPtr<harray<Fixed<T, Scale> > >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			this->containerSize = ptr->value->size();
+			return this;
+		}
+		template <typename T>
+		inline Variable* assign(VPtr<harray<Norm16<T> > >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			this->containerSize = ptr->value->size();
+			return this;
+		}
+		template <typename T>
+		inline Variable* assign(VPtr<harray<Series<T> > >* ptr)
+		{
+			this->type->assign(ptr);
+			this->ptr = ptr;
+			this->containerSize = ptr->value->size();
+			return this;
+		}
+		template <typename T>
 		inline typename __LS_ENABLE_IF<__LS_IS_BASE_OF<T, henum>::value, Variable*>::type assign(VPtr<harray<T> >* ptr)
 		{
 			this->type->assign((VPtr<harray<henum> >*)NULL);
 			this->ptr = ptr;
 			this->containerSize = ptr->value->size();
-			harray<henum>* obj = (harray<henum>*)ptr->value;
-			foreach (henum, it, *obj)
-			{
-				this->subVariables += (new Variable())->assign(new VPtr<henum>(&(*it)));
-			}
 			return this;
 		}
 		template <typename T>
@@ -128,11 +193,6 @@ namespace liteser
 			this->type->assign((VPtr<harray<Serializable*> >*)NULL);
 			this->ptr = ptr;
 			this->containerSize = ptr->value->size();
-			harray<Serializable*>* obj = (harray<Serializable*>*)ptr->value;
-			foreach (Serializable*, it, *obj)
-			{
-				this->subVariables += (new Variable())->assign(new VPtr<Serializable*>(&(*it)));
-			}
 			return this;
 		}
 		template <typename K, typename V>
@@ -141,17 +201,6 @@ namespace liteser
 			this->type->template assign<Serializable*, V>(NULL);
 			this->ptr = ptr;
 			this->containerSize = ptr->value->size();
-			harray<K*>& originalKeys = ptr->value->keys();
-			harray<Serializable*>* keys = new harray<Serializable*>(originalKeys.template cast<Serializable*>());
-			harray<V>* values = new harray<V>();
-			for_iter (i, 0, originalKeys.size()) // cannot use foreach here because GCC can't compile it properly
-			{
-				values->add(ptr->value->operator[](originalKeys[i]));
-			}
-			this->ptrKeys = new CPtr<Serializable*>(keys);
-			this->ptrValues = new CPtr<V>(values);
-			this->subVariables += (new Variable())->assign(new VPtr<harray<Serializable*> >(keys));
-			this->subVariables += (new Variable())->assign(new VPtr<harray<V> >(values));
 			return this;
 		}
 		template <typename K, typename V>
@@ -160,16 +209,6 @@ namespace liteser
 			this->type->template assign<K, Serializable*>(NULL);
 			this->ptr = ptr;
 			this->containerSize = ptr->value->size();
-			harray<K>* keys = new harray<K>(ptr->value->keys());
-			harray<Serializable*>* values = new harray<Serializable*>();
-			for_iter (i, 0, keys->size()) // cannot use foreach here because GCC can't compile it properly
-			{
-				values->add((Serializable*)ptr->value->operator[](keys->operator[](i)));
-			}
-			this->ptrKeys = new CPtr<K>(keys);
-			this->ptrValues = new CPtr<Serializable*>(values);
-			this->subVariables += (new Variable())->assign(new VPtr<harray<K> >(keys));
-			this->subVariables += (new Variable())->assign(new VPtr<harray<Serializable*> >(values));
 			return this;
 		}
 		template <typename K, typename V>
@@ -178,16 +217,6 @@ namespace liteser
 			this->type->assign(ptr);
 			this->ptr = ptr;
 			this->containerSize = ptr->value->size();
-			harray<K>* keys = new harray<K>(ptr->value->keys());
-			harray<V>* values = new harray<V>();
-			for_iter (i, 0, keys->size()) // cannot use foreach here because GCC can't compile it properly
-			{
-				values->add(ptr->value->operator[](keys->operator[](i)));
-			}
-			this->ptrKeys = new CPtr<K>(keys);
-			this->ptrValues = new CPtr<V>(values);
-			this->subVariables += (new Variable())->assign(new VPtr<harray<K> >(keys));
-			this->subVariables += (new Variable())->assign(new VPtr<harray<V> >(values));
 			return this;
 		}
 
@@ -213,115 +242,6 @@ namespace liteser
 			else if (this->type->identifier == Type::Identifier::Double)	*((VPtr<double>*)this->ptr)->value			= (double)value;
 		}
 
-		void createSubVariables(Type::Identifier identifier);
-		void applyHmapSubVariables(Type::Identifier identifier);
-
-	protected:
-		Ptr* ptrKeys;
-		Ptr* ptrValues;
-
-		template <typename S>
-		inline void _addSubVariablesHarray()
-		{
-			harray<S>* container = ((VPtr<harray<S> >*)this->ptr)->value;
-			if (container->size() > 0)
-			{
-				throw Exception("harray in default constructor not empty initially: " + this->name);
-			}
-			container->add(S(), this->containerSize); // requires adding first because of possible reallocation of memory to another block
-			for_itert (unsigned int, i, 0, this->containerSize)
-			{
-				this->subVariables += (new Variable())->assign(new VPtr<S>(&container->operator[](i)));
-			}
-		}
-
-		template <typename key>
-		inline void _addSubVariablesHmapKey(Type::Identifier identifier)
-		{
-			if (identifier == Type::Identifier::Int8)				this->_addSubVariablesHmap<key, char>();
-			else if (identifier == Type::Identifier::UInt8)			this->_addSubVariablesHmap<key, unsigned char>();
-			else if (identifier == Type::Identifier::Int16)			this->_addSubVariablesHmap<key, short>();
-			else if (identifier == Type::Identifier::UInt16)		this->_addSubVariablesHmap<key, unsigned short>();
-			else if (identifier == Type::Identifier::Int32)			this->_addSubVariablesHmap<key, int>();
-			else if (identifier == Type::Identifier::UInt32)		this->_addSubVariablesHmap<key, unsigned int>();
-			else if (identifier == Type::Identifier::Int64)			this->_addSubVariablesHmap<key, int64_t>();
-			else if (identifier == Type::Identifier::UInt64)		this->_addSubVariablesHmap<key, uint64_t>();
-			else if (identifier == Type::Identifier::Float)			this->_addSubVariablesHmap<key, float>();
-			else if (identifier == Type::Identifier::Double)		this->_addSubVariablesHmap<key, double>();
-			else if (identifier == Type::Identifier::Hstr)			this->_addSubVariablesHmap<key, hstr>();
-			else if (identifier == Type::Identifier::Hversion)		this->_addSubVariablesHmap<key, hversion>();
-			else if (identifier == Type::Identifier::Henum)			this->_addSubVariablesHmap<key, henum>();
-			else if (identifier == Type::Identifier::Grectf)		this->_addSubVariablesHmap<key, grectf>();
-			else if (identifier == Type::Identifier::Gvec2f)		this->_addSubVariablesHmap<key, gvec2f>();
-			else if (identifier == Type::Identifier::Gvec3f)		this->_addSubVariablesHmap<key, gvec3f>();
-			else if (identifier == Type::Identifier::Grecti)		this->_addSubVariablesHmap<key, grecti>();
-			else if (identifier == Type::Identifier::Gvec2i)		this->_addSubVariablesHmap<key, gvec2i>();
-			else if (identifier == Type::Identifier::Gvec3i)		this->_addSubVariablesHmap<key, gvec3i>();
-			else if (identifier == Type::Identifier::Grectd)		this->_addSubVariablesHmap<key, grectd>();
-			else if (identifier == Type::Identifier::Gvec2d)		this->_addSubVariablesHmap<key, gvec2d>();
-			else if (identifier == Type::Identifier::Gvec3d)		this->_addSubVariablesHmap<key, gvec3d>();
-			else if (identifier == Type::Identifier::Object)		this->_addSubVariablesHmap<key, Serializable*>();
-			else if (identifier == Type::Identifier::None)			throw Exception("hmap value cannot be None!");
-			else if (identifier == Type::Identifier::Bool)			throw Exception("hmap value cannot be Bool!");
-			else if (identifier == Type::Identifier::ValueObject)	throw Exception("hmap value cannot be ValueObject!");
-			else if (identifier == Type::Identifier::Harray)		throw Exception("hmap value cannot be Harray!");
-			else if (identifier == Type::Identifier::Hmap)			throw Exception("hmap value cannot be Hmap!");
-		}
-
-		template <typename K, typename V>
-		inline void _addSubVariablesHmap()
-		{
-			if (((VPtr<hmap<K, V> >*)this->ptr)->value->size() > 0)
-			{
-				throw Exception("hmap in default constructor not empty initially: " + this->name);
-			}
-		}
-
-		template <typename keyType>
-		inline void _applyHmapSubVariablesKey(Type::Identifier identifier)
-		{
-			if (identifier == Type::Identifier::Int8)				this->_applyHmapSubVariables<keyType, char>();
-			else if (identifier == Type::Identifier::UInt8)			this->_applyHmapSubVariables<keyType, unsigned char>();
-			else if (identifier == Type::Identifier::Int16)			this->_applyHmapSubVariables<keyType, short>();
-			else if (identifier == Type::Identifier::UInt16)		this->_applyHmapSubVariables<keyType, unsigned short>();
-			else if (identifier == Type::Identifier::Int32)			this->_applyHmapSubVariables<keyType, int>();
-			else if (identifier == Type::Identifier::UInt32)		this->_applyHmapSubVariables<keyType, unsigned int>();
-			else if (identifier == Type::Identifier::Int64)			this->_applyHmapSubVariables<keyType, int64_t>();
-			else if (identifier == Type::Identifier::UInt64)		this->_applyHmapSubVariables<keyType, uint64_t>();
-			else if (identifier == Type::Identifier::Float)			this->_applyHmapSubVariables<keyType, float>();
-			else if (identifier == Type::Identifier::Double)		this->_applyHmapSubVariables<keyType, double>();
-			else if (identifier == Type::Identifier::Hstr)			this->_applyHmapSubVariables<keyType, hstr>();
-			else if (identifier == Type::Identifier::Hversion)		this->_applyHmapSubVariables<keyType, hversion>();
-			else if (identifier == Type::Identifier::Henum)			this->_applyHmapSubVariables<keyType, henum>();
-			else if (identifier == Type::Identifier::Grectf)		this->_applyHmapSubVariables<keyType, grectf>();
-			else if (identifier == Type::Identifier::Gvec2f)		this->_applyHmapSubVariables<keyType, gvec2f>();
-			else if (identifier == Type::Identifier::Gvec3f)		this->_applyHmapSubVariables<keyType, gvec3f>();
-			else if (identifier == Type::Identifier::Grecti)		this->_applyHmapSubVariables<keyType, grecti>();
-			else if (identifier == Type::Identifier::Gvec2i)		this->_applyHmapSubVariables<keyType, gvec2i>();
-			else if (identifier == Type::Identifier::Gvec3i)		this->_applyHmapSubVariables<keyType, gvec3i>();
-			else if (identifier == Type::Identifier::Grectd)		this->_applyHmapSubVariables<keyType, grectd>();
-			else if (identifier == Type::Identifier::Gvec2d)		this->_applyHmapSubVariables<keyType, gvec2d>();
-			else if (identifier == Type::Identifier::Gvec3d)		this->_applyHmapSubVariables<keyType, gvec3d>();
-			else if (identifier == Type::Identifier::Object)		this->_applyHmapSubVariables<keyType, Serializable*>();
-			else if (identifier == Type::Identifier::None)			throw Exception("hmap value cannot be None!");
-			else if (identifier == Type::Identifier::Bool)			throw Exception("hmap value cannot be Bool!");
-			else if (identifier == Type::Identifier::ValueObject)	throw Exception("hmap value cannot be ValueObject!");
-			else if (identifier == Type::Identifier::Harray)		throw Exception("hmap value cannot be Harray!");
-			else if (identifier == Type::Identifier::Hmap)			throw Exception("hmap value cannot be Hmap!");
-		}
-
-		template <typename K, typename V>
-		inline void _applyHmapSubVariables()
-		{
-			hmap<K, V>* container = ((VPtr<hmap<K, V> >*)this->ptr)->value;
-			harray<K>* keys = ((CPtr<K>*)this->ptrKeys)->data;
-			harray<V>* values = ((CPtr<V>*)this->ptrValues)->data;
-			for_iter (i, 0, keys->size())
-			{
-				container->operator[](keys->operator[](i)) = values->operator[](i);
-			}
-		}
-
 	};
 
 }
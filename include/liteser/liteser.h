@@ -26,9 +26,13 @@
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Allocator.h"
 #include "liteserExport.h"
 #include "macros.h"
+#include "ObjectArena.h"
+#include "Options.h"
 #include "Serializable.h"
+#include "Snapshot.h"
 
 namespace liteser
 {
@@ -60,6 +64,32 @@ namespace liteser
 	liteserFnExport bool serialize(hsbase* stream, harray<gvec2d>& value, bool allowMultiReferencing = true, bool stringPooling = true);
 	liteserFnExport bool serialize(hsbase* stream, harray<gvec3d>& value, bool allowMultiReferencing = true, bool stringPooling = true);
 
+	/// @note The calls above use the default Options with allowMultiReferencing and stringPooling set to their arguments.
+	liteserFnExport bool serialize(hsbase* stream, Serializable* object, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<Serializable*>& object, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<char>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<unsigned char>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<short>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<unsigned short>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<int>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<unsigned int>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<int64_t>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<uint64_t>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<float>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<double>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<hstr>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<hversion>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<henum>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<grectf>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<gvec2f>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<gvec3f>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<grecti>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<gvec2i>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<gvec3i>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<grectd>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<gvec2d>& value, const Options& options);
+	liteserFnExport bool serialize(hsbase* stream, harray<gvec3d>& value, const Options& options);
+
 	liteserFnExport bool deserialize(hsbase* stream, Serializable** object);
 	liteserFnExport bool deserialize(hsbase* stream, harray<Serializable*>* object);
 	liteserFnExport bool deserialize(hsbase* stream, harray<char>* value);
@@ -85,6 +115,43 @@ namespace liteser
 	liteserFnExport bool deserialize(hsbase* stream, harray<gvec2d>* value);
 	liteserFnExport bool deserialize(hsbase* stream, harray<gvec3d>* value);
 
+	/// @brief Serializes an object array with an index so single elements can be loaded without loading the whole array.
+	/// @note Every element has its own object IDs and all strings are kept in a shared table so each element can be decoded on its own.
+	/// @note Objects and strings are always referenced by IDs and no other options are supported.
+	liteserFnExport bool serializeIndexed(hsbase* stream, harray<Serializable*>& value);
+	/// @brief Loads a range of elements from data that was serialized with serializeIndexed().
+	/// @param[in] count Number of elements, a negative value loads all elements from start on.
+	/// @param[out] output Output object array.
+	/// @note Elements with objects that are referenced by the loaded elements are loaded as well and added to output after the requested ones.
+	liteserFnExport bool deserializeElements(hsbase* stream, int start, int count, harray<Serializable*>* output);
+	/// @brief Loads a single element from data that was serialized with serializeIndexed().
+	/// @param[out] object Output object.
+	/// @param[out] referencedElements Elements with objects that are referenced by the loaded element, they are added after the existing elements.
+	/// @note If referencedElements is NULL and the element references objects in other elements, nothing is loaded and an exception is thrown.
+	liteserFnExport bool deserializeElement(hsbase* stream, int index, Serializable** object, harray<Serializable*>* referencedElements = NULL);
+	/// @return Number of elements in data that was serialized with serializeIndexed().
+	/// @note The stream stays at its current position.
+	liteserFnExport int getElementCount(hsbase* stream);
+
+	/// @brief Serializes an object array with every variable of all elements stored together so numbers can be copied in blocks.
+	/// @note Only used if all elements are different objects of the same class, otherwise the array is serialized as usual.
+	/// @note The data is loaded with the regular deserialize().
+	/// @note Only stringPooling and compressed are supported, the elements are always referenced by IDs.
+	liteserFnExport bool serializeColumnar(hsbase* stream, harray<Serializable*>& value, const Options& options = Options());
+
+	/// @brief Keeps the state of an object and everything it references so deltas can be written against it.
+	/// @param[out] snapshot Output snapshot.
+	/// @note A snapshot of an object that was loaded from a stream is a baseline for the data in that stream.
+	liteserFnExport bool takeSnapshot(Serializable* object, Snapshot* snapshot);
+	/// @brief Serializes only the variables that changed since the snapshot was taken.
+	/// @param[in,out] snapshot Snapshot of the object that becomes the snapshot of the state that was just written.
+	/// @note Objects that were created since are written completely, lazy objects are compared as a whole.
+	/// @note Only stringPooling and compressed are supported, objects are always referenced by IDs.
+	liteserFnExport bool serializeDelta(hsbase* stream, Serializable* object, Snapshot* snapshot, const Options& options = Options());
+	/// @brief Applies data that was serialized with serializeDelta() to an object in the state the delta was written against.
+	/// @note Objects that are not referenced anymore are not deleted.
+	liteserFnExport bool applyDelta(hsbase* stream, Serializable* object);
+
 	namespace xml
 	{
 		liteserFnExport bool serialize(hsbase* stream, Serializable* object, bool allowMultiReferencing = true);
@@ -112,6 +179,32 @@ namespace liteser
 		liteserFnExport bool serialize(hsbase* stream, harray<gvec2d>& value, bool allowMultiReferencing = true);
 		liteserFnExport bool serialize(hsbase* stream, harray<gvec3d>& value, bool allowMultiReferencing = true);
 
+		/// @note The calls above use the default Options with allowMultiReferencing set to their argument.
+		liteserFnExport bool serialize(hsbase* stream, Serializable* object, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<Serializable*>& object, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<char>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<unsigned char>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<short>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<unsigned short>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<int>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<unsigned int>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<int64_t>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<uint64_t>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<float>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<double>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<hstr>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<hversion>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<henum>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<grectf>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<gvec2f>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<gvec3f>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<grecti>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<gvec2i>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<gvec3i>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<grectd>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<gvec2d>& value, const Options& options);
+		liteserFnExport bool serialize(hsbase* stream, harray<gvec3d>& value, const Options& options);
+
 		liteserFnExport bool deserialize(hsbase* stream, Serializable** object);
 		liteserFnExport bool deserialize(hsbase* stream, harray<Serializable*>* object);
 		liteserFnExport bool deserialize(hsbase* stream, harray<char>* value);
@@ -147,6 +240,11 @@ namespace liteser
 	/// @param[out] dataArray Output object array.
 	/// @return True if successful.
 	liteserFnExport bool loadArrayFromFile(chstr path, harray<liteser::Serializable*>* dataArray, bool warn = true);
+	/// @brief Loads a range of elements from a file that was saved with serializeIndexed().
+	/// @param[out] dataArray Output object array.
+	/// @return True if successful.
+	/// @note Elements with objects that are referenced by the loaded elements are added after the requested ones.
+	liteserFnExport bool loadElementsFromFile(chstr path, int start, int count, harray<liteser::Serializable*>* dataArray, bool warn = true);
 	/// @param[out] dataArray Output object array.
 	/// @return True if successful.
 	liteserFnExport bool loadArrayFromResource(chstr path, harray<liteser::Serializable*>* dataArray, bool warn = true);
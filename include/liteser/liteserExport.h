@@ -8,7 +8,7 @@
 /// 
 /// @section DESCRIPTION
 /// 
-/// Defines macros for DLL exports/imports.
+/// Defines macros for DLL exports/imports and for differences between platforms.
 
 #ifndef LITESER_EXPORT_H
 #define LITESER_EXPORT_H
@@ -35,5 +35,18 @@
 		#endif
 	#endif
 
+	/// @def LITESER_THREAD_LOCAL
+	/// @brief Declares a variable with static storage that every thread has its own copy of.
+	#ifdef _MSC_VER
+		#define LITESER_THREAD_LOCAL __declspec(thread)
+	#else
+		#define LITESER_THREAD_LOCAL __thread
+	#endif
+
+	// binary data is always stored in little-endian byte order
+	#if defined(__BIG_ENDIAN__) || (defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		#define LITESER_BIG_ENDIAN
+	#endif
+
 #endif
 
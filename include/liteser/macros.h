@@ -127,6 +127,11 @@
 #define __LS_VAR(i, x) \
 	__LS_PAIR(x);
 #define __LS_REF(i, x) \
-	variables += (new liteser::Variable(hstr(__LS_STRINGIFY(__LS_STRIP x)).trimmed()))->assign(new liteser::VPtr<__LS_TYPEOF x>(&this->__LS_STRIP x));
+	variables += (new liteser::Variable(hstr(__LS_STRINGIFY(__LS_STRIP x)).trimmed(), variables.size()))->assign(new liteser::VPtr<__LS_TYPEOF x>(&this->__LS_STRIP x));
+#define __LS_DUMP(i, x) \
+	liteser::_dumpField(writer, &this->__LS_STRIP x);
+// the name is only needed for error messages, so it is passed as it is written
+#define __LS_LOAD(i, x) \
+	liteser::_loadField(reader, &this->__LS_STRIP x, __LS_STRINGIFY(__LS_STRIP x));
 
 #endif
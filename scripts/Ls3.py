@@ -7,14 +7,18 @@ class Ls3:
 
 	@staticmethod
 	def load():
-		type = Ls3._loadType()
-		variable = Variable("", type)
+		type, scale = Ls3._loadType()
+		variable = Variable("", type, scale)
 		Ls3.__loadVariable(variable, type)
 		return variable
 
 	@staticmethod
 	def _loadType():
-		return Util.loadUint8()
+		type = Util.loadUint8()
+		scale = 0
+		if type in Type.FixedPointTypes:
+			scale = Util.loadUint32()
+		return type, scale
 	
 	@staticmethod
 	def __loadVariable(variable, loadType):
@@ -64,10 +68,16 @@ class Ls3:
 			variable.value = Ls3._loadGvec2d()
 		elif loadType == Type.GVEC3D:
 			variable.value = Ls3._loadGvec3d()
+		elif loadType in Type.PackedTypes:
+			variable.value = Ls3._loadPacked(loadType, variable.type.scale)
+		elif loadType == Type.SERIES_FLOAT or loadType == Type.SERIES_DOUBLE:
+			raise Exception("Series are not supported!")
 		elif loadType == Type.OBJECT:
 			variable.value = Ls3._loadObject()
 		elif loadType == Type.OBJPTR:
 			variable.value = Ls3._loadObject()
+		elif loadType == Type.LAZYOBJ:
+			raise Exception("Lazy objects are not supported!")
 		elif loadType == Type.HARRAY:
 			Ls3.__loadContainer(variable, loadType)
 		elif loadType == Type.HMAP:
@@ -81,10 +91,12 @@ class Ls3:
 		if variable.containerSize > 0:
 			typeSize = Util.loadUint32()
 			for i in xrange(typeSize):
-				loadType = Ls3._loadType()
+				loadType, scale = Ls3._loadType()
 				if loadType == Type.HARRAY or loadType == Type.HMAP:
 					raise Exception("Template container within a template container detected, not supported: %02X" % loadType)
-				variable.type.subTypes.append(Type(loadType))
+				variable.type.subTypes.append(Type(loadType, scale))
+			if Util._lengthPrefixed and typeSize == 1 and variable.type.subTypes[0].value in Type.VariableSizeTypes:
+				Util.stream.read(8) # block size, only needed for skipping
 			variable.createSubVariables()
 			for subVariable in variable.subVariables:
 				Ls3.__loadVariable(subVariable, subVariable.type.value)
@@ -144,6 +156,18 @@ class Ls3:
 	def _loadGvec3d():
 		return [Util.loadDouble(), Util.loadDouble(), Util.loadDouble()]
 
+	@staticmethod
+	def _loadPacked(type, scale):
+		values = []
+		for i in xrange(Type.PackedTypes[type]):
+			if type in Type.FixedPointTypes:
+				values.append(Util.loadFixed(scale))
+			else:
+				values.append(Util.loadHalf())
+		if len(values) == 1:
+			return values[0]
+		return values
+
 	@staticmethod
 	def _loadObject():
 		id = 0
@@ -153,28 +177,60 @@ class Ls3:
 			id = Util.loadUint32()
 			result, object = Util._tryGetObject(id)
 		if not result:
-			className = Ls3._loadString()
+			if Util._schemaTable:
+				className, fields = Ls3._loadSchema()
+			else:
+				className = Ls3._loadString()
 			if object == None:
 				object = Object(className)
 			if Util._allowMultiReferencing:
 				Util._tryMapObject(object)
+			if Util._lengthPrefixed:
+				Util.stream.read(8) # block size, only needed for skipping
+			if Util._schemaTable:
+				for variableName, loadType, scale in fields:
+					variable = Variable(variableName, loadType, scale)
+					object.variables.append(variable)
+					Ls3.__loadVariable(variable, loadType)
+			else:
+				size = Util.loadUint32()
+				for i in xrange(size):
+					variableName = Ls3._loadString()
+					loadType, scale = Ls3._loadType()
+					variable = Variable(variableName, loadType, scale)
+					object.variables.append(variable)
+					Ls3.__loadVariable(variable, loadType)
+		return object
+
+	@staticmethod
+	def _loadSchema():
+		id = Util.loadUint32()
+		result, schema = Util._tryGetSchema(id)
+		if not result:
+			className = Ls3._loadString()
+			Util.loadUint64() # layout fingerprint, only needed by the native loader
+			fields = []
 			size = Util.loadUint32()
 			for i in xrange(size):
 				variableName = Ls3._loadString()
-				loadType = Ls3._loadType()
-				variable = Variable(variableName, loadType)
-				object.variables.append(variable)
-				Ls3.__loadVariable(variable, loadType)
-		return object
+				loadType, scale = Ls3._loadType()
+				fields.append((variableName, loadType, scale))
+			schema = (className, tuple(fields))
+			Util._tryMapSchema(schema)
+		return schema
 		
 	@staticmethod
 	def dump(variable):
-		Ls3._dumpType(variable.type.value)
+		Ls3._dumpType(variable.type.value, variable.type.scale)
 		Ls3.__dumpVariable(variable)
 
 	@staticmethod
-	def _dumpType(type):
-		return Util.dumpUint8(type)
+	def _dumpType(type, scale):
+		Util.dumpUint8(type)
+		if type in Type.FixedPointTypes:
+			if scale == 0: # e.g. XML that was written before the scale was stored
+				raise Exception("Scale of fixed point type is not known: %02X" % type)
+			Util.dumpUint32(scale)
 	
 	@staticmethod
 	def __dumpVariable(variable):
@@ -224,6 +280,8 @@ class Ls3:
 			Ls3._dumpGvec2d(variable.value)
 		elif variable.type.value == Type.GVEC3D:
 			Ls3._dumpGvec3d(variable.value)
+		elif variable.type.value in Type.PackedTypes:
+			Ls3._dumpPacked(variable.value, variable.type.value, variable.type.scale)
 		elif variable.type.value == Type.OBJECT:
 			Ls3._dumpObject(variable.value)
 		elif variable.type.value == Type.OBJPTR:
@@ -239,7 +297,7 @@ class Ls3:
 		if variable.containerSize > 0:
 			Util.dumpUint32(len(variable.type.subTypes))
 			for type in variable.type.subTypes:
-				Ls3._dumpType(type.value)
+				Ls3._dumpType(type.value, type.scale)
 			for subVariable in variable.subVariables:
 				Ls3.__dumpVariable(subVariable)
 
@@ -306,6 +364,17 @@ class Ls3:
 		for i in value:
 			Util.dumpDouble(i)
 
+	@staticmethod
+	def _dumpPacked(value, type, scale):
+		values = value
+		if Type.PackedTypes[type] == 1:
+			values = [value]
+		for i in values:
+			if type in Type.FixedPointTypes:
+				Util.dumpFixed(i, scale)
+			else:
+				Util.dumpHalf(i)
+
 	@staticmethod
 	def _dumpObject(value):
 		result = True
@@ -313,10 +382,20 @@ class Ls3:
 			result, id = Util._tryMapObject(value)
 			Util.dumpUint32(id)
 		if result:
-			Ls3._dumpString(value.className)
-			Util.dumpUint32(len(value.variables))
+			Ls3._dumpSchema(value)
 			for variable in value.variables:
-				Ls3._dumpString(variable.name)
-				Ls3._dumpType(variable.type.value)
 				Ls3.__dumpVariable(variable)
 
+	@staticmethod
+	def _dumpSchema(value):
+		fields = tuple([(variable.name, variable.type.value, variable.type.scale) for variable in value.variables])
+		result, id = Util._tryMapSchema((value.className, fields))
+		Util.dumpUint32(id)
+		if result:
+			Ls3._dumpString(value.className)
+			Util.dumpUint64(Util._fingerprint(fields))
+			Util.dumpUint32(len(fields))
+			for variableName, type, scale in fields:
+				Ls3._dumpString(variableName)
+				Ls3._dumpType(type, scale)
+
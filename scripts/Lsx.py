@@ -22,6 +22,12 @@ class Lsx:
 	@staticmethod
 	def _loadType(node):
 		return int(node.getAttribute("type"), 16)
+
+	@staticmethod
+	def _loadScale(node):
+		if not node.hasAttribute("scale"): # only fixed point values have a scale
+			return 0
+		return int(node.getAttribute("scale"))
 	
 	@staticmethod
 	def __loadVariable(node, variable, loadType):
@@ -71,10 +77,15 @@ class Lsx:
 			variable.value = Lsx._loadGvec2d(node)
 		elif loadType == Type.GVEC3D:
 			variable.value = Lsx._loadGvec3d(node)
+		elif loadType in Type.PackedTypes:
+			variable.value = Lsx._loadPacked(node, loadType)
 		elif loadType == Type.OBJECT:
 			variable.value = Lsx._loadObject(node)
 		elif loadType == Type.OBJPTR:
 			variable.value = Lsx._loadObject(node)
+		elif loadType == Type.LAZYOBJ:
+			variable.type.value = Type.OBJPTR # lazy objects are loaded the same way as objects
+			variable.value = Lsx._loadObject(node)
 		elif loadType == Type.HARRAY:
 			Lsx.__loadContainer(node, variable, loadType)
 		elif loadType == Type.HMAP:
@@ -88,17 +99,27 @@ class Lsx:
 		variable.containerSize = len(children)
 		if variable.containerSize > 0:
 			subTypes = node.getAttribute("sub_types").split(",")
-			for subType in subTypes:
-				loadType = int(subType, 16)
+			scales = [0] * len(subTypes)
+			if node.hasAttribute("sub_scales"): # only written if there are fixed point values
+				scales = [int(scale) for scale in node.getAttribute("sub_scales").split(",")]
+			for i in xrange(len(subTypes)):
+				loadType = int(subTypes[i], 16)
 				if loadType == Type.HARRAY or loadType == Type.HMAP:
 					raise Exception("Template container within a template container detected, not supported: %02X" % loadType)
-				variable.type.subTypes.append(Type(loadType))
+				variable.type.subTypes.append(Type(loadType, scales[i]))
 			variable.createSubVariables()
 			for i in xrange(len(variable.subVariables)):
 				Lsx.__loadVariable(children[i], variable.subVariables[i], variable.subVariables[i].type.value)
 			if len(variable.type.subTypes) > 1: # requires this correction due to HMAP having subcontainers
 				variable.containerSize = variable.subVariables[0].containerSize
 
+	@staticmethod
+	def _loadPacked(node, type):
+		values = [float(value) for value in node.getAttribute("value").split(",")]
+		if Type.PackedTypes[type] == 1:
+			return values[0]
+		return values
+
 	@staticmethod
 	def _loadString(node):
 		return node.getAttribute("value")
@@ -195,7 +216,7 @@ class Lsx:
 			for child in children:
 				variableName = child.getAttribute("name")
 				loadType = Lsx._loadType(child)
-				variable = Variable(variableName, loadType)
+				variable = Variable(variableName, loadType, Lsx._loadScale(child))
 				object.variables.append(variable)
 				Lsx.__loadVariable(child, variable, loadType)
 		return object
@@ -205,7 +226,7 @@ class Lsx:
 		if variable.type.value == Type.OBJPTR:
 			Lsx.__dumpVariable(variable)
 		else:
-			Util._openNode("Container type=\"%02X\" sub_types=\"%02X\"" % (variable.type.value, variable.type.subTypes[0].value))
+			Util._openNode("Container type=\"%02X\"%s" % (variable.type.value, Lsx._getSubTypes(variable.type.subTypes)))
 			if variable.type.subTypes[0].value == Type.OBJPTR:
 				for subVariable in variable.subVariables:
 					Lsx.__dumpVariable(subVariable)
@@ -216,20 +237,30 @@ class Lsx:
 					Util._finishLine("\"")
 			Util._closeNode("Container")
 
+	@staticmethod
+	def _getScale(type):
+		if type.value not in Type.FixedPointTypes:
+			return ""
+		return " scale=\"%d\"" % type.scale
+
+	@staticmethod
+	def _getSubTypes(subTypes):
+		result = " sub_types=\"%s\"" % ",".join(["%02X" % type.value for type in subTypes])
+		if len([type for type in subTypes if type.value in Type.FixedPointTypes]) > 0:
+			result += " sub_scales=\"%s\"" % ",".join([str(type.scale) for type in subTypes])
+		return result
+
 	@staticmethod
 	def __dumpVariableStart(variable):
 		if variable.type.value == Type.HARRAY or variable.type.value == Type.HMAP:
-			types = []
-			for type in variable.type.subTypes:
-				types.append("%02X" % type.value)
 			if variable.containerSize > 0:
-				Util._openNode("Variable name=\"%s\" type=\"%02X\" sub_types=\"%s\"" % (variable.name, variable.type.value, ",".join(types)))
+				Util._openNode("Variable name=\"%s\" type=\"%02X\"%s" % (variable.name, variable.type.value, Lsx._getSubTypes(variable.type.subTypes)))
 			else:
-				Util._writeNode("Variable name=\"%s\" type=\"%02X\" sub_types=\"%s\"" % (variable.name, variable.type.value, ",".join(types)))
+				Util._writeNode("Variable name=\"%s\" type=\"%02X\"%s" % (variable.name, variable.type.value, Lsx._getSubTypes(variable.type.subTypes)))
 		elif variable.type.value == Type.OBJECT or variable.type.value == Type.OBJPTR:
 			Util._openNode("Variable name=\"%s\" type=\"%02X\"" % (variable.name, variable.type.value))
 		else:
-			Util._startLine("Variable name=\"%s\" type=\"%02X\" value=\"" % (variable.name, variable.type.value))
+			Util._startLine("Variable name=\"%s\" type=\"%02X\"%s value=\"" % (variable.name, variable.type.value, Lsx._getScale(variable.type)))
 
 	@staticmethod
 	def __dumpVariableFinish(variable):
@@ -292,6 +323,8 @@ class Lsx:
 			Lsx._dumpGvec2d(variable.value)
 		elif variable.type.value == Type.GVEC3D:
 			Lsx._dumpGvec3d(variable.value)
+		elif variable.type.value in Type.PackedTypes:
+			Lsx._dumpPacked(variable.value, variable.type.value)
 		elif variable.type.value == Type.OBJECT:
 			Lsx._dumpObject(variable.value)
 		elif variable.type.value == Type.OBJPTR:
@@ -304,13 +337,10 @@ class Lsx:
 	@staticmethod
 	def __dumpContainerVariableStart(variable):
 		if variable.type.value == Type.HARRAY or variable.type.value == Type.HMAP:
-			types = []
-			for type in variable.type.subTypes:
-				types.append("%02X" % type.value)
 			if variable.containerSize > 0:
-				Util._openNode("Container sub_types=\"%s\"" % ",".join(types))
+				Util._openNode("Container%s" % Lsx._getSubTypes(variable.type.subTypes))
 			else:
-				Util._writeNode("Container sub_types=\"%s\"" % ",".join(types))
+				Util._writeNode("Container%s" % Lsx._getSubTypes(variable.type.subTypes))
 		elif variable.type.value != Type.OBJECT and variable.type.value != Type.OBJPTR:
 			Util._startLine("Element value=\"")
 
@@ -330,6 +360,13 @@ class Lsx:
 				Lsx.__dumpVariable(subVariable)
 				Lsx.__dumpContainerVariableFinish(subVariable)
 
+	@staticmethod
+	def _dumpPacked(value, type):
+		values = value
+		if Type.PackedTypes[type] == 1:
+			values = [value]
+		Util.stream.write(",".join(["%g" % i for i in values]))
+
 	@staticmethod
 	def _dumpString(value):
 		Util.stream.write(value)
@@ -1,5 +1,6 @@
 import xml.dom.minidom
 
+from StringIO import StringIO
 from xml.dom.minidom import parse
 
 from Ls3 import *
@@ -46,7 +47,43 @@ class Model:
 			minor = Util.loadUint32()
 			Util._allowMultiReferencing = Util.loadBool()
 			Util._stringPooling = Util.loadBool()
+			compressed = False
+			indexed = False
+			delta = False
+			columnar = False
+			encodedArrays = False
+			compactIntegers = False
+			if headerSize > Model.HEADER_SIZE:
+				compressed = Util.loadBool()
+			if headerSize > Model.HEADER_SIZE + 1:
+				indexed = Util.loadBool()
+			if headerSize > Model.HEADER_SIZE + 2:
+				Util._lengthPrefixed = Util.loadBool()
+			if headerSize > Model.HEADER_SIZE + 3:
+				delta = Util.loadBool()
+			if headerSize > Model.HEADER_SIZE + 4:
+				Util.stream.read(min(headerSize, Model.HEADER_SIZE + 12) - Model.HEADER_SIZE - 4)
+			if headerSize > Model.HEADER_SIZE + 12:
+				columnar = Util.loadBool()
+			if headerSize > Model.HEADER_SIZE + 13:
+				encodedArrays = Util.loadBool()
+			if headerSize > Model.HEADER_SIZE + 14:
+				compactIntegers = Util.loadBool()
+				Util.stream.read(headerSize - Model.HEADER_SIZE - 15)
 			Model._checkVersion(major, minor)
+			if indexed:
+				raise Exception("Indexed data is not supported!")
+			if delta:
+				raise Exception("Delta data is not supported!")
+			if columnar:
+				raise Exception("Columnar data is not supported!")
+			if encodedArrays:
+				raise Exception("Encoded arrays are not supported!")
+			if compactIntegers:
+				raise Exception("Compact integers are not supported!")
+			if compressed:
+				Util.stream = StringIO(Util.decompressBlocks())
+			Util._schemaTable = (major > 3 or (major == 3 and minor >= 2))
 			data = Ls3.load()
 		finally:
 			if file != None:
@@ -123,4 +160,4 @@ class Model:
 		if major != Util.VersionMajor:
 			raise Exception("Liteser Read Error! Version mismatch: expected %d.%d, got %d.%d" % (Util.VersionMajor, Util.VersionMinor, major, minor))
 		if minor < Util.VersionMinor:
-			raise Exception("Minor version mismatch while loading: expected %d.%d, got %d.%d" % (Util.VersionMajor, Util.VersionMinor, major, minor))
+			print "WARNING: Minor version mismatch while loading: expected %d.%d, got %d.%d" % (Util.VersionMajor, Util.VersionMinor, major, minor)
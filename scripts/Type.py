@@ -14,6 +14,7 @@ class Type:
 	BOOL		= 0x41
 	OBJECT		= 0x61
 	OBJPTR		= 0x62
+	LAZYOBJ		= 0x63
 	HSTR		= 0x81
 	HVERSION	= 0x82
 	HENUM		= 0x83
@@ -26,11 +27,28 @@ class Type:
 	GRECTD		= 0x91
 	GVEC2D		= 0x92
 	GVEC3D		= 0x93
+	HALF_FLOAT	= 0xB1
+	HALF_GVEC2F	= 0xB2
+	HALF_GVEC3F	= 0xB3
+	HALF_GRECTF	= 0xB4
+	FIXED_FLOAT	= 0xB5
+	FIXED_GVEC2F	= 0xB6
+	FIXED_GVEC3F	= 0xB7
+	FIXED_GRECTF	= 0xB8
+	SERIES_FLOAT	= 0xB9
+	SERIES_DOUBLE	= 0xBA
 	HARRAY		= 0xA1
 	HMAP		= 0xC1
 	
-	def __init__(self, value):
+	VariableSizeTypes = [OBJECT, OBJPTR, LAZYOBJ, HSTR, HARRAY, HMAP]
+	# number of 16 bit values that a value of the type is packed into
+	PackedTypes = {HALF_FLOAT: 1, HALF_GVEC2F: 2, HALF_GVEC3F: 3, HALF_GRECTF: 4, FIXED_FLOAT: 1, FIXED_GVEC2F: 2, FIXED_GVEC3F: 3, FIXED_GRECTF: 4}
+	# the scale of these is stored after their identifier
+	FixedPointTypes = [FIXED_FLOAT, FIXED_GVEC2F, FIXED_GVEC3F, FIXED_GRECTF]
+	
+	def __init__(self, value, scale = 0):
 		self.value = value
+		self.scale = scale
 		self.subTypes = []
 
 	
\ No newline at end of file
@@ -11,7 +11,7 @@ class Util:
 	Header2 = struct.unpack("<b", "B")[0]
 	Header3 = struct.unpack("<b", "D")[0]
 	VersionMajor = 3
-	VersionMinor = 1
+	VersionMinor = 2
 	
 	@staticmethod
 	def getFileList(path):
@@ -36,10 +36,14 @@ class Util:
 	strings = []
 	objectIds = {}
 	stringIds = {}
+	schemas = []
+	schemaIds = {}
 	stream = None
 	_indent = "\t"
 	_allowMultiReferencing = True
 	_stringPooling = True
+	_schemaTable = True
+	_lengthPrefixed = False
 	
 	@staticmethod
 	def start(_stream):
@@ -47,10 +51,14 @@ class Util:
 		Util.strings = []
 		Util.objectIds = {}
 		Util.stringIds = {}
+		Util.schemas = []
+		Util.schemaIds = {}
 		Util.stream = _stream
 		Util._indent = "\t"
 		Util._allowMultiReferencing = True
 		Util._stringPooling = True
+		Util._schemaTable = True
+		Util._lengthPrefixed = False
 	
 	@staticmethod
 	def finish(_stream):
@@ -58,6 +66,8 @@ class Util:
 		Util.strings = []
 		Util.objectIds = {}
 		Util.stringIds = {}
+		Util.schemas = []
+		Util.schemaIds = {}
 		Util.stream = None
 		Util._indent = "\t"
 
@@ -98,6 +108,37 @@ class Util:
 			Util.stringIds[string] = id - 1
 			return True, id
 		return False, Util.stringIds[string] + 1
+
+	@staticmethod
+	def _tryGetSchema(id):
+		if id == 0:
+			raise Exception("Invalid schema ID!")
+		if id - 1 >= len(Util.schemas):
+			return False, None
+		return True, Util.schemas[id - 1]
+
+	@staticmethod
+	def _fingerprint(fields):
+		# FNV-1a over each field name, a terminating zero, the type identifier and the scale of fixed point numbers
+		result = 14695981039346656037
+		for name, type, scale in fields:
+			if isinstance(name, unicode):
+				name = name.encode("utf-8")
+			values = [ord(c) for c in name] + [0, type]
+			if scale != 0: # layouts without fixed point numbers keep their fingerprints
+				values += [(scale >> (i * 8)) & 0xFF for i in xrange(4)]
+			for value in values:
+				result = ((result ^ value) * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+		return result
+
+	@staticmethod
+	def _tryMapSchema(schema):
+		if not schema in Util.schemaIds.keys():
+			Util.schemas.append(schema)
+			id = len(Util.schemas)
+			Util.schemaIds[schema] = id - 1
+			return True, id
+		return False, Util.schemaIds[schema] + 1
 		
 	# XML utility
 	@staticmethod
@@ -186,6 +227,77 @@ class Util:
 	@staticmethod
 	def loadHstr():
 		return Util.stream.read(Util.loadUint32())
+
+	@staticmethod
+	def loadHalf():
+		half = Util.loadUint16()
+		sign = (half & 0x8000) << 16
+		exponent = (half >> 10) & 0x1F
+		mantissa = half & 0x3FF
+		bits = sign
+		if exponent == 0x1F:
+			bits |= 0x7F800000 | (mantissa << 13)
+		elif exponent > 0:
+			bits |= ((exponent + 127 - 15) << 23) | (mantissa << 13)
+		elif mantissa != 0: # subnormal values are normal floats
+			exponent = 127 - 15 + 1
+			while (mantissa & 0x400) == 0:
+				mantissa <<= 1
+				exponent -= 1
+			bits |= (exponent << 23) | ((mantissa & 0x3FF) << 13)
+		return struct.unpack("<f", struct.pack("<I", bits))[0]
+
+	@staticmethod
+	def loadFixed(scale):
+		return Util.loadInt16() / float(scale)
+
+	# compressed data
+	@staticmethod
+	def decompressBlocks():
+		result = []
+		size = Util.loadUint32()
+		while size > 0:
+			compressedSize = Util.loadUint32()
+			if compressedSize == 0: # stored uncompressed
+				result.append(Util.stream.read(size))
+			else:
+				block = Util._decompressBlock(Util.stream.read(compressedSize))
+				if len(block) != size:
+					raise Exception("Compressed data is corrupted!")
+				result.append(block)
+			size = Util.loadUint32()
+		return "".join(result)
+		
+	@staticmethod
+	def _decompressBlock(data):
+		output = bytearray()
+		i = 0
+		while i < len(data):
+			token = ord(data[i])
+			i += 1
+			length, i = Util._decompressLength(data, i, token >> 4)
+			output.extend(data[i:i + length])
+			i += length
+			if i >= len(data): # last sequence has literals only
+				break
+			offset = ord(data[i]) | (ord(data[i + 1]) << 8)
+			i += 2
+			length, i = Util._decompressLength(data, i, token & 0x0F)
+			start = len(output) - offset
+			# matches may overlap with their own output
+			for j in xrange(length + 4):
+				output.append(output[start + j])
+		return str(output)
+		
+	@staticmethod
+	def _decompressLength(data, i, length):
+		if length == 15:
+			value = 255
+			while value == 255:
+				value = ord(data[i])
+				i += 1
+				length += value
+		return length, i
 	
 	# binary data dumping
 	@staticmethod
@@ -239,4 +351,44 @@ class Util:
 	def dumpHstr(value):
 		Util.dumpUint32(len(value))
 		Util.stream.write(value)
+
+	@staticmethod
+	def dumpHalf(value):
+		# same rounding as the native packing, ties are rounded to even
+		bits = struct.unpack("<I", struct.pack("<f", value))[0]
+		sign = (bits >> 16) & 0x8000
+		exponent = (bits >> 23) & 0xFF
+		mantissa = bits & 0x7FFFFF
+		if exponent == 0xFF: # NaN keeps a bit of its mantissa so it does not become infinity
+			if mantissa != 0:
+				return Util.dumpUint16(sign | 0x7C00 | 0x200)
+			return Util.dumpUint16(sign | 0x7C00)
+		exponent -= 127 - 15
+		if exponent >= 0x1F:
+			return Util.dumpUint16(sign | 0x7C00)
+		if exponent > 0:
+			half = (exponent << 10) | (mantissa >> 13)
+			remainder = mantissa & 0x1FFF
+			halfway = 0x1000
+		else:
+			if exponent < -10:
+				return Util.dumpUint16(sign)
+			mantissa |= 0x800000
+			shift = 14 - exponent
+			half = mantissa >> shift
+			remainder = mantissa & ((1 << shift) - 1)
+			halfway = 1 << (shift - 1)
+		if remainder > halfway or (remainder == halfway and (half & 1) != 0):
+			half += 1
+		return Util.dumpUint16(sign | half)
+
+	@staticmethod
+	def dumpFixed(value, scale):
+		scaled = value * scale
+		if scaled != scaled: # NaN
+			return Util.dumpInt16(0)
+		scaled = min(max(scaled, -32768.0), 32767.0)
+		if scaled < 0.0:
+			return Util.dumpInt16(int(scaled - 0.5))
+		return Util.dumpInt16(int(scaled + 0.5))
 	
@@ -2,9 +2,9 @@ from Type import *
 
 class Variable:
 
-	def __init__(self, name, type):
+	def __init__(self, name, type, scale = 0):
 		self.name = name
-		self.type = Type(type)
+		self.type = Type(type, scale)
 		self.subVariables = []
 		self.containerSize = 0
 		self.value = None
@@ -12,7 +12,7 @@ class Variable:
 	def createSubVariables(self):
 		if self.type.value == Type.HARRAY:
 			for i in xrange(self.containerSize):
-				self.subVariables.append(Variable("", self.type.subTypes[0].value))
+				self.subVariables.append(Variable("", self.type.subTypes[0].value, self.type.subTypes[0].scale))
 		if self.type.value == Type.HMAP:
 			for i in xrange(2):
 				self.subVariables.append(Variable("", Type.HARRAY))
@@ -0,0 +1,84 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <hltypes/hmap.h>
+#include <hltypes/hmutex.h>
+
+#include "Allocator.h"
+
+// the number of blocks is only changed under the lock, but it is read without it
+#ifdef _MSC_VER
+#define ADD_BLOCK_COUNT(amount) _InterlockedExchangeAdd(&__blockCount, amount)
+#define GET_BLOCK_COUNT() _InterlockedCompareExchange(&__blockCount, 0, 0)
+#else
+#define ADD_BLOCK_COUNT(amount) __atomic_add_fetch(&__blockCount, amount, __ATOMIC_RELEASE)
+#define GET_BLOCK_COUNT() __atomic_load_n(&__blockCount, __ATOMIC_ACQUIRE)
+#endif
+
+namespace liteser
+{
+	struct __Block
+	{
+		unsigned char* end;
+		Allocator* allocator;
+	};
+
+	// blocks of all allocators by their start, objects can be released on any thread
+	static hmap<unsigned char*, __Block> __blocks;
+	static hmutex __blocksMutex;
+	// objects that were created with new are released without taking the lock as long as no allocator has any memory
+	static volatile long __blockCount = 0;
+
+	Allocator::Allocator()
+	{
+	}
+
+	Allocator::~Allocator()
+	{
+	}
+
+	Allocator* Allocator::_find(void* memory)
+	{
+		if (GET_BLOCK_COUNT() == 0)
+		{
+			return NULL;
+		}
+		hmutex::ScopeLock lock(&__blocksMutex);
+		hmap<unsigned char*, __Block>::iterator it = __blocks.upper_bound((unsigned char*)memory);
+		if (it == __blocks.begin())
+		{
+			return NULL;
+		}
+		--it;
+		return ((unsigned char*)memory < it->second.end ? it->second.allocator : NULL);
+	}
+
+	void Allocator::_addBlock(unsigned char* block, int size)
+	{
+		hmutex::ScopeLock lock(&__blocksMutex);
+		__Block entry;
+		entry.end = block + size;
+		entry.allocator = this;
+		__blocks[block] = entry;
+		ADD_BLOCK_COUNT(1);
+	}
+
+	void Allocator::_removeBlock(unsigned char* block)
+	{
+		hmutex::ScopeLock lock(&__blocksMutex);
+		if (__blocks.removeKey(block))
+		{
+			ADD_BLOCK_COUNT(-1);
+		}
+	}
+
+}
@@ -0,0 +1,663 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <hltypes/harray.h>
+#include <hltypes/hexception.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hmutex.h>
+#include <hltypes/hthread.h>
+
+#include "Compression.h"
+#include "Reader.h"
+
+#define LITESER_LZ_MIN_MATCH 4
+#define LITESER_LZ_MAX_OFFSET 65535
+#define LITESER_LZ_HASH_BITS 14
+// the block always ends with literals and no match may start this close to the end
+#define LITESER_LZ_LAST_LITERALS 5
+#define LITESER_LZ_MATCH_LIMIT 12
+// blocks are decompressed in batches of this size, one block for every thread
+#define LITESER_DECOMPRESSION_BATCH_SIZE (LITESER_COMPRESSION_BLOCK_SIZE * LITESER_COMPRESSION_THREADS)
+// a batch is decompressed after room for data that the reader did not consume yet, larger leftovers are copied into a buffer of their own
+#define LITESER_DECOMPRESSION_HEADROOM LITESER_COMPRESSION_BLOCK_SIZE
+// decompressed data is kept in buffers of this size unless a single value is larger
+#define LITESER_DECOMPRESSION_BUFFER_SIZE (LITESER_DECOMPRESSION_HEADROOM + LITESER_DECOMPRESSION_BATCH_SIZE)
+
+namespace liteser
+{
+	CompressionBlock::CompressionBlock(const unsigned char* source, int sourceSize, unsigned char* destination, int destinationSize) :
+		source(source),
+		sourceSize(sourceSize),
+		destination(destination),
+		destinationSize(destinationSize),
+		result(0)
+	{
+	}
+
+	/// @brief A lock with a condition that threads can wait for without using the CPU.
+	class CompressionMonitor
+	{
+	public:
+		CompressionMonitor()
+		{
+#ifdef _WIN32
+			InitializeCriticalSectionEx(&this->section, 0, 0);
+			InitializeConditionVariable(&this->condition);
+#else
+			pthread_mutex_init(&this->mutex, NULL);
+			pthread_cond_init(&this->condition, NULL);
+#endif
+		}
+
+		~CompressionMonitor()
+		{
+#ifdef _WIN32
+			DeleteCriticalSection(&this->section);
+#else
+			pthread_cond_destroy(&this->condition);
+			pthread_mutex_destroy(&this->mutex);
+#endif
+		}
+
+		inline void lock()
+		{
+#ifdef _WIN32
+			EnterCriticalSection(&this->section);
+#else
+			pthread_mutex_lock(&this->mutex);
+#endif
+		}
+
+		inline void unlock()
+		{
+#ifdef _WIN32
+			LeaveCriticalSection(&this->section);
+#else
+			pthread_mutex_unlock(&this->mutex);
+#endif
+		}
+
+		/// @brief Releases the lock until another thread calls notifyAll(), it is held again when this returns.
+		/// @note Threads can also wake up without a notification so they have to check what they wait for again.
+		inline void wait()
+		{
+#ifdef _WIN32
+			SleepConditionVariableCS(&this->condition, &this->section, INFINITE);
+#else
+			pthread_cond_wait(&this->condition, &this->mutex);
+#endif
+		}
+
+		inline void notifyAll()
+		{
+#ifdef _WIN32
+			WakeAllConditionVariable(&this->condition);
+#else
+			pthread_cond_broadcast(&this->condition);
+#endif
+		}
+
+	protected:
+#ifdef _WIN32
+		CRITICAL_SECTION section;
+		CONDITION_VARIABLE condition;
+#else
+		pthread_mutex_t mutex;
+		pthread_cond_t condition;
+#endif
+
+	};
+
+	class CompressionThread : public hthread
+	{
+	public:
+		CompressionPool* pool;
+
+		CompressionThread(CompressionPool* pool) : hthread(&CompressionThread::_process), pool(pool)
+		{
+		}
+
+		static void process(CompressionBlock* block, bool compress)
+		{
+			if (compress)
+			{
+				block->result = _compressBlock(block->source, block->sourceSize, block->destination, block->destinationSize);
+			}
+			else if (block->result == 0)
+			{
+				memcpy(block->destination, block->source, block->destinationSize);
+			}
+			else if (!_decompressBlock(block->source, block->sourceSize, block->destination, block->destinationSize))
+			{
+				block->result = -1;
+			}
+		}
+
+	protected:
+		static void _process(hthread* thread)
+		{
+			CompressionPool::_work(((CompressionThread*)thread)->pool);
+		}
+
+	};
+
+	static inline unsigned int __read32(const unsigned char* data)
+	{
+		unsigned int result;
+		memcpy(&result, data, sizeof(result));
+		return result;
+	}
+
+	static inline unsigned int __hash(unsigned int value)
+	{
+		return ((value * 2654435761u) >> (32 - LITESER_LZ_HASH_BITS));
+	}
+
+	static inline bool __writeLength(unsigned char** output, unsigned char* outputEnd, int length)
+	{
+		while (length >= 255)
+		{
+			if (*output >= outputEnd)
+			{
+				return false;
+			}
+			*(*output)++ = 255;
+			length -= 255;
+		}
+		if (*output >= outputEnd)
+		{
+			return false;
+		}
+		*(*output)++ = (unsigned char)length;
+		return true;
+	}
+
+	static inline bool __writeSequence(unsigned char** output, unsigned char* outputEnd, const unsigned char* literals, int literalLength, int offset, int matchLength)
+	{
+		if (*output >= outputEnd)
+		{
+			return false;
+		}
+		unsigned char* token = (*output)++;
+		*token = (unsigned char)(hmin(literalLength, 15) << 4);
+		if (literalLength >= 15 && !__writeLength(output, outputEnd, literalLength - 15))
+		{
+			return false;
+		}
+		if (outputEnd - *output < literalLength)
+		{
+			return false;
+		}
+		memcpy(*output, literals, literalLength);
+		*output += literalLength;
+		if (matchLength == 0) // last sequence has literals only
+		{
+			return true;
+		}
+		if (outputEnd - *output < 2)
+		{
+			return false;
+		}
+		*(*output)++ = (unsigned char)(offset & 0xFF);
+		*(*output)++ = (unsigned char)((offset >> 8) & 0xFF);
+		matchLength -= LITESER_LZ_MIN_MATCH;
+		*token |= (unsigned char)hmin(matchLength, 15);
+		return (matchLength < 15 || __writeLength(output, outputEnd, matchLength - 15));
+	}
+
+	int _compressBlock(const unsigned char* source, int sourceSize, unsigned char* destination, int destinationSize)
+	{
+		int table[1 << LITESER_LZ_HASH_BITS];
+		memset(table, 0xFF, sizeof(table));
+		const unsigned char* input = source;
+		const unsigned char* anchor = source;
+		const unsigned char* end = source + sourceSize;
+		const unsigned char* matchLimit = end - LITESER_LZ_MATCH_LIMIT;
+		const unsigned char* match = NULL;
+		unsigned char* output = destination;
+		unsigned char* outputEnd = destination + destinationSize;
+		unsigned int hash = 0;
+		int candidate = 0;
+		int matchLength = 0;
+		if (sourceSize > LITESER_LZ_MATCH_LIMIT)
+		{
+			while (input < matchLimit)
+			{
+				hash = __hash(__read32(input));
+				candidate = table[hash];
+				table[hash] = (int)(input - source);
+				if (candidate < 0 || (input - source) - candidate > LITESER_LZ_MAX_OFFSET || __read32(source + candidate) != __read32(input))
+				{
+					++input;
+					continue;
+				}
+				match = source + candidate;
+				while (input > anchor && match > source && input[-1] == match[-1])
+				{
+					--input;
+					--match;
+				}
+				matchLength = LITESER_LZ_MIN_MATCH;
+				while (input + matchLength < end - LITESER_LZ_LAST_LITERALS && input[matchLength] == match[matchLength])
+				{
+					++matchLength;
+				}
+				if (!__writeSequence(&output, outputEnd, anchor, (int)(input - anchor), (int)(input - match), matchLength))
+				{
+					return 0;
+				}
+				input += matchLength;
+				anchor = input;
+			}
+		}
+		if (!__writeSequence(&output, outputEnd, anchor, (int)(end - anchor), 0, 0))
+		{
+			return 0;
+		}
+		return (int)(output - destination);
+	}
+
+	static inline bool __readLength(const unsigned char** input, const unsigned char* inputEnd, int* length)
+	{
+		unsigned char value = 255;
+		while (value == 255)
+		{
+			if (*input >= inputEnd)
+			{
+				return false;
+			}
+			value = *(*input)++;
+			*length += value;
+		}
+		return true;
+	}
+
+	bool _decompressBlock(const unsigned char* source, int sourceSize, unsigned char* destination, int destinationSize)
+	{
+		const unsigned char* input = source;
+		const unsigned char* inputEnd = source + sourceSize;
+		unsigned char* output = destination;
+		unsigned char* outputEnd = destination + destinationSize;
+		unsigned char token = 0;
+		int length = 0;
+		int offset = 0;
+		while (input < inputEnd)
+		{
+			token = *input++;
+			length = (token >> 4);
+			if (length == 15 && !__readLength(&input, inputEnd, &length))
+			{
+				return false;
+			}
+			if (inputEnd - input < length || outputEnd - output < length)
+			{
+				return false;
+			}
+			memcpy(output, input, length);
+			input += length;
+			output += length;
+			if (input >= inputEnd) // last sequence has literals only
+			{
+				break;
+			}
+			if (inputEnd - input < 2)
+			{
+				return false;
+			}
+			offset = input[0] | (input[1] << 8);
+			input += 2;
+			length = (token & 0x0F);
+			if (length == 15 && !__readLength(&input, inputEnd, &length))
+			{
+				return false;
+			}
+			length += LITESER_LZ_MIN_MATCH;
+			if (offset == 0 || offset > output - destination || outputEnd - output < length)
+			{
+				return false;
+			}
+			// matches may overlap with their own output so they are copied byte by byte
+			for_iter (i, 0, length)
+			{
+				output[i] = output[i - offset];
+			}
+			output += length;
+		}
+		return (output == outputEnd);
+	}
+
+	CompressionJob::CompressionJob() :
+		compress(false),
+		next(0),
+		pending(0)
+	{
+	}
+
+	static CompressionPool* __sharedPool = NULL;
+	static hmutex __sharedPoolMutex;
+
+	CompressionPool::CompressionPool() :
+		monitor(new CompressionMonitor()),
+		running(true)
+	{
+	}
+
+	CompressionPool::~CompressionPool()
+	{
+		this->monitor->lock();
+		this->running = false;
+		this->monitor->notifyAll();
+		this->monitor->unlock();
+		foreach (CompressionThread*, it, this->threads)
+		{
+			(*it)->join();
+			delete (*it);
+		}
+		delete this->monitor;
+	}
+
+	CompressionPool& CompressionPool::getShared()
+	{
+		// this is only called once per batch of blocks so the lock does not matter
+		hmutex::ScopeLock lock(&__sharedPoolMutex);
+		if (__sharedPool == NULL)
+		{
+			__sharedPool = new CompressionPool();
+		}
+		return (*__sharedPool);
+	}
+
+	void CompressionPool::start(CompressionJob* job)
+	{
+		job->next = 0;
+		job->pending = job->blocks.size();
+		if (job->pending == 0)
+		{
+			return;
+		}
+		this->monitor->lock();
+		if (this->threads.size() == 0)
+		{
+			// the thread that waits for a job processes its blocks as well
+			for_iter (i, 1, LITESER_COMPRESSION_THREADS)
+			{
+				this->threads += new CompressionThread(this);
+				this->threads.last()->start();
+			}
+		}
+		this->jobs += job;
+		this->monitor->notifyAll();
+		this->monitor->unlock();
+	}
+
+	void CompressionPool::wait(CompressionJob* job)
+	{
+		CompressionBlock* block = NULL;
+		this->monitor->lock();
+		while (job->pending > 0)
+		{
+			block = this->_takeBlock(job);
+			if (block == NULL) // only blocks that other threads already started on are left
+			{
+				this->monitor->wait();
+				continue;
+			}
+			this->monitor->unlock();
+			CompressionThread::process(block, job->compress);
+			this->monitor->lock();
+			this->_finishBlock(job);
+		}
+		this->monitor->unlock();
+	}
+
+	CompressionBlock* CompressionPool::_takeBlock(CompressionJob* job)
+	{
+		if (job->next >= job->blocks.size())
+		{
+			return NULL;
+		}
+		CompressionBlock* block = &job->blocks[job->next];
+		++job->next;
+		if (job->next >= job->blocks.size())
+		{
+			this->jobs.remove(job);
+		}
+		return block;
+	}
+
+	void CompressionPool::_finishBlock(CompressionJob* job)
+	{
+		--job->pending;
+		if (job->pending == 0)
+		{
+			this->monitor->notifyAll();
+		}
+	}
+
+	void CompressionPool::_work(CompressionPool* pool)
+	{
+		CompressionJob* job = NULL;
+		CompressionBlock* block = NULL;
+		pool->monitor->lock();
+		while (pool->running)
+		{
+			if (pool->jobs.size() == 0)
+			{
+				pool->monitor->wait();
+				continue;
+			}
+			job = pool->jobs.first();
+			block = pool->_takeBlock(job);
+			pool->monitor->unlock();
+			CompressionThread::process(block, job->compress);
+			pool->monitor->lock();
+			pool->_finishBlock(job);
+		}
+		pool->monitor->unlock();
+	}
+
+	Decompressor::Decompressor(const Reader& input) :
+		input(input),
+		current(0),
+		jobSize(0),
+		jobStarted(false),
+		compressedBuffer(NULL),
+		finished(false)
+	{
+		this->buffers[0] = NULL;
+		this->buffers[1] = NULL;
+		this->capacities[0] = 0;
+		this->capacities[1] = 0;
+	}
+
+	Decompressor::~Decompressor()
+	{
+		// the threads could still be writing into the buffers
+		if (this->jobStarted)
+		{
+			CompressionPool::getShared().wait(&this->job);
+		}
+		for_iter (i, 0, 2)
+		{
+			if (this->buffers[i] != NULL)
+			{
+				delete[] this->buffers[i];
+			}
+		}
+		if (this->compressedBuffer != NULL)
+		{
+			delete[] this->compressedBuffer;
+		}
+	}
+
+	bool Decompressor::fill(Reader& reader, int64_t count)
+	{
+		if (!this->jobStarted)
+		{
+			this->_readAhead();
+		}
+		this->_waitBatch();
+		if (this->jobSize == 0) // the reader keeps what it has
+		{
+			return false;
+		}
+		int64_t kept = reader.remaining();
+		const unsigned char* unread = reader.readInPlace(kept);
+		int next = 1 - this->current;
+		unsigned char* data = this->buffers[next] + LITESER_DECOMPRESSION_HEADROOM;
+		int64_t size = kept + this->jobSize;
+		int64_t offset = LITESER_DECOMPRESSION_HEADROOM - kept;
+		if (kept > LITESER_DECOMPRESSION_HEADROOM || (size < count && !this->finished))
+		{
+			// values that are larger than a batch are collected in a buffer of their own
+			int64_t capacity = hmax(count, size) + LITESER_DECOMPRESSION_BATCH_SIZE;
+			unsigned char* buffer = new unsigned char[(size_t)capacity];
+			if (kept > 0)
+			{
+				memcpy(buffer, unread, (size_t)kept);
+			}
+			if (this->jobSize > 0)
+			{
+				memcpy(buffer + kept, data, (size_t)this->jobSize);
+			}
+			delete[] this->buffers[next];
+			this->buffers[next] = buffer;
+			this->capacities[next] = capacity;
+			offset = 0;
+			while (size < count && !this->finished)
+			{
+				this->_startBatch(buffer + size, capacity - size);
+				this->_waitBatch();
+				size += this->jobSize;
+			}
+		}
+		else if (kept > 0)
+		{
+			memcpy(this->buffers[next] + offset, unread, (size_t)kept);
+		}
+		reader._reset(this->buffers[next] + offset, size);
+		this->current = next;
+		// the blocks after these are decompressed while the reader decodes them
+		this->_readAhead();
+		return true;
+	}
+
+	int64_t Decompressor::remaining()
+	{
+		// the uncompressed size is not known, but it is not smaller than what is left of the input
+		return (this->finished ? 0 : this->input.available()) + (this->jobStarted ? this->jobSize : 0);
+	}
+
+	void Decompressor::finish()
+	{
+		this->_waitBatch();
+		CompressionBlock block;
+		while (!this->finished)
+		{
+			this->_readBlock(&block, NULL);
+		}
+	}
+
+	void Decompressor::_readAhead()
+	{
+		if (this->finished)
+		{
+			return;
+		}
+		int next = 1 - this->current;
+		// a buffer that grew for a large value is not kept
+		if (this->capacities[next] != LITESER_DECOMPRESSION_BUFFER_SIZE)
+		{
+			if (this->buffers[next] != NULL)
+			{
+				delete[] this->buffers[next];
+			}
+			this->buffers[next] = new unsigned char[LITESER_DECOMPRESSION_BUFFER_SIZE];
+			this->capacities[next] = LITESER_DECOMPRESSION_BUFFER_SIZE;
+		}
+		this->_startBatch(this->buffers[next] + LITESER_DECOMPRESSION_HEADROOM, LITESER_DECOMPRESSION_BATCH_SIZE);
+	}
+
+	void Decompressor::_startBatch(unsigned char* destination, int64_t capacity)
+	{
+		if (this->compressedBuffer == NULL)
+		{
+			this->compressedBuffer = new unsigned char[LITESER_DECOMPRESSION_BATCH_SIZE];
+		}
+		this->job.blocks.clear();
+		this->job.compress = false;
+		this->jobSize = 0;
+		CompressionBlock block;
+		while (!this->finished && this->job.blocks.size() < LITESER_COMPRESSION_THREADS && capacity - this->jobSize >= LITESER_COMPRESSION_BLOCK_SIZE)
+		{
+			if (this->_readBlock(&block, this->compressedBuffer + this->job.blocks.size() * LITESER_COMPRESSION_BLOCK_SIZE) > 0)
+			{
+				block.destination = destination + this->jobSize;
+				this->jobSize += block.destinationSize;
+				this->job.blocks += block;
+			}
+		}
+		this->jobStarted = (this->job.blocks.size() > 0);
+		if (this->jobStarted)
+		{
+			CompressionPool::getShared().start(&this->job);
+		}
+	}
+
+	void Decompressor::_waitBatch()
+	{
+		if (!this->jobStarted)
+		{
+			this->jobSize = 0;
+			return;
+		}
+		this->jobStarted = false;
+		CompressionPool::getShared().wait(&this->job);
+		foreach (CompressionBlock, it, this->job.blocks)
+		{
+			if ((*it).result < 0)
+			{
+				throw Exception("Compressed data is corrupted!");
+			}
+		}
+	}
+
+	int Decompressor::_readBlock(CompressionBlock* block, unsigned char* compressedData)
+	{
+		unsigned int blockSize = this->input.loadUint32();
+		if (blockSize == 0)
+		{
+			this->finished = true;
+			return 0;
+		}
+		unsigned int compressedSize = this->input.loadUint32();
+		if (blockSize > LITESER_COMPRESSION_BLOCK_SIZE || compressedSize >= blockSize)
+		{
+			throw Exception("Compressed data is corrupted!");
+		}
+		int sourceSize = (int)(compressedSize > 0 ? compressedSize : blockSize);
+		const unsigned char* source = this->input.readInPlace(sourceSize);
+		if (compressedData != NULL && this->input.hasSource())
+		{
+			// the input only keeps this memory until it is read further
+			memcpy(compressedData, source, sourceSize);
+			source = compressedData;
+		}
+		*block = CompressionBlock(source, sourceSize, NULL, (int)blockSize);
+		block->result = (int)compressedSize;
+		return (int)blockSize;
+	}
+
+}
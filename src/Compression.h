@@ -0,0 +1,153 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines the block compression of binary data.
+
+#ifndef LITESER_COMPRESSION_H
+#define LITESER_COMPRESSION_H
+
+#include <stdint.h>
+
+#include <hltypes/harray.h>
+
+#include "Reader.h"
+
+// uncompressed size of a single block, all blocks except the last one of a flush have this size
+#define LITESER_COMPRESSION_BLOCK_SIZE 262144
+// max number of blocks that are processed at the same time by a reader or writer
+#define LITESER_COMPRESSION_THREADS 4
+
+namespace liteser
+{
+	/// @brief A block of data that is compressed or decompressed independently of all others.
+	class CompressionBlock
+	{
+	public:
+		const unsigned char* source;
+		int sourceSize;
+		unsigned char* destination;
+		int destinationSize;
+		/// @brief Compressed size after compression, 0 if the block could not be made smaller.
+		int result;
+
+		CompressionBlock(const unsigned char* source = NULL, int sourceSize = 0, unsigned char* destination = NULL, int destinationSize = 0);
+
+	};
+
+	/// @brief Compresses data with an LZ77 codec using the LZ4 block layout.
+	/// @return Compressed size or 0 if the compressed data would not fit into the destination.
+	int _compressBlock(const unsigned char* source, int sourceSize, unsigned char* destination, int destinationSize);
+	/// @return False if the data is corrupted or does not decompress to exactly destinationSize bytes.
+	bool _decompressBlock(const unsigned char* source, int sourceSize, unsigned char* destination, int destinationSize);
+
+	class CompressionMonitor;
+	class CompressionThread;
+
+	/// @brief Blocks that are processed together, e.g. all blocks of one flush of the output.
+	class CompressionJob
+	{
+	public:
+		harray<CompressionBlock> blocks;
+		bool compress;
+
+		CompressionJob();
+
+	protected:
+		/// @brief Index of the next block that no thread has started on yet.
+		int next;
+		/// @brief Number of blocks that were not finished yet.
+		int pending;
+
+		friend class CompressionPool;
+
+	};
+
+	/// @brief Threads that process the blocks of all serialization calls of the process in parallel.
+	/// @note The threads are started for the first job and wait for further jobs without using the CPU.
+	class CompressionPool
+	{
+	public:
+		/// @brief Gets the pool that all readers and writers use, created on first use.
+		/// @note The pool is never destroyed since joining its threads during static destruction can deadlock, e.g. while a DLL is unloaded.
+		static CompressionPool& getShared();
+
+		CompressionPool();
+		~CompressionPool();
+
+		/// @brief Starts processing the blocks of the job in the background.
+		/// @note The job and the memory of its blocks have to stay valid until wait() was called for it.
+		void start(CompressionJob* job);
+		/// @brief Waits until all blocks of the job were processed, the current thread processes the blocks of the job that are left itself.
+		/// @note Decompressed blocks that are corrupted have a negative result.
+		void wait(CompressionJob* job);
+
+	protected:
+		harray<CompressionThread*> threads;
+		/// @brief Jobs with blocks that no thread has started on yet, oldest first.
+		harray<CompressionJob*> jobs;
+		/// @brief Guards the jobs and wakes up threads when a job was added or finished.
+		CompressionMonitor* monitor;
+		bool running;
+
+		/// @return The next block of the job or NULL if all of them were started already.
+		/// @note The monitor has to be locked.
+		CompressionBlock* _takeBlock(CompressionJob* job);
+		/// @note The monitor has to be locked.
+		void _finishBlock(CompressionJob* job);
+
+		static void _work(CompressionPool* pool);
+
+		friend class CompressionThread;
+
+	};
+
+	/// @brief Supplies the data of compressed blocks to a reader as it needs it, the next blocks are decompressed while the reader decodes the current ones.
+	class Decompressor : public ReaderSource
+	{
+	public:
+		/// @brief The compressed blocks and everything after them.
+		Reader input;
+
+		Decompressor(const Reader& input);
+		~Decompressor();
+
+		bool fill(Reader& reader, int64_t count);
+		int64_t remaining();
+		/// @brief Skips all blocks that were not decompressed yet so the input continues after them.
+		void finish();
+
+	protected:
+		/// @brief The reader decodes one of them while the next blocks are decompressed into the other one.
+		unsigned char* buffers[2];
+		int64_t capacities[2];
+		/// @brief Index of the buffer that the reader decodes.
+		int current;
+		/// @brief Blocks that are decompressed in the background.
+		CompressionJob job;
+		/// @brief Uncompressed size of the blocks of the job.
+		int64_t jobSize;
+		bool jobStarted;
+		/// @brief Compressed blocks of the job that were copied out of input that is only in memory until it is read further.
+		unsigned char* compressedBuffer;
+		bool finished;
+
+		/// @brief Starts decompressing the next blocks into the buffer that the reader does not use.
+		void _readAhead();
+		/// @brief Starts decompressing as many of the next blocks as fit into the given memory.
+		void _startBatch(unsigned char* destination, int64_t capacity);
+		/// @brief Waits for the blocks that are decompressed in the background.
+		void _waitBatch();
+		/// @return Uncompressed size of the next block, 0 at the end of the blocks.
+		int _readBlock(CompressionBlock* block, unsigned char* compressedData);
+
+	};
+
+}
+#endif
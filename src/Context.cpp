@@ -0,0 +1,372 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <string.h>
+
+#include <hltypes/harray.h>
+#include <hltypes/hexception.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hmap.h>
+#include <hltypes/hsbase.h>
+#include <hltypes/hstring.h>
+
+#include "Compression.h"
+#include "Context.h"
+#include "IdMap.h"
+#include "LazyScope.h"
+#include "MappedFile.h"
+#include "Reader.h"
+#include "Schema.h"
+#include "Writer.h"
+
+// streams are read into memory in blocks of this size
+#define LITESER_READ_BLOCK_SIZE 1048576
+// larger tables are freed after a call instead of being kept for the next one
+#define LITESER_MAX_RETAINED_IDS 65536
+
+namespace liteser
+{
+	LITESER_THREAD_LOCAL Context* _context = NULL;
+	static LITESER_THREAD_LOCAL IdMap<Serializable*>* __retainedObjectIds = NULL;
+	static LITESER_THREAD_LOCAL IdMap<hstr>* __retainedStringIds = NULL;
+
+	/// @brief Reads as much of the given size as the stream still has.
+	/// @return Number of bytes that were read.
+	static int64_t __readStream(hsbase* stream, unsigned char* data, int64_t size)
+	{
+		int64_t remaining = size;
+		int blockSize = 0;
+		int readSize = 0;
+		while (remaining > 0)
+		{
+			blockSize = (int)hmin(remaining, (int64_t)LITESER_READ_BLOCK_SIZE);
+			readSize = stream->readRaw(data, blockSize);
+			data += readSize;
+			remaining -= readSize;
+			if (readSize < blockSize)
+			{
+				break;
+			}
+		}
+		return (size - remaining);
+	}
+
+	template <typename T>
+	static inline IdMap<T>* __acquireIdMap(IdMap<T>*& retained)
+	{
+		IdMap<T>* result = retained;
+		retained = NULL;
+		return (result != NULL ? result : new IdMap<T>());
+	}
+
+	template <typename T>
+	static inline void __releaseIdMap(IdMap<T>*& retained, IdMap<T>* idMap)
+	{
+		// nested calls could have already returned their own table
+		if (retained == NULL && idMap->slotCount() <= LITESER_MAX_RETAINED_IDS * 2)
+		{
+			idMap->clear();
+			retained = idMap;
+		}
+		else
+		{
+			delete idMap;
+		}
+	}
+
+	Context::Context() :
+		stream(NULL),
+		element(0),
+		lazyCount(0),
+		outerScope(NULL),
+		referencesOnly(false),
+		buffer(NULL),
+		bufferCapacity(0),
+		origin(0),
+		data(NULL),
+		dataSize(0),
+		rangeBuffer(NULL),
+		rangeCapacity(0),
+		decompressor(NULL),
+		file(NULL),
+		lazyScope(NULL),
+		lazyDataCopied(false)
+	{
+		this->_activate();
+	}
+
+	Context::Context(hsbase* stream) :
+		stream(stream),
+		element(0),
+		lazyCount(0),
+		outerScope(NULL),
+		referencesOnly(false),
+		buffer(NULL),
+		bufferCapacity(0),
+		origin(stream->position()),
+		data(NULL),
+		dataSize(0),
+		rangeBuffer(NULL),
+		rangeCapacity(0),
+		decompressor(NULL),
+		file(NULL),
+		lazyScope(NULL),
+		lazyDataCopied(false)
+	{
+		this->_activate();
+	}
+
+	Context::Context(const unsigned char* data, int64_t size) :
+		stream(NULL),
+		reader(data, size),
+		element(0),
+		lazyCount(0),
+		outerScope(NULL),
+		referencesOnly(false),
+		buffer(NULL),
+		bufferCapacity(0),
+		origin(0),
+		data(data),
+		dataSize(size),
+		rangeBuffer(NULL),
+		rangeCapacity(0),
+		decompressor(NULL),
+		file(NULL),
+		lazyScope(NULL),
+		lazyDataCopied(false)
+	{
+		this->_activate();
+	}
+
+	Context::Context(MappedFile* file) :
+		stream(NULL),
+		reader(file->getData(), file->getSize()),
+		element(0),
+		lazyCount(0),
+		outerScope(NULL),
+		referencesOnly(false),
+		buffer(NULL),
+		bufferCapacity(0),
+		origin(0),
+		data(file->getData()),
+		dataSize(file->getSize()),
+		rangeBuffer(NULL),
+		rangeCapacity(0),
+		decompressor(NULL),
+		file(file),
+		lazyScope(NULL),
+		lazyDataCopied(false)
+	{
+		this->_activate();
+	}
+
+	Context::~Context()
+	{
+		foreach (StoredSchema*, it, this->storedSchemas)
+		{
+			delete (*it);
+		}
+		__releaseIdMap(__retainedObjectIds, this->objectIds);
+		__releaseIdMap(__retainedStringIds, this->stringIds);
+		// memory that was taken over by lazy objects is freed by them
+		LazyScope* scope = this->lazyScope;
+		if (this->buffer != NULL && (scope == NULL || scope->buffer != this->buffer))
+		{
+			delete[] this->buffer;
+		}
+		if (this->rangeBuffer != NULL)
+		{
+			delete[] this->rangeBuffer;
+		}
+		if (this->decompressor != NULL)
+		{
+			delete this->decompressor;
+		}
+		if (this->file != NULL && (scope == NULL || scope->file != this->file))
+		{
+			delete this->file;
+		}
+		foreach (LazySlot*, it, this->lazySlots)
+		{
+			if ((*it) != NULL)
+			{
+				(*it)->release();
+			}
+		}
+		if (scope != NULL)
+		{
+			// lazy objects can reference any object of the level they are in
+			scope->loadedObjects.swap(this->objects);
+			scope->objects = &scope->loadedObjects;
+			scope->release();
+		}
+		_context = this->previous;
+	}
+
+	LazyScope* Context::getLazyScope()
+	{
+		if (this->lazyScope == NULL)
+		{
+			this->lazyScope = new LazyScope(this->header, this->outerScope);
+			// the objects of the level are shared with lazy objects that are loaded before the level was loaded completely
+			this->lazyScope->objects = &this->objects;
+			// levels of lazy objects decode memory that is already kept alive by the enclosing level
+			if (this->file != NULL)
+			{
+				this->lazyScope->file = this->file;
+			}
+			else if (this->outerScope == NULL && this->data != NULL && !this->reader.hasSource())
+			{
+				this->lazyScope->buffer = new unsigned char[this->dataSize > 0 ? (size_t)this->dataSize : 1];
+				memcpy(this->lazyScope->buffer, this->data, (size_t)this->dataSize);
+				this->lazyDataCopied = true;
+			}
+		}
+		return this->lazyScope;
+	}
+
+	const unsigned char* Context::getLazyData(const unsigned char* data, int64_t size)
+	{
+		if (this->lazyDataCopied)
+		{
+			return (this->lazyScope->buffer + (data - this->data));
+		}
+		if (this->reader.hasSource())
+		{
+			unsigned char* copy = new unsigned char[size > 0 ? (size_t)size : 1];
+			memcpy(copy, data, (size_t)size);
+			this->getLazyScope()->copies += copy;
+			return copy;
+		}
+		return data;
+	}
+
+	void Context::_activate()
+	{
+		this->objectIds = __acquireIdMap(__retainedObjectIds);
+		this->stringIds = __acquireIdMap(__retainedStringIds);
+		this->indent = "\t";
+		// nested calls (e.g. from within a custom _lsSave()) get their own context
+		this->previous = _context;
+		_context = this;
+	}
+
+	void Context::beginReading()
+	{
+		if (this->stream == NULL || this->reader.hasSource())
+		{
+			return;
+		}
+		this->reader = Reader(this);
+	}
+
+	bool Context::fill(Reader& reader, int64_t count)
+	{
+		int64_t kept = reader.remaining();
+		const unsigned char* unread = reader.readInPlace(kept);
+		// the buffer only grows beyond the block size for single values that are larger and shrinks back after them
+		if (count > this->bufferCapacity || this->buffer == NULL || (this->bufferCapacity > LITESER_READ_BLOCK_SIZE && count <= LITESER_READ_BLOCK_SIZE))
+		{
+			int64_t capacity = hmax(count, (int64_t)LITESER_READ_BLOCK_SIZE);
+			unsigned char* buffer = new unsigned char[(size_t)capacity];
+			if (kept > 0)
+			{
+				memcpy(buffer, unread, (size_t)kept);
+			}
+			if (this->buffer != NULL)
+			{
+				delete[] this->buffer;
+			}
+			this->buffer = buffer;
+			this->bufferCapacity = capacity;
+		}
+		else if (kept > 0)
+		{
+			memmove(this->buffer, unread, (size_t)kept);
+		}
+		int64_t size = kept + __readStream(this->stream, this->buffer + kept, this->bufferCapacity - kept);
+		reader._reset(this->buffer, size);
+		return (size > kept);
+	}
+
+	int64_t Context::remaining()
+	{
+		return (this->stream != NULL ? hmax(this->stream->size() - this->stream->position(), (int64_t)0) : 0);
+	}
+
+	void Context::beginDecompression()
+	{
+		this->decompressor = new Decompressor(this->reader);
+		this->reader = Reader(this->decompressor);
+	}
+
+	void Context::readRange(int64_t offset, int64_t size)
+	{
+		if (offset < 0 || size < 0 || (this->data != NULL && offset + size > this->dataSize))
+		{
+			throw Exception("Unexpected end of data!");
+		}
+		if (this->data != NULL)
+		{
+			this->reader = Reader(this->data + offset, size);
+			return;
+		}
+		if (size > this->rangeCapacity)
+		{
+			if (this->rangeBuffer != NULL)
+			{
+				delete[] this->rangeBuffer;
+			}
+			this->rangeCapacity = size;
+			this->rangeBuffer = new unsigned char[(size_t)size];
+		}
+		this->stream->seek(this->origin + offset - this->stream->position());
+		this->reader = Reader(this->rangeBuffer, __readStream(this->stream, this->rangeBuffer, size));
+	}
+
+	void Context::finishReading()
+	{
+		int64_t remaining = 0;
+		if (this->decompressor != NULL)
+		{
+			this->decompressor->finish();
+			remaining = this->decompressor->input.remaining();
+		}
+		else
+		{
+			remaining = this->reader.remaining();
+		}
+		if (this->stream != NULL && this->buffer != NULL && remaining > 0)
+		{
+			this->stream->seek(-remaining);
+		}
+	}
+
+	void Context::finishReading(int64_t offset)
+	{
+		if (this->stream != NULL)
+		{
+			this->stream->seek(this->origin + offset - this->stream->position());
+		}
+	}
+
+	void Context::beginWriting()
+	{
+		this->writer.open(this->stream);
+	}
+
+	void Context::finishWriting()
+	{
+		if (this->header.compressed)
+		{
+			this->writer.endCompression();
+		}
+		this->writer.flush();
+	}
+
+}
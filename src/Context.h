@@ -0,0 +1,162 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents the state of a single serialization call.
+
+#ifndef LITESER_CONTEXT_H
+#define LITESER_CONTEXT_H
+
+#include <stdint.h>
+
+#include <hltypes/harray.h>
+#include <hltypes/hmap.h>
+#include <hltypes/hsbase.h>
+#include <hltypes/hstring.h>
+
+#include "Header.h"
+#include "IdMap.h"
+#include "LazyScope.h"
+#include "liteserExport.h"
+#include "Reader.h"
+#include "Schema.h"
+#include "Writer.h"
+
+namespace liteser
+{
+	class Decompressor;
+	class MappedFile;
+	class Serializable;
+
+	/// @brief Holds everything a serialization call works with so independent calls can run on different threads.
+	/// @note A context activates itself for the current thread on construction and restores the previously active one on destruction.
+	class Context : public ReaderSource
+	{
+	public:
+		hsbase* stream;
+		/// @brief Binary data is always decoded from memory through this, streams are read into memory in parts as it goes.
+		Reader reader;
+		/// @brief Binary data is always encoded through this.
+		Writer writer;
+		Header header;
+		/// @brief Objects and strings in order of their IDs while loading.
+		harray<Serializable*> objects;
+		/// @brief Characters of all pooled strings one after another, loaded variables are assigned directly from here.
+		harray<char> stringData;
+		/// @brief Where every pooled string starts in stringData.
+		harray<int> stringOffsets;
+		/// @brief IDs of objects and strings while saving, the tables are reused by later calls on the same thread.
+		IdMap<Serializable*>* objectIds;
+		IdMap<hstr>* stringIds;
+		hmap<Schema*, unsigned int> schemaIds;
+		harray<StoredSchema*> storedSchemas;
+		hstr indent;
+		/// @brief Schemas already used in this call, avoids locking the global schema cache for every object.
+		hmap<hstr, Schema*> schemas;
+		/// @brief Same as schemas for classes that are registered in the Factory, indexed by their class ID.
+		harray<Schema*> classSchemas;
+		/// @brief Index of the element of indexed data that is currently processed, object IDs are local to it.
+		int element;
+		/// @brief Element and local object ID of every object that was written to indexed data.
+		hmap<Serializable*, uint64_t> elementReferences;
+		/// @brief Objects of elements of indexed data that were already loaded, by element index.
+		hmap<unsigned int, harray<Serializable*> > elementObjects;
+		/// @brief Objects that were referenced from other elements of indexed data before their own element was loaded.
+		hmap<uint64_t, Serializable*> referencedObjects;
+		/// @brief Elements of indexed data that still have to be loaded to fill referenced objects.
+		harray<unsigned int> pendingElements;
+		/// @brief Object IDs of the data that encloses each lazy object that is currently written, innermost last.
+		harray<IdMap<Serializable*>*> outerObjectIds;
+		/// @brief Number of references to enclosing data that were made from within each lazy object that is currently written.
+		harray<unsigned int> outerReferenceCounts;
+		/// @brief Index of the lazy object and local ID of every object that was written within a lazy object of the current level.
+		hmap<Serializable*, uint64_t> lazyReferences;
+		/// @brief The same for the data that encloses each lazy object that is currently written, innermost last.
+		harray<hmap<Serializable*, uint64_t>*> outerLazyReferences;
+		/// @brief Number of lazy objects that were written in the current level.
+		unsigned int lazyCount;
+		/// @brief Objects that were written within lazy objects of other lazy objects, they can only be referenced from within them.
+		IdMap<Serializable*> lazyObjects;
+		/// @brief Lazy objects of the current level while loading by their index, NULL for those that were already loaded.
+		harray<LazySlot*> lazySlots;
+		/// @brief Objects of lazy objects of the current level that were loaded, by the index of the lazy object.
+		hmap<unsigned int, harray<Serializable*> > lazySlotObjects;
+		/// @brief Level of the data that encloses the lazy object that is currently loaded.
+		LazyScope* outerScope;
+		/// @brief Whether objects are only written as their IDs, used to encode the variables of every object on their own.
+		bool referencesOnly;
+		/// @brief Memory that integer arrays are encoded in while saving, it is reused by all arrays of the call.
+		harray<unsigned char> scratch;
+
+		/// @brief Creates a context that keeps everything it writes in memory.
+		Context();
+		Context(hsbase* stream);
+		/// @brief Creates a context that decodes the given memory directly.
+		Context(const unsigned char* data, int64_t size);
+		/// @brief Creates a context that decodes a mapped file directly and takes over the file.
+		Context(MappedFile* file);
+		~Context();
+
+		/// @brief Gets the level of data that lazy objects which are currently loaded belong to.
+		/// @note The memory that is decoded is taken over by the level so the lazy objects can be decoded after the call.
+		LazyScope* getLazyScope();
+		/// @brief Gets where the level of lazy objects keeps the given part of the decoded memory.
+		/// @note Memory that belongs to the caller is copied by the level, because the caller can free it after the call.
+		/// @note Data that is read in parts, i.e. from streams or compressed blocks, is copied by the level, because the memory it is read into is reused.
+		const unsigned char* getLazyData(const unsigned char* data, int64_t size);
+
+		/// @brief Lets the reader read the stream into memory in parts as it decodes it.
+		/// @note Does nothing if the context was created on memory.
+		void beginReading();
+		/// @brief Lets the reader decode the compressed blocks that follow in the data, they are decompressed as it goes.
+		void beginDecompression();
+		/// @brief Makes only a part of the data available to the reader.
+		/// @param[in] offset Offset relative to where the data starts.
+		/// @note Only this part is read if the whole stream was not read yet.
+		void readRange(int64_t offset, int64_t size);
+		/// @brief Moves the stream back to the end of the decoded data so it can be used after the call.
+		void finishReading();
+		/// @brief Moves the stream to the given offset relative to where the data starts.
+		void finishReading(int64_t offset);
+		/// @brief Starts collecting binary output for the stream.
+		void beginWriting();
+		/// @brief Writes all collected binary output to the stream.
+		void finishWriting();
+
+		bool fill(Reader& reader, int64_t count);
+		int64_t remaining();
+
+	protected:
+		Context* previous;
+		/// @brief The part of the stream that is currently decoded.
+		unsigned char* buffer;
+		int64_t bufferCapacity;
+		/// @brief Position of the stream where the data starts.
+		int64_t origin;
+		/// @brief The whole data if it is in memory.
+		const unsigned char* data;
+		int64_t dataSize;
+		unsigned char* rangeBuffer;
+		int64_t rangeCapacity;
+		/// @brief Supplies the decompressed data to the reader while it has the original data as its input.
+		Decompressor* decompressor;
+		MappedFile* file;
+		LazyScope* lazyScope;
+		/// @brief Whether the level of lazy objects has a copy of the data.
+		bool lazyDataCopied;
+
+		void _activate();
+
+	};
+
+	/// @brief The context of the serialization call currently running on this thread.
+	extern LITESER_THREAD_LOCAL Context* _context;
+
+}
+#endif
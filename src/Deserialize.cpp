@@ -7,384 +7,1457 @@
 /// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
 
 #include <stdint.h>
+#include <string.h>
 
 #include <gtypes/Rectangle.h>
 #include <gtypes/Vector2.h>
 #include <hltypes/harray.h>
 #include <hltypes/hlog.h>
+#include <hltypes/hltypesUtil.h>
 #include <hltypes/hmap.h>
 #include <hltypes/hresource.h>
 #include <hltypes/hsbase.h>
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Context.h"
 #include "Deserialize.h"
+#include "Encoding.h"
 #include "Factory.h"
+#include "Lazy.h"
+#include "LazyScope.h"
 #include "liteser.h"
+#include "Packing.h"
+#include "Schema.h"
 #include "Serializable.h"
+#include "Serialize.h"
 #include "Type.h"
+#include "TypeTable.h"
 #include "Utility.h"
-#include "Variable.h"
+
+#define LITESER_STACK_FIELDS_MAX 64
 
 namespace liteser
 {
-	inline void __loadVariableCompatible(Variable* variable, Type::Identifier loadedIdentifier)
+	/// @brief Loads a signed integer, compact data stores it zigzag encoded as a varint.
+	template <typename T>
+	inline T __loadSigned(T (Reader::*load)())
+	{
+		if (_context->header.compactIntegers)
+		{
+			return (T)_unzigzag(_context->reader.loadVarint());
+		}
+		return (_context->reader.*load)();
+	}
+
+	template <typename T>
+	inline T __loadUnsigned(T (Reader::*load)())
+	{
+		if (_context->header.compactIntegers)
+		{
+			return (T)_context->reader.loadVarint();
+		}
+		return (_context->reader.*load)();
+	}
+
+	template <typename T, typename V>
+	static void __assignTyped(void* value, T loaded)
+	{
+		*(V*)value = (V)loaded;
+	}
+
+	template <typename T>
+	static void __assignNothing(void*, T)
+	{
+	}
+
+	template <typename T>
+	class CompatibleAssigners : public DispatchTable<void (*)(void*, T)>
+	{
+	public:
+		CompatibleAssigners() : DispatchTable<void (*)(void*, T)>(&__assignNothing<T>)
+		{
+			// this is from an internal list of possible compatible types
+#define SET_ASSIGNER(name, type) this->set(Type::Identifier::name, &__assignTyped<T, type>);
+			LITESER_NUMBER_TYPES(SET_ASSIGNER)
+#undef SET_ASSIGNER
+			// packed values are kept as full values in memory
+			this->set(Type::Identifier::HalfFloat, &__assignTyped<T, float>);
+			this->set(Type::Identifier::FixedFloat, &__assignTyped<T, float>);
+			this->set(Type::Identifier::SeriesFloat, &__assignTyped<T, float>);
+			this->set(Type::Identifier::SeriesDouble, &__assignTyped<T, double>);
+		}
+
+	};
+
+	template <typename T>
+	inline void __assignCompatible(void* value, Type::Identifier identifier, T loaded)
+	{
+		const CompatibleAssigners<T>& assigners = _getTable<CompatibleAssigners<T> >();
+		assigners.get(identifier)(value, loaded);
+	}
+
+	inline void __assignCompatibleComponents(void* value, Type::Identifier identifier, double* components)
+	{
+		if (identifier == Type::Identifier::Gvec2f || identifier == Type::Identifier::HalfGvec2f || identifier == Type::Identifier::FixedGvec2f)
+		{
+			gvec2f* vector = (gvec2f*)value;
+			vector->x = (float)components[0];
+			vector->y = (float)components[1];
+		}
+		else if (identifier == Type::Identifier::Gvec2i)
+		{
+			gvec2i* vector = (gvec2i*)value;
+			vector->x = (int)components[0];
+			vector->y = (int)components[1];
+		}
+		else if (identifier == Type::Identifier::Gvec2d)
+		{
+			gvec2d* vector = (gvec2d*)value;
+			vector->x = components[0];
+			vector->y = components[1];
+		}
+		else if (identifier == Type::Identifier::Gvec3f || identifier == Type::Identifier::HalfGvec3f || identifier == Type::Identifier::FixedGvec3f)
+		{
+			gvec3f* vector = (gvec3f*)value;
+			vector->x = (float)components[0];
+			vector->y = (float)components[1];
+			vector->z = (float)components[2];
+		}
+		else if (identifier == Type::Identifier::Gvec3i)
+		{
+			gvec3i* vector = (gvec3i*)value;
+			vector->x = (int)components[0];
+			vector->y = (int)components[1];
+			vector->z = (int)components[2];
+		}
+		else if (identifier == Type::Identifier::Gvec3d)
+		{
+			gvec3d* vector = (gvec3d*)value;
+			vector->x = components[0];
+			vector->y = components[1];
+			vector->z = components[2];
+		}
+		else if (identifier == Type::Identifier::Grectf || identifier == Type::Identifier::HalfGrectf || identifier == Type::Identifier::FixedGrectf)
+		{
+			grectf* rect = (grectf*)value;
+			rect->x = (float)components[0];
+			rect->y = (float)components[1];
+			rect->w = (float)components[2];
+			rect->h = (float)components[3];
+		}
+		else if (identifier == Type::Identifier::Grecti)
+		{
+			grecti* rect = (grecti*)value;
+			rect->x = (int)components[0];
+			rect->y = (int)components[1];
+			rect->w = (int)components[2];
+			rect->h = (int)components[3];
+		}
+		else if (identifier == Type::Identifier::Grectd)
+		{
+			grectd* rect = (grectd*)value;
+			rect->x = components[0];
+			rect->y = components[1];
+			rect->w = components[2];
+			rect->h = components[3];
+		}
+	}
+
+	/// @brief Loads a lazy object right away, e.g. if the variable was changed from a lazy object to a regular one.
+	inline void __loadLazyObjectNow(Serializable** value)
+	{
+		unsigned int size = _context->reader.loadUint32();
+		if (size == 0)
+		{
+			*value = NULL;
+			return;
+		}
+		_context->reader.skip(sizeof(unsigned int)); // number of outer references
+		if (_context->header.indexed)
+		{
+			__loadObject(value);
+			return;
+		}
+		LazyScope* scope = _context->getLazyScope();
+		// lazy objects within it keep pointing into the data
+		const unsigned char* data = _context->getLazyData(_context->reader.readInPlace(size - sizeof(unsigned int)), size - sizeof(unsigned int));
+		harray<Serializable*>* objects = NULL;
+		if (_context->header.allowMultiReferencing) // objects of the lazy object can be referenced by the data after it
+		{
+			objects = &_context->lazySlotObjects[_context->lazySlots.size()];
+			_context->lazySlots += (LazySlot*)NULL;
+		}
+		_loadLazyObject(scope, data, size - sizeof(unsigned int), value, objects);
+	}
+
+	typedef void (*CompatibleLoadFunction)(void*, Type::Identifier);
+
+	template <typename T>
+	static void __loadCompatibleTyped(void* value, Type::Identifier identifier)
+	{
+		T loaded;
+		_load(&loaded);
+		__assignCompatible(value, identifier, loaded);
+	}
+
+	static void __loadCompatibleHalf(void* value, Type::Identifier identifier)
+	{
+		unsigned short packed = _context->reader.loadUint16();
+		float loaded = 0.0f;
+		_unpackFloats(&packed, &loaded, 1, 0);
+		__assignCompatible(value, identifier, loaded);
+	}
+
+	class CompatibleLoaders : public DispatchTable<CompatibleLoadFunction>
+	{
+	public:
+		CompatibleLoaders() : DispatchTable<CompatibleLoadFunction>(NULL)
+		{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadCompatibleTyped<type>);
+			LITESER_NUMBER_TYPES(SET_LOADER)
+#undef SET_LOADER
+			this->set(Type::Identifier::HalfFloat, &__loadCompatibleHalf);
+			// single samples are stored as usual
+			this->set(Type::Identifier::SeriesFloat, &__loadCompatibleTyped<float>);
+			this->set(Type::Identifier::SeriesDouble, &__loadCompatibleTyped<double>);
+		}
+
+	};
+
+	inline void __loadValueCompatible(void* value, Type::Identifier identifier, Type::Identifier loadedIdentifier, int loadedScale = 0)
 	{
+		// object variables can be changed to lazy objects and back
+		if (loadedIdentifier == Type::Identifier::Object)
+		{
+			Serializable* object = NULL;
+			__loadObject(&object);
+			((LazyBase*)value)->set(object);
+			return;
+		}
+		if (loadedIdentifier == Type::Identifier::LazyObject)
+		{
+			__loadLazyObjectNow((Serializable**)value);
+			return;
+		}
 		// these are predefined compatible types only
-		if (loadedIdentifier == Type::Identifier::Int8)			variable->setValue(stream->loadInt8());
-		else if (loadedIdentifier == Type::Identifier::UInt8)	variable->setValue(stream->loadUint8());
-		else if (loadedIdentifier == Type::Identifier::Int16)	variable->setValue(stream->loadInt16());
-		else if (loadedIdentifier == Type::Identifier::UInt16)	variable->setValue(stream->loadUint16());
-		else if (loadedIdentifier == Type::Identifier::Int32)	variable->setValue(stream->loadInt32());
-		else if (loadedIdentifier == Type::Identifier::UInt32)	variable->setValue(stream->loadUint32());
-		else if (loadedIdentifier == Type::Identifier::Int64)	variable->setValue(stream->loadInt64());
-		else if (loadedIdentifier == Type::Identifier::UInt64)	variable->setValue(stream->loadUint64());
-		else if (loadedIdentifier == Type::Identifier::Float)	variable->setValue(stream->loadFloat());
-		else if (loadedIdentifier == Type::Identifier::Double)	variable->setValue(stream->loadDouble());
-	}
-
-	inline void __loadVariable(Variable* variable, Type::Identifier loadedIdentifier)
-	{
-		if (loadedIdentifier == Type::Identifier::Int8)				*variable->value<char>()			= stream->loadInt8();
-		else if (loadedIdentifier == Type::Identifier::UInt8)		*variable->value<unsigned char>()	= stream->loadUint8();
-		else if (loadedIdentifier == Type::Identifier::Int16)		*variable->value<short>()			= stream->loadInt16();
-		else if (loadedIdentifier == Type::Identifier::UInt16)		*variable->value<unsigned short>()	= stream->loadUint16();
-		else if (loadedIdentifier == Type::Identifier::Int32)		*variable->value<int>()				= stream->loadInt32();
-		else if (loadedIdentifier == Type::Identifier::UInt32)		*variable->value<unsigned int>()	= stream->loadUint32();
-		else if (loadedIdentifier == Type::Identifier::Int64)		*variable->value<int64_t>()			= stream->loadInt64();
-		else if (loadedIdentifier == Type::Identifier::UInt64)		*variable->value<uint64_t>()		= stream->loadUint64();
-		else if (loadedIdentifier == Type::Identifier::Float)		*variable->value<float>()			= stream->loadFloat();
-		else if (loadedIdentifier == Type::Identifier::Double)		*variable->value<double>()			= stream->loadDouble();
-		else if (loadedIdentifier == Type::Identifier::Bool)		*variable->value<bool>()			= stream->loadBool();
-		else if (loadedIdentifier == Type::Identifier::Hstr)		_load(variable->value<hstr>());
-		else if (loadedIdentifier == Type::Identifier::Hversion)	_load(variable->value<hversion>());
-		else if (loadedIdentifier == Type::Identifier::Henum)		_load(variable->value<henum>());
-		else if (loadedIdentifier == Type::Identifier::Grectf)		_load(variable->value<grectf>());
-		else if (loadedIdentifier == Type::Identifier::Gvec2f)		_load(variable->value<gvec2f>());
-		else if (loadedIdentifier == Type::Identifier::Gvec3f)		_load(variable->value<gvec3f>());
-		else if (loadedIdentifier == Type::Identifier::Grecti)		_load(variable->value<grecti>());
-		else if (loadedIdentifier == Type::Identifier::Gvec2i)		_load(variable->value<gvec2i>());
-		else if (loadedIdentifier == Type::Identifier::Gvec3i)		_load(variable->value<gvec3i>());
-		else if (loadedIdentifier == Type::Identifier::Grectd)		_load(variable->value<grectd>());
-		else if (loadedIdentifier == Type::Identifier::Gvec2d)		_load(variable->value<gvec2d>());
-		else if (loadedIdentifier == Type::Identifier::Gvec3d)		_load(variable->value<gvec3d>());
-		else if (loadedIdentifier == Type::Identifier::ValueObject)	_load(variable->value<Serializable>());
-		else if (loadedIdentifier == Type::Identifier::Object)		_load(variable->value<Serializable*>());
-		else if (loadedIdentifier == Type::Identifier::Harray)		__loadContainer(variable, loadedIdentifier);
-		else if (loadedIdentifier == Type::Identifier::Hmap)		__loadContainer(variable, loadedIdentifier);
+		const CompatibleLoaders& loaders = _getTable<CompatibleLoaders>();
+		CompatibleLoadFunction loader = loaders.get(loadedIdentifier);
+		if (loader != NULL)
+		{
+			loader(value, identifier);
+		}
+		else
+		{
+			// gtypes values are converted through their components
+			double components[4] = { 0.0, 0.0, 0.0, 0.0 };
+			int count = 0;
+			if (loadedIdentifier == Type::Identifier::Gvec2f || loadedIdentifier == Type::Identifier::Gvec3f || loadedIdentifier == Type::Identifier::Grectf)
+			{
+				count = (loadedIdentifier == Type::Identifier::Gvec2f ? 2 : (loadedIdentifier == Type::Identifier::Gvec3f ? 3 : 4));
+				for_iter (i, 0, count)
+				{
+					components[i] = (double)_context->reader.loadFloat();
+				}
+			}
+			else if (loadedIdentifier == Type::Identifier::Gvec2i || loadedIdentifier == Type::Identifier::Gvec3i || loadedIdentifier == Type::Identifier::Grecti)
+			{
+				count = (loadedIdentifier == Type::Identifier::Gvec2i ? 2 : (loadedIdentifier == Type::Identifier::Gvec3i ? 3 : 4));
+				for_iter (i, 0, count)
+				{
+					components[i] = (double)__loadSigned(&Reader::loadInt32);
+				}
+			}
+			else if (loadedIdentifier == Type::Identifier::Gvec2d || loadedIdentifier == Type::Identifier::Gvec3d || loadedIdentifier == Type::Identifier::Grectd)
+			{
+				count = (loadedIdentifier == Type::Identifier::Gvec2d ? 2 : (loadedIdentifier == Type::Identifier::Gvec3d ? 3 : 4));
+				for_iter (i, 0, count)
+				{
+					components[i] = _context->reader.loadDouble();
+				}
+			}
+			else if (loadedIdentifier == Type::Identifier::HalfGvec2f || loadedIdentifier == Type::Identifier::HalfGvec3f || loadedIdentifier == Type::Identifier::HalfGrectf ||
+				_isFixedPoint(loadedIdentifier))
+			{
+				count = _getFixedSize(loadedIdentifier) / (int)sizeof(unsigned short);
+				unsigned short packed[4];
+				float values[4];
+				for_iter (i, 0, count)
+				{
+					packed[i] = _context->reader.loadUint16();
+				}
+				_unpackFloats(packed, values, count, loadedScale); // half precision floats have no scale
+				for_iter (i, 0, count)
+				{
+					components[i] = (double)values[i];
+				}
+			}
+			if (count > 0)
+			{
+				__assignCompatibleComponents(value, identifier, components);
+			}
+		}
+	}
+
+	typedef void (*LoadFunction)(void*, Type*, chstr);
+
+	template <typename T>
+	static void __loadTyped(void* value, Type*, chstr)
+	{
+		_load((T*)value);
+	}
+
+	static void __loadNothing(void*, Type*, chstr)
+	{
+	}
+
+	static void __loadPacked(void* value, Type* type, chstr name)
+	{
+		unsigned short packed[4];
+		int count = _getFixedSize(type->identifier) / (int)sizeof(unsigned short);
+		for_iter (i, 0, count)
+		{
+			packed[i] = _context->reader.loadUint16();
+		}
+		_unpackFloats(packed, (float*)value, count, type->scale);
+	}
+
+	class ValueLoaders : public DispatchTable<LoadFunction>
+	{
+	public:
+		ValueLoaders() : DispatchTable<LoadFunction>(&__loadNothing)
+		{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadTyped<type>);
+			LITESER_VALUE_TYPES(SET_LOADER)
+#undef SET_LOADER
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadPacked);
+			LITESER_PACKED_TYPES(SET_LOADER)
+#undef SET_LOADER
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadTyped<type>);
+			LITESER_SERIES_TYPES(SET_LOADER)
+#undef SET_LOADER
+			this->set(Type::Identifier::Harray, &__loadContainer);
+			this->set(Type::Identifier::Hmap, &__loadContainer);
+		}
+
+	};
+
+	inline void __loadValue(void* value, Type* type, chstr name)
+	{
+		const ValueLoaders& loaders = _getTable<ValueLoaders>();
+		loaders.get(type->identifier)(value, type, name);
+	}
+
+	inline Type::Identifier __loadContainerIdentifier(int* scale = NULL)
+	{
+		Type::Identifier identifier = _loadIdentifier(scale);
+		if (identifier == Type::Identifier::Harray || identifier == Type::Identifier::Hmap)
+		{
+			throw Exception(hsprintf("Template container within a template container detected, not supported: %02X", identifier.value));
+		}
+		return identifier;
+	}
+
+	inline void __loadRaw(void* data, int elementSize, int count)
+	{
+		// the whole block is copied out of memory at once
+		int size = elementSize * count;
+		if (_context->reader.readRaw(data, size) != size)
+		{
+			throw Exception("Unexpected end of stream while loading harray data!");
+		}
+#ifdef LITESER_BIG_ENDIAN
+		_swapBytes((unsigned char*)data, elementSize, count);
+#endif
+	}
+
+	/// @brief Decodes integers that were stored with their encoding straight into the elements of a container.
+	template <typename T>
+	inline void __loadEncoded(T* values, int count)
+	{
+		unsigned char encoding = _context->reader.loadUint8();
+		unsigned int size = _loadCount();
+		if (encoding == LITESER_ENCODING_RAW)
+		{
+			if (size != (unsigned int)count * sizeof(T))
+			{
+				throw Exception(hsprintf("Raw harray data does not match its number of elements: %u", size));
+			}
+			__loadRaw(values, sizeof(T), count);
+			return;
+		}
+		_decodeIntegers(encoding, _context->reader.readInPlace(size), (int)size, values, count);
+	}
+
+	/// @brief Elements of another type that decoded integers are converted into.
+	template <typename T>
+	class CompatibleElements
+	{
+	public:
+		unsigned char* values;
+		int elementSize;
+		void (*assign)(void*, T);
+
+		inline CompatibleElements(unsigned char* values, int elementSize, Type::Identifier identifier) :
+			values(values), elementSize(elementSize), assign(_getTable<CompatibleAssigners<T> >().get(identifier))
+		{
+		}
+
+	};
+
+	template <typename T>
+	inline void _storeDecoded(CompatibleElements<T>* elements, int index, uint64_t value)
+	{
+		elements->assign(&elements->values[index * elements->elementSize], (T)value);
+	}
+
+	/// @brief Encoded integers are converted into the elements while they are decoded.
+	inline void __loadEncodedCompatible(unsigned char* values, int elementSize, int count, Type::Identifier identifier, Type::Identifier loadedIdentifier)
+	{
+		unsigned char encoding = _context->reader.loadUint8();
+		unsigned int size = _loadCount();
+		if (encoding == LITESER_ENCODING_RAW)
+		{
+			if (size != (unsigned int)(count * _getNumberSize(loadedIdentifier)))
+			{
+				throw Exception(hsprintf("Raw harray data does not match its number of elements: %u", size));
+			}
+			for_iter (i, 0, count)
+			{
+				__loadValueCompatible(&values[i * elementSize], identifier, loadedIdentifier);
+			}
+			return;
+		}
+		const unsigned char* data = _context->reader.readInPlace(size);
+		if (loadedIdentifier == Type::Identifier::UInt64)
+		{
+			CompatibleElements<uint64_t> elements(values, elementSize, identifier);
+			_decodeIntegers(encoding, data, (int)size, &elements, count);
+		}
+		else // all other integers fit into a signed 64 bit value
+		{
+			CompatibleElements<int64_t> elements(values, elementSize, identifier);
+			_decodeIntegers(encoding, data, (int)size, &elements, count);
+		}
+	}
+
+	template <typename T>
+	inline void __loadSeries(T* values, int count)
+	{
+		unsigned int size = _loadCount();
+		_decodeSeries(_context->reader.readInPlace(size), (int)size, values, count);
+	}
+
+	/// @brief Samples can only be decoded as a whole so they are decoded before they are converted.
+	inline void __loadSeriesCompatible(unsigned char* values, int elementSize, int count, Type::Identifier identifier, Type::Identifier loadedIdentifier)
+	{
+		if (loadedIdentifier == Type::Identifier::SeriesDouble)
+		{
+			harray<double> loaded;
+			loaded.add(0.0, count);
+			__loadSeries(&loaded[0], count);
+			for_iter (i, 0, count)
+			{
+				__assignCompatible(&values[i * elementSize], identifier, loaded[i]);
+			}
+		}
+		else
+		{
+			harray<float> loaded;
+			loaded.add(0.0f, count);
+			__loadSeries(&loaded[0], count);
+			for_iter (i, 0, count)
+			{
+				__assignCompatible(&values[i * elementSize], identifier, loaded[i]);
+			}
+		}
+	}
+
+	/// @brief Loads the elements of a harray that were stored with a different but compatible type.
+	inline void __loadElementsCompatible(unsigned char* values, int elementSize, int count, Type::Identifier identifier, Type::Identifier loadedIdentifier, int loadedScale = 0)
+	{
+		if (_isEncodedArray(loadedIdentifier))
+		{
+			__loadEncodedCompatible(values, elementSize, count, identifier, loadedIdentifier);
+		}
+		else if (loadedIdentifier == Type::Identifier::SeriesFloat || loadedIdentifier == Type::Identifier::SeriesDouble)
+		{
+			__loadSeriesCompatible(values, elementSize, count, identifier, loadedIdentifier);
+		}
+		else
+		{
+			for_iter (i, 0, count)
+			{
+				__loadValueCompatible(&values[i * elementSize], identifier, loadedIdentifier, loadedScale);
+			}
+		}
+	}
+
+	/// @brief Converts packed values in blocks straight into the elements of a container.
+	inline void __loadPackedRaw(float* values, int count, int scale)
+	{
+		unsigned short block[LITESER_RAW_BLOCK_SIZE / sizeof(unsigned short)];
+		int blockCount = LITESER_RAW_BLOCK_SIZE / sizeof(unsigned short);
+		int size = 0;
+		for (int i = 0; i < count; i += size)
+		{
+			size = hmin(count - i, blockCount);
+			__loadRaw(block, sizeof(unsigned short), size);
+			_unpackFloats(block, &values[i], size, scale);
+		}
+	}
+
+	/// @brief Loads the elements of a harray after its type was read.
+	template <typename T>
+	inline void __loadHarrayElements(harray<T>* value, unsigned int size, Type::Identifier subIdentifier, Type::Identifier loadedIdentifier, int loadedScale, chstr name)
+	{
+		if (subIdentifier == loadedIdentifier)
+		{
+			_loadHarray(value, size);
+			return;
+		}
+		if (!_isCompatibleType(subIdentifier, loadedIdentifier))
+		{
+			throw Exception(hsprintf("Variable subtype of '%s' has changed. Expected: %02X, Got: %02X", name.cStr(), subIdentifier.value, loadedIdentifier.value));
+		}
+		hlog::warn(logTag, "Using compatible subtype for: " + name);
+		int offset = value->size();
+		value->add(T(), size);
+		__loadElementsCompatible((unsigned char*)&value->operator[](offset), sizeof(T), (int)size, subIdentifier, loadedIdentifier, loadedScale);
+	}
+
+	template <typename T>
+	inline void __loadHarray(harray<T>* value, Type::Identifier subIdentifier, chstr name)
+	{
+		if (_context->header.delta) // a delta replaces the containers of existing objects
+		{
+			value->clear();
+		}
+		unsigned int size = _loadCount();
+		if (size > 0)
+		{
+			int typeSize = (int)_loadCount();
+			if (typeSize != 1)
+			{
+				throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", 1, typeSize));
+			}
+			int loadedScale = 0;
+			Type::Identifier loadedIdentifier = __loadContainerIdentifier(&loadedScale);
+			if (value->size() > 0)
+			{
+				throw Exception("harray in default constructor not empty initially: " + name);
+			}
+			_skipBlockPrefix(loadedIdentifier);
+			__loadHarrayElements(value, size, subIdentifier, loadedIdentifier, loadedScale, name);
+		}
+	}
+
+	/// @brief Loads the values of an hmap straight into it, only values that have to be decoded or converted as a whole are loaded into an array first.
+	template <typename K, typename V>
+	inline void __loadHmapValues(hmap<K, V>* value, const harray<K>& keys, Type::Identifier subIdentifier, chstr name)
+	{
+		unsigned int size = _loadCount();
+		if (size != (unsigned int)keys.size())
+		{
+			throw Exception(hsprintf("Variable '%s' has container sub-variables that have different sizes: %d,%u", name.cStr(), keys.size(), size));
+		}
+		if (size == 0)
+		{
+			return;
+		}
+		int typeSize = (int)_loadCount();
+		if (typeSize != 1)
+		{
+			throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", 1, typeSize));
+		}
+		int loadedScale = 0;
+		Type::Identifier loadedIdentifier = __loadContainerIdentifier(&loadedScale);
+		_skipBlockPrefix(loadedIdentifier);
+		if (subIdentifier != loadedIdentifier || _isEncodedArray(loadedIdentifier))
+		{
+			harray<V> values;
+			__loadHarrayElements(&values, size, subIdentifier, loadedIdentifier, loadedScale, name);
+			for_itert (unsigned int, i, 0, size)
+			{
+				value->operator[](keys[i]) = values[i];
+			}
+			return;
+		}
+		// every value is read on its own, the same way as within a harray
+		harray<V> element;
+		for_itert (unsigned int, i, 0, size)
+		{
+			element.clear();
+			_loadHarray(&element, 1);
+			value->operator[](keys[i]) = element.first();
+		}
+	}
+
+	template <typename K, typename V>
+	inline void __loadHmap(hmap<K, V>* value, Type* type, chstr name)
+	{
+		if (_context->header.delta) // a delta replaces the containers of existing objects
+		{
+			value->clear();
+		}
+		unsigned int size = _loadCount();
+		if (size > 0)
+		{
+			int typeSize = (int)_loadCount();
+			if (typeSize != 2)
+			{
+				throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", 2, typeSize));
+			}
+			__loadContainerIdentifier();
+			__loadContainerIdentifier();
+			if (value->size() > 0)
+			{
+				throw Exception("hmap in default constructor not empty initially: " + name);
+			}
+			// keys and values are stored as two separate harrays, only the keys are kept until the values are read
+			harray<K> keys;
+			__loadHarray(&keys, type->subTypes[0]->identifier, name);
+			__loadHmapValues(value, keys, type->subTypes[1]->identifier, name);
+		}
+	}
+
+	static void __loadUnsupportedHarray(void*, Type* type, chstr name)
+	{
+		throw Exception(hsprintf("Subtype is not supported within harray: %s; type: %02X", name.cStr(), type->subTypes[0]->identifier.value));
+	}
+
+	static void __loadUnsupportedHmap(void*, Type* type, chstr name)
+	{
+		throw Exception(hsprintf("Subtype is not supported within hmap: %s; types: %02X %02X", name.cStr(), type->subTypes[0]->identifier.value, type->subTypes[1]->identifier.value));
+	}
+
+	template <typename T>
+	static void __loadHarrayTyped(void* value, Type* type, chstr name)
+	{
+		__loadHarray((harray<T>*)value, type->subTypes[0]->identifier, name);
+	}
+
+	/// @brief Harrays of packed values are accessed as harrays of the wrapped type since they have the same layout.
+	template <typename T>
+	static void __loadPackedHarrayTyped(void* value, Type* type, chstr name)
+	{
+		harray<T>* elements = (harray<T>*)value;
+		Type* subType = type->subTypes[0];
+		if (_context->header.delta) // a delta replaces the containers of existing objects
+		{
+			elements->clear();
+		}
+		unsigned int size = _loadCount();
+		if (size == 0)
+		{
+			return;
+		}
+		int typeSize = (int)_loadCount();
+		if (typeSize != 1)
+		{
+			throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", 1, typeSize));
+		}
+		int loadedScale = 0;
+		Type::Identifier loadedIdentifier = __loadContainerIdentifier(&loadedScale);
+		if (elements->size() > 0)
+		{
+			throw Exception("harray in default constructor not empty initially: " + name);
+		}
+		_skipBlockPrefix(loadedIdentifier);
+		elements->add(T(), size);
+		if (subType->identifier == loadedIdentifier && subType->scale == loadedScale)
+		{
+			__loadPackedRaw((float*)&elements->operator[](0), (int)size * (int)(sizeof(T) / sizeof(float)), subType->scale);
+			return;
+		}
+		if (!_isCompatibleType(subType->identifier, loadedIdentifier))
+		{
+			throw Exception(hsprintf("Variable subtype of '%s' has changed. Expected: %02X, Got: %02X", name.cStr(), subType->identifier.value, loadedIdentifier.value));
+		}
+		hlog::warn(logTag, "Using compatible subtype for: " + name);
+		__loadElementsCompatible((unsigned char*)&elements->operator[](0), sizeof(T), (int)size, subType->identifier, loadedIdentifier, loadedScale);
+	}
+
+	/// @brief Harrays of samples are accessed as harrays of the wrapped type since they have the same layout.
+	template <typename T>
+	static void __loadSeriesHarrayTyped(void* value, Type* type, chstr name)
+	{
+		harray<T>* elements = (harray<T>*)value;
+		Type::Identifier identifier = type->subTypes[0]->identifier;
+		if (_context->header.delta) // a delta replaces the containers of existing objects
+		{
+			elements->clear();
+		}
+		unsigned int size = _loadCount();
+		if (size == 0)
+		{
+			return;
+		}
+		int typeSize = (int)_loadCount();
+		if (typeSize != 1)
+		{
+			throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", 1, typeSize));
+		}
+		Type::Identifier loadedIdentifier = __loadContainerIdentifier();
+		if (elements->size() > 0)
+		{
+			throw Exception("harray in default constructor not empty initially: " + name);
+		}
+		_skipBlockPrefix(loadedIdentifier);
+		elements->add(T(), size);
+		if (identifier == loadedIdentifier)
+		{
+			__loadSeries(&elements->operator[](0), (int)size);
+			return;
+		}
+		if (!_isCompatibleType(identifier, loadedIdentifier))
+		{
+			throw Exception(hsprintf("Variable subtype of '%s' has changed. Expected: %02X, Got: %02X", name.cStr(), identifier.value, loadedIdentifier.value));
+		}
+		hlog::warn(logTag, "Using compatible subtype for: " + name);
+		__loadElementsCompatible((unsigned char*)&elements->operator[](0), sizeof(T), (int)size, identifier, loadedIdentifier);
+	}
+
+	template <typename K, typename V>
+	static void __loadHmapTyped(void* value, Type* type, chstr name)
+	{
+		__loadHmap((hmap<K, V>*)value, type, name);
+	}
+
+	class HarrayLoaders : public DispatchTable<LoadFunction>
+	{
+	public:
+		HarrayLoaders() : DispatchTable<LoadFunction>(&__loadUnsupportedHarray)
+		{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadHarrayTyped<type>);
+			LITESER_ELEMENT_TYPES(SET_LOADER)
+#undef SET_LOADER
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadPackedHarrayTyped<type>);
+			LITESER_PACKED_TYPES(SET_LOADER)
+#undef SET_LOADER
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadSeriesHarrayTyped<type>);
+			LITESER_SERIES_TYPES(SET_LOADER)
+#undef SET_LOADER
+		}
+
+	};
+
+	template <typename K>
+	class HmapLoaders : public DispatchTable<LoadFunction>
+	{
+	public:
+		HmapLoaders() : DispatchTable<LoadFunction>(&__loadUnsupportedHmap)
+		{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadHmapTyped<K, type>);
+			LITESER_ELEMENT_TYPES(SET_LOADER)
+#undef SET_LOADER
+		}
+
+	};
+
+	template <typename K>
+	static void __loadHmapKey(void* value, Type* type, chstr name)
+	{
+		const HmapLoaders<K>& loaders = _getTable<HmapLoaders<K> >();
+		loaders.get(type->subTypes[1]->identifier)(value, type, name);
+	}
+
+	class HmapKeyLoaders : public DispatchTable<LoadFunction>
+	{
+	public:
+		HmapKeyLoaders() : DispatchTable<LoadFunction>(&__loadUnsupportedHmap)
+		{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadHmapKey<type>);
+			LITESER_KEY_TYPES(SET_LOADER)
+#undef SET_LOADER
+		}
+
+	};
+
+	/// @brief Adds the next string in the data to the pool and assigns it to a variable if there is one.
+	inline void __loadPooledString(hstr* value)
+	{
+		unsigned int size = _loadCount();
+		const char* data = (const char*)_context->reader.readInPlace(size);
+		__addString(data, (int)size);
+		if (value != NULL)
+		{
+			value->assign(data, (size_t)size);
+		}
+	}
+
+	/// @brief Skips a string, only strings that are added to the pool have to be read.
+	inline void __skipString()
+	{
+		if (!_context->header.stringPooling)
+		{
+			_context->reader.skip(_loadCount());
+			return;
+		}
+		unsigned int id = _loadCount();
+		if ((int)id - 1 >= _context->stringOffsets.size())
+		{
+			if (_context->header.indexed) // all strings of indexed data are in its trailer
+			{
+				throw Exception("Invalid string ID!");
+			}
+			__loadPooledString(NULL);
+		}
+	}
+
+	/// @brief Skips a block entirely if it does not add any pooled strings or class layouts, only its object IDs are mapped.
+	/// @return False if the block has to be decoded to be skipped.
+	inline bool __trySkipBlock()
+	{
+		unsigned int size = _context->reader.loadUint32();
+		unsigned int objectCount = _context->reader.loadUint32();
+		if ((size & LITESER_BLOCK_REGISTERS) != 0)
+		{
+			return false;
+		}
+		_context->reader.skip(size);
+		for_itert (unsigned int, i, 0, objectCount)
+		{
+			__forceMapEmptyObject(); // required for proper indexing of later variables
+		}
+		return true;
+	}
+
+	/// @brief Lazy objects have their own IDs so they can always be skipped entirely.
+	inline bool __skipLazyObject()
+	{
+		unsigned int size = _context->reader.loadUint32();
+		if (size > 0 && _context->header.indexed) // objects of lazy objects in indexed data are part of their element
+		{
+			_context->reader.skip(sizeof(unsigned int));
+			return __skipObject();
+		}
+		if (size > 0 && _context->header.allowMultiReferencing) // objects of the lazy object can be referenced by the data after it
+		{
+			unsigned int outerReferences = _context->reader.loadUint32();
+			LazyScope* scope = _context->getLazyScope();
+			const unsigned char* data = _context->getLazyData(_context->reader.readInPlace(size - sizeof(unsigned int)), size - sizeof(unsigned int));
+			_context->lazySlots += new LazySlot(scope, data, size - sizeof(unsigned int), outerReferences);
+			return true;
+		}
+		_context->reader.skip(size);
+		return true;
 	}
 
 	inline bool __skipVariable(Type::Identifier loadedIdentifier)
 	{
-		if (loadedIdentifier == Type::Identifier::Int8)			{ stream->loadInt8();			return true; }
-		if (loadedIdentifier == Type::Identifier::UInt8)		{ stream->loadUint8();			return true; }
-		if (loadedIdentifier == Type::Identifier::Int16)		{ stream->loadInt16();			return true; }
-		if (loadedIdentifier == Type::Identifier::UInt16)		{ stream->loadUint16();			return true; }
-		if (loadedIdentifier == Type::Identifier::Int32)		{ stream->loadInt32();			return true; }
-		if (loadedIdentifier == Type::Identifier::UInt32)		{ stream->loadUint32();			return true; }
-		if (loadedIdentifier == Type::Identifier::Int64)		{ stream->loadInt64();			return true; }
-		if (loadedIdentifier == Type::Identifier::UInt64)		{ stream->loadUint64();			return true; }
-		if (loadedIdentifier == Type::Identifier::Float)		{ stream->loadFloat();			return true; }
-		if (loadedIdentifier == Type::Identifier::Double)		{ stream->loadDouble();			return true; }
-		if (loadedIdentifier == Type::Identifier::Bool)			{ stream->loadBool();			return true; }
-		if (loadedIdentifier == Type::Identifier::Hstr)			{ hstr var;		_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Hversion)		{ hversion var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Henum)		{ henum var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Grectf)		{ grectf var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Gvec2f)		{ gvec2f var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Gvec3f)		{ gvec3f var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Grecti)		{ grecti var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Gvec2i)		{ gvec2i var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Gvec3i)		{ gvec3i var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Grectd)		{ grectd var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Gvec2d)		{ gvec2d var;	_load(&var);	return true; }
-		if (loadedIdentifier == Type::Identifier::Gvec3d)		{ gvec3d var;	_load(&var);	return true; }
+		int size = _getFixedSize(loadedIdentifier);
+		if (size > 0)
+		{
+			_context->reader.skip(size);
+			return true;
+		}
+		int count = _getVarintCount(loadedIdentifier);
+		if (count > 0)
+		{
+			for_iter (i, 0, count)
+			{
+				_context->reader.loadVarint();
+			}
+			return true;
+		}
+		if (loadedIdentifier == Type::Identifier::Hstr)			{ __skipString(); return true; }
 		if (loadedIdentifier == Type::Identifier::ValueObject)	return __skipObject();
 		if (loadedIdentifier == Type::Identifier::Object)		return __skipObject();
+		if (loadedIdentifier == Type::Identifier::LazyObject)	return __skipLazyObject();
 		if (loadedIdentifier == Type::Identifier::Harray)		return __skipContainer(loadedIdentifier);
 		if (loadedIdentifier == Type::Identifier::Hmap)			return __skipContainer(loadedIdentifier);
 		return false;
 	}
 
-	void __loadContainer(Variable* variable, Type::Identifier identifier)
+	void __loadContainer(void* value, Type* type, chstr name)
+	{
+		if (type->identifier == Type::Identifier::Harray)
+		{
+			const HarrayLoaders& loaders = _getTable<HarrayLoaders>();
+			loaders.get(type->subTypes[0]->identifier)(value, type, name);
+		}
+		else if (type->identifier == Type::Identifier::Hmap)
+		{
+			const HmapKeyLoaders& loaders = _getTable<HmapKeyLoaders>();
+			loaders.get(type->subTypes[0]->identifier)(value, type, name);
+		}
+	}
+
+	bool __skipContainer(Type::Identifier identifier)
+	{
+		unsigned int containerSize = _loadCount();
+		if (containerSize == 0)
+		{
+			return true;
+		}
+		int subTypesSize = (identifier == Type::Identifier::Hmap ? 2 : 1);
+		int typeSize = (int)_loadCount();
+		if (typeSize != subTypesSize)
+		{
+			throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", subTypesSize, typeSize));
+		}
+		if (identifier == Type::Identifier::Hmap)
+		{
+			_loadIdentifier();
+			_loadIdentifier();
+			// keys and values are stored as two separate harrays
+			bool result = __skipContainer(Type::Identifier::Harray);
+			return (__skipContainer(Type::Identifier::Harray) && result);
+		}
+		Type::Identifier subIdentifier = _loadIdentifier();
+		if (_isEncodedArray(subIdentifier))
+		{
+			_context->reader.skip(sizeof(unsigned char)); // encoding
+			_context->reader.skip(_loadCount());
+			return true;
+		}
+		if (subIdentifier == Type::Identifier::SeriesFloat || subIdentifier == Type::Identifier::SeriesDouble)
+		{
+			_context->reader.skip(_loadCount());
+			return true;
+		}
+		int size = _getFixedSize(subIdentifier);
+		if (size > 0)
+		{
+			_context->reader.skip((int64_t)size * containerSize);
+			return true;
+		}
+		if (_hasBlockPrefix(subIdentifier) && __trySkipBlock())
+		{
+			return true;
+		}
+		bool result = true;
+		for_itert (unsigned int, i, 0, containerSize)
+		{
+			result &= __skipVariable(subIdentifier);
+		}
+		return result;
+	}
+
+	void _skipBlockPrefix(Type::Identifier identifier)
+	{
+		if (_hasBlockPrefix(identifier))
+		{
+			_context->reader.skip(LITESER_BLOCK_PREFIX_SIZE);
+		}
+	}
+
+	void _load(char* value)
+	{
+		*value = _context->reader.loadInt8();
+	}
+
+	void _load(unsigned char* value)
+	{
+		*value = _context->reader.loadUint8();
+	}
+
+	void _load(short* value)
+	{
+		*value = __loadSigned(&Reader::loadInt16);
+	}
+
+	void _load(unsigned short* value)
+	{
+		*value = __loadUnsigned(&Reader::loadUint16);
+	}
+
+	void _load(int* value)
+	{
+		*value = __loadSigned(&Reader::loadInt32);
+	}
+
+	void _load(unsigned int* value)
+	{
+		*value = __loadUnsigned(&Reader::loadUint32);
+	}
+
+	void _load(int64_t* value)
+	{
+		*value = __loadSigned(&Reader::loadInt64);
+	}
+
+	void _load(uint64_t* value)
+	{
+		*value = __loadUnsigned(&Reader::loadUint64);
+	}
+
+	void _load(float* value)
+	{
+		*value = _context->reader.loadFloat();
+	}
+
+	void _load(double* value)
+	{
+		*value = _context->reader.loadDouble();
+	}
+
+	void _load(bool* value)
+	{
+		*value = _context->reader.loadBool();
+	}
+
+	void _load(hstr* value)
+	{
+		if (!_context->header.stringPooling)
+		{
+			unsigned int size = _loadCount();
+			value->assign((const char*)_context->reader.readInPlace(size), (size_t)size);
+		}
+		else
+		{
+			unsigned int id = _loadCount();
+			if (!__tryGetString(id, value))
+			{
+				if (_context->header.indexed) // all strings of indexed data are in its trailer
+				{
+					throw Exception("Invalid string ID!");
+				}
+				__loadPooledString(value);
+			}
+		}
+	}
+
+	void _load(hversion* value)
+	{
+		value->major = __loadUnsigned(&Reader::loadUint32);
+		value->minor = __loadUnsigned(&Reader::loadUint32);
+		value->revision = __loadUnsigned(&Reader::loadUint32);
+		value->build = __loadUnsigned(&Reader::loadUint32);
+	}
+
+	void _load(henum* value)
+	{
+		value->value = __loadUnsigned(&Reader::loadUint32);
+	}
+
+	void _load(grectf* value)
+	{
+		value->x = _context->reader.loadFloat();
+		value->y = _context->reader.loadFloat();
+		value->w = _context->reader.loadFloat();
+		value->h = _context->reader.loadFloat();
+	}
+
+	void _load(gvec2f* value)
+	{
+		value->x = _context->reader.loadFloat();
+		value->y = _context->reader.loadFloat();
+	}
+
+	void _load(gvec3f* value)
+	{
+		value->x = _context->reader.loadFloat();
+		value->y = _context->reader.loadFloat();
+		value->z = _context->reader.loadFloat();
+	}
+
+	void _load(grecti* value)
+	{
+		value->x = __loadSigned(&Reader::loadInt32);
+		value->y = __loadSigned(&Reader::loadInt32);
+		value->w = __loadSigned(&Reader::loadInt32);
+		value->h = __loadSigned(&Reader::loadInt32);
+	}
+
+	void _load(gvec2i* value)
+	{
+		value->x = __loadSigned(&Reader::loadInt32);
+		value->y = __loadSigned(&Reader::loadInt32);
+	}
+
+	void _load(gvec3i* value)
+	{
+		value->x = __loadSigned(&Reader::loadInt32);
+		value->y = __loadSigned(&Reader::loadInt32);
+		value->z = __loadSigned(&Reader::loadInt32);
+	}
+
+	void _load(grectd* value)
+	{
+		value->x = _context->reader.loadDouble();
+		value->y = _context->reader.loadDouble();
+		value->w = _context->reader.loadDouble();
+		value->h = _context->reader.loadDouble();
+	}
+
+	void _load(gvec2d* value)
+	{
+		value->x = _context->reader.loadDouble();
+		value->y = _context->reader.loadDouble();
+	}
+
+	void _load(gvec3d* value)
+	{
+		value->x = _context->reader.loadDouble();
+		value->y = _context->reader.loadDouble();
+		value->z = _context->reader.loadDouble();
+	}
+
+	void _load(Serializable* value)
+	{
+		__loadObject(&value);
+	}
+
+	void _load(Serializable** value)
+	{
+		__loadObject(value);
+	}
+
+	void _load(LazyBase* value)
+	{
+		unsigned int size = _context->reader.loadUint32();
+		if (size == 0)
+		{
+			value->set(NULL);
+			return;
+		}
+		unsigned int outerReferences = _context->reader.loadUint32();
+		if (_context->header.indexed) // elements are already loaded on demand
+		{
+			Serializable* object = NULL;
+			__loadObject(&object);
+			value->set(object);
+			return;
+		}
+		LazyScope* scope = _context->getLazyScope();
+		const unsigned char* data = _context->getLazyData(_context->reader.readInPlace(size - sizeof(unsigned int)), size - sizeof(unsigned int));
+		LazySlot* slot = new LazySlot(scope, data, size - sizeof(unsigned int), outerReferences);
+		value->_setSlot(slot);
+		if (_context->header.allowMultiReferencing) // objects of the lazy object can be referenced by the data after it
+		{
+			slot->retain();
+			_context->lazySlots += slot;
+		}
+	}
+
+	void _loadLazyObject(LazyScope* scope, const unsigned char* data, int64_t size, Serializable** object, harray<Serializable*>* objects)
+	{
+		Context context(data, size);
+		_setup(NULL, scope->header);
+		context.outerScope = scope;
+		__loadObject(object);
+		if (objects != NULL)
+		{
+			*objects = context.objects;
+		}
+	}
+
+	/// @brief Objects of the data that encloses a lazy object are referenced by how many levels up they are and their ID there.
+	inline void __loadOuterReference(Serializable** value)
+	{
+		unsigned int depth = _loadCount();
+		unsigned int id = _loadCount();
+		LazyScope* scope = _context->outerScope;
+		for_itert (unsigned int, i, 1, depth)
+		{
+			scope = (scope != NULL ? scope->parent : NULL);
+		}
+		if (depth == 0 || scope == NULL || id == 0 || (int)id - 1 >= scope->objects->size())
+		{
+			throw Exception("Invalid outer reference!");
+		}
+		*value = (*scope->objects)[id - 1];
+	}
+
+	/// @brief Objects that were written within a lazy object of the same level are referenced by the index of the lazy object and their ID in it.
+	/// @note The lazy object is loaded if it was not loaded yet.
+	inline void __loadLazyReference(Serializable** value)
+	{
+		unsigned int index = _loadCount();
+		unsigned int id = _loadCount();
+		if ((int)index >= _context->lazySlots.size())
+		{
+			throw Exception("Invalid lazy reference!");
+		}
+		if (!_context->lazySlotObjects.hasKey(index))
+		{
+			LazySlot* slot = _context->lazySlots[index];
+			if (slot == NULL || slot->scope == NULL)
+			{
+				throw Exception("Invalid lazy reference!");
+			}
+			slot->load(&_context->lazySlotObjects[index]);
+		}
+		harray<Serializable*>& objects = _context->lazySlotObjects[index];
+		if (id == 0 || (int)id - 1 >= objects.size())
+		{
+			throw Exception("Invalid lazy reference!");
+		}
+		*value = objects[id - 1];
+	}
+
+	inline StoredSchema* __loadStoredSchemaLayout()
+	{
+		hstr className;
+		_load(&className);
+		StoredSchema* storedSchema = new StoredSchema(className);
+		_context->storedSchemas += storedSchema;
+		storedSchema->fingerprint = _context->reader.loadUint64();
+		unsigned int size = _loadCount();
+		hstr variableName;
+		int scale = 0;
+		for_itert (unsigned int, i, 0, size)
+		{
+			_load(&variableName);
+			storedSchema->names += variableName;
+			storedSchema->identifiers += _loadIdentifier(&scale);
+			storedSchema->scales += scale;
+		}
+		return storedSchema;
+	}
+
+	/// @brief Creates an object by the class ID that was looked up once for the stored layout.
+	inline Serializable* __createObject(StoredSchema* storedSchema)
+	{
+		if (storedSchema->classId < 0) // reports the class name
+		{
+			return Factory::create(storedSchema->className);
+		}
+		return Factory::create(storedSchema->classId);
+	}
+
+	inline StoredSchema* __loadStoredSchema()
 	{
-		variable->containerSize = stream->loadUint32();
-		if (variable->containerSize > 0)
+		StoredSchema* storedSchema = NULL;
+		unsigned int id = _loadCount();
+		if (!__tryGetStoredSchema(id, &storedSchema))
 		{
-			int typeSize = (int)stream->loadUint32();
-			if (typeSize != variable->type->subTypes.size())
+			if (_context->header.indexed) // all layouts of indexed data are in its trailer
 			{
-				throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", variable->type->subTypes.size(), typeSize));
+				throw Exception("Invalid schema ID!");
 			}
-			harray<Type::Identifier> loadedIdentifiers;
-			for_iter (i, 0, typeSize)
+			storedSchema = __loadStoredSchemaLayout();
+		}
+		return storedSchema;
+	}
+
+	inline void __loadObjectVariables(Serializable* value, StoredSchema* storedSchema)
+	{
+		Schema* schema = Schema::get(value);
+		if (storedSchema->schema != schema)
+		{
+			storedSchema->map(schema);
+		}
+		if (storedSchema->identical) // same layout as the compiled class, no checks are needed
+		{
+			// the functions generated by LS_VARS read the same data without looking up the type of every variable
+			if (schema->codec)
 			{
-				loadedIdentifiers += _loadIdentifier();
-				if (loadedIdentifiers[i] == Type::Identifier::Harray || loadedIdentifiers[i] == Type::Identifier::Hmap)
-				{
-					throw Exception(hsprintf("Template container within a template container detected, not supported: %02X", loadedIdentifiers[i].value));
-				}
+				FieldReader reader;
+				_context->reader._getCursor(&reader.current, &reader.end);
+				reader.compactIntegers = _context->header.compactIntegers;
+				value->_lsLoadVars(reader);
+				_context->reader._setCursor(reader.current);
+				return;
 			}
-			variable->createSubVariables(identifier);
-			if (loadedIdentifiers.size() > 1) // if more than one load-type, the sub-variables contain the actual data
+			foreach (Schema::Field*, it, schema->fields)
 			{
-				harray<int> sizes;
-				for_iter (i, 0, variable->subVariables.size())
-				{
-					__loadVariable(variable->subVariables[i], variable->subVariables[i]->type->identifier);
-					sizes += variable->subVariables[i]->containerSize;
-				}
-				if (sizes.size() > 1 && sizes.removedDuplicates().size() > 1)
-				{
-					throw Exception(hsprintf("Variable '%s' has container sub-variables that have different sizes: %s", variable->name.cStr(), sizes.cast<hstr>().joined(',').cStr()));
-				}
+				__loadValue((*it)->address(value), (*it)->type, (*it)->name);
 			}
-			else if (variable->subVariables.size() > 0)
+			return;
+		}
+		// variables are stored in the order of the schema table so they are matched by position
+		Schema::Field* field = NULL;
+		int index = -1;
+		int size = storedSchema->identifiers.size();
+		for_iter (i, 0, size)
+		{
+			index = storedSchema->indices[i];
+			if (index >= 0)
 			{
-				if (variable->type->subTypes[0]->identifier == loadedIdentifiers[0])
+				field = schema->fields[index];
+				if (field->type->identifier == storedSchema->identifiers[i] && field->type->scale == storedSchema->scales[i])
 				{
-					for_iter (i, 0, variable->subVariables.size())
-					{
-						__loadVariable(variable->subVariables[i], loadedIdentifiers[0]);
-					}
+					__loadValue(field->address(value), field->type, field->name);
 				}
 				else
 				{
-					if (!_isCompatibleType(variable->type->subTypes[0]->identifier, loadedIdentifiers[0]))
-					{
-						throw Exception(hsprintf("Variable subtype of '%s' has changed. Expected: %02X, Got: %02X", variable->name.cStr(), variable->type->subTypes[0]->identifier.value, loadedIdentifiers[0].value));
-					}
-					hlog::warn(logTag, "Using compatible subtype for: " + variable->subVariables[0]->name);
-					for_iter (i, 0, variable->subVariables.size())
-					{
-						__loadVariableCompatible(variable->subVariables[i], loadedIdentifiers[0]);
-					}
+					__loadValueCompatible(field->address(value), field->type->identifier, storedSchema->identifiers[i], storedSchema->scales[i]);
 				}
 			}
-			if (identifier == Type::Identifier::Hmap)
+			else
 			{
-				variable->applyHmapSubVariables(identifier);
+				__skipVariable(storedSchema->identifiers[i]);
 			}
 		}
 	}
 
-	bool __skipContainer(Type::Identifier identifier)
+	inline void __loadObjectVariablesNamed(Serializable* value, chstr className)
 	{
-		bool result = true;
-		unsigned int containerSize = stream->loadUint32();
-		if (containerSize > 0)
+		Schema* schema = Schema::get(value);
+		int fieldCount = schema->fields.size();
+		// marks which fields were loaded, kept on the stack for all but very large classes
+		unsigned char stackLoaded[LITESER_STACK_FIELDS_MAX];
+		harray<unsigned char> heapLoaded;
+		unsigned char* loaded = stackLoaded;
+		if (fieldCount > LITESER_STACK_FIELDS_MAX)
 		{
-			harray<Type::Identifier> subIdentifiers;
-			int subTypesSize = (identifier == Type::Identifier::Hmap ? 2 : 1);
-			int typeSize = (int)stream->loadUint32();
-			if (typeSize != subTypesSize)
-			{
-				throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", subTypesSize, typeSize));
-			}
-			for_iter (i, 0, typeSize)
+			heapLoaded.add(0, fieldCount);
+			loaded = &heapLoaded[0];
+		}
+		else if (fieldCount > 0)
+		{
+			memset(loaded, 0, fieldCount);
+		}
+		harray<hstr> missingVariableNames;
+		unsigned int size = _loadCount();
+		Schema::Field* field = NULL;
+		int index = -1;
+		hstr variableName;
+		Type::Identifier loadedIdentifier;
+		int loadedScale = 0;
+		for_itert (unsigned int, j, 0, size)
+		{
+			_load(&variableName);
+			field = NULL;
+			index = schema->indexOf(variableName, (int)j);
+			if (index >= 0 && loaded[index] == 0)
 			{
-				subIdentifiers += _loadIdentifier();
+				field = schema->fields[index];
+				loaded[index] = 1;
 			}
-			foreach (Type::Identifier, it, subIdentifiers)
+			loadedIdentifier = _loadIdentifier(&loadedScale);
+			if (field != NULL)
 			{
-				for_itert (unsigned int, i, 0, containerSize)
+				if (field->type->identifier == loadedIdentifier && field->type->scale == loadedScale)
+				{
+					__loadValue(field->address(value), field->type, field->name);
+				}
+				else
 				{
-					result &= __skipVariable(*it);
+					if (!_isCompatibleType(field->type->identifier, loadedIdentifier))
+					{
+						throw Exception(hsprintf("Variable type of '%s' has changed. Expected: %02X, Got: %02X", field->name.cStr(), field->type->identifier.value, loadedIdentifier.value));
+					}
+					hlog::warn(logTag, "Using compatible type for: " + field->name);
+					__loadValueCompatible(field->address(value), field->type->identifier, loadedIdentifier, loadedScale);
 				}
 			}
+			else
+			{
+				missingVariableNames += variableName;
+				__skipVariable(loadedIdentifier);
+			}
 		}
-		return result;
-	}
-
-	void _load(hstr* value)
-	{
-		if (!_currentHeader.stringPooling)
+		if (missingVariableNames.size() > 0)
 		{
-			*value = stream->loadString();
+			hlog::warn(logTag, className + " - Variables not part of class definition: " + missingVariableNames.joined(','));
 		}
-		else
+		harray<hstr> names;
+		for_iter (i, 0, fieldCount)
 		{
-			unsigned int id = stream->loadUint32();
-			if (!__tryGetString(id, value))
+			if (loaded[i] == 0)
 			{
-				*value = stream->loadString();
-				__tryMapString(&id, *value);
+				names += schema->fields[i]->name;
 			}
 		}
+		if (names.size() > 0)
+		{
+			hlog::warn(logTag, className + " - Not all variables were previously saved: " + names.joined(',').cStr());
+		}
 	}
 
-	void _load(hversion* value)
-	{
-		value->major = stream->loadUint32();
-		value->minor = stream->loadUint32();
-		value->revision = stream->loadUint32();
-		value->build = stream->loadUint32();
-	}
-
-	void _load(henum* value)
-	{
-		value->value = stream->loadUint32();
-	}
-
-	void _load(grectf* value)
-	{
-		value->x = stream->loadFloat();
-		value->y = stream->loadFloat();
-		value->w = stream->loadFloat();
-		value->h = stream->loadFloat();
-	}
-
-	void _load(gvec2f* value)
-	{
-		value->x = stream->loadFloat();
-		value->y = stream->loadFloat();
-	}
-
-	void _load(gvec3f* value)
-	{
-		value->x = stream->loadFloat();
-		value->y = stream->loadFloat();
-		value->z = stream->loadFloat();
-	}
-
-	void _load(grecti* value)
-	{
-		value->x = stream->loadInt32();
-		value->y = stream->loadInt32();
-		value->w = stream->loadInt32();
-		value->h = stream->loadInt32();
-	}
-
-	void _load(gvec2i* value)
-	{
-		value->x = stream->loadInt32();
-		value->y = stream->loadInt32();
-	}
-
-	void _load(gvec3i* value)
-	{
-		value->x = stream->loadInt32();
-		value->y = stream->loadInt32();
-		value->z = stream->loadInt32();
-	}
-
-	void _load(grectd* value)
-	{
-		value->x = stream->loadDouble();
-		value->y = stream->loadDouble();
-		value->w = stream->loadDouble();
-		value->h = stream->loadDouble();
-	}
-
-	void _load(gvec2d* value)
-	{
-		value->x = stream->loadDouble();
-		value->y = stream->loadDouble();
-	}
-
-	void _load(gvec3d* value)
-	{
-		value->x = stream->loadDouble();
-		value->y = stream->loadDouble();
-		value->z = stream->loadDouble();
-	}
-
-	void _load(Serializable* value)
+	/// @brief Objects of elements of indexed data that were not loaded yet are created right away and filled once their element is loaded.
+	inline void __loadElementReference(Serializable** value)
 	{
-		__loadObject(&value);
+		unsigned int element = _loadCount();
+		unsigned int id = _loadCount();
+		StoredSchema* storedSchema = __loadStoredSchema();
+		if (id == 0)
+		{
+			throw Exception("Invalid element reference!");
+		}
+		if (_context->elementObjects.hasKey(element))
+		{
+			harray<Serializable*>& objects = _context->elementObjects[element];
+			if ((int)id - 1 >= objects.size())
+			{
+				throw Exception("Invalid element reference!");
+			}
+			*value = objects[id - 1];
+			return;
+		}
+		uint64_t reference = __makeElementReference(element, id);
+		*value = _context->referencedObjects.tryGet(reference, NULL);
+		if (*value == NULL)
+		{
+			*value = __createObject(storedSchema);
+			_context->referencedObjects[reference] = *value;
+			_context->pendingElements += element;
+		}
 	}
 
-	void _load(Serializable** value)
+	/// @brief Gets the object that was already created for the next object ID if it was referenced from another element.
+	inline Serializable* __takeReferencedObject()
 	{
-		__loadObject(value);
+		uint64_t reference = __makeElementReference(_context->element, _context->objects.size() + 1);
+		Serializable* object = _context->referencedObjects.tryGet(reference, NULL);
+		if (object != NULL)
+		{
+			_context->referencedObjects.removeKey(reference);
+		}
+		return object;
 	}
 
 	void __loadObject(Serializable** value)
 	{
 		unsigned int id = 0;
-		if (_currentHeader.allowMultiReferencing)
+		if (_context->header.allowMultiReferencing)
+		{
+			id = _loadCount();
+		}
+		if (_context->header.indexed && id == LITESER_ELEMENT_REFERENCE)
+		{
+			__loadElementReference(value);
+			return;
+		}
+		if (id == LITESER_OUTER_REFERENCE && _context->outerScope != NULL)
+		{
+			__loadOuterReference(value);
+			return;
+		}
+		if (id == LITESER_LAZY_REFERENCE && _context->lazySlots.size() > 0)
 		{
-			id = stream->loadUint32();
+			__loadLazyReference(value);
+			return;
 		}
-		if (!_currentHeader.allowMultiReferencing || !__tryGetObject(id, value))
+		if (!_context->header.allowMultiReferencing || !__tryGetObject(id, value))
 		{
+			StoredSchema* storedSchema = NULL;
 			hstr className;
-			_load(&className);
-			if (*value == NULL)
+			if (_hasSchemaTable())
 			{
-				*value = Factory::create(className);
+				storedSchema = __loadStoredSchema();
 			}
-			if (_currentHeader.allowMultiReferencing)
+			else
 			{
-				__tryMapObject(&id, *value);
+				_load(&className);
 			}
-			harray<Variable*> variables = (*value)->_lsVars();
-			harray<hstr> missingVariableNames;
-			unsigned int size = stream->loadUint32();
-			Variable* variable = NULL;
-			hstr variableName;
-			Type::Identifier loadedIdentifier;
-			int variableIndex = -1;
-			while (size > 0 && variables.size() > 0)
+			if (*value == NULL && _context->header.indexed)
 			{
-				_load(&variableName);
-				variable = NULL;
-				variableIndex = -1;
-				for_iter (i, 0, variables.size())
-				{
-					if (variables[i]->name == variableName)
-					{
-						variable = variables[i];
-						variableIndex = i;
-						break;
-					}
-				}
-				loadedIdentifier = _loadIdentifier();
-				if (variable != NULL)
-				{
-					if (variable->type->identifier == loadedIdentifier)
-					{
-						__loadVariable(variable, loadedIdentifier);
-					}
-					else
-					{
-						if (!_isCompatibleType(variable->type->identifier, loadedIdentifier))
-						{
-							throw Exception(hsprintf("Variable type of '%s' has changed. Expected: %02X, Got: %02X", variable->name.cStr(), variable->type->identifier.value, loadedIdentifier.value));
-						}
-						hlog::warn(logTag, "Using compatible type for: " + variable->name);
-						__loadVariableCompatible(variable, loadedIdentifier);
-					}
-					delete variables.removeAt(variableIndex);
-				}
-				else
-				{
-					missingVariableNames += variableName;
-					__skipVariable(loadedIdentifier);
-				}
-				--size;
+				*value = __takeReferencedObject();
 			}
-			while (size > 0)
+			if (*value == NULL)
 			{
-				_load(&variableName);
-				loadedIdentifier = _loadIdentifier();
-				missingVariableNames += variableName;
-				__skipVariable(loadedIdentifier);
-				--size;
+				*value = (storedSchema != NULL ? __createObject(storedSchema) : Factory::create(className));
 			}
-			if (missingVariableNames.size() > 0)
+			if (_context->header.allowMultiReferencing)
 			{
-				hlog::warn(logTag, className + " - Variables not part of class definition: " + missingVariableNames.joined(','));
+				__addObject(*value);
 			}
-			if (variables.size() > 0)
+			if (_context->header.lengthPrefixed) // the size is only needed to skip objects
 			{
-				harray<hstr> names;
-				foreach (Variable*, it, variables)
-				{
-					names += (*it)->name;
-					delete (*it);
-				}
-				hlog::warn(logTag, className + " - Not all variables were previously saved: " + names.joined(',').cStr());
+				_context->reader.skip(LITESER_BLOCK_PREFIX_SIZE);
+			}
+			if (storedSchema != NULL)
+			{
+				__loadObjectVariables(*value, storedSchema);
+			}
+			else
+			{
+				__loadObjectVariablesNamed(*value, className);
 			}
 		}
 		else if (id == 0)
@@ -397,24 +1470,65 @@ namespace liteser
 	{
 		Serializable* dummy = NULL;
 		unsigned int id = 0;
-		if (_currentHeader.allowMultiReferencing)
+		if (_context->header.allowMultiReferencing)
 		{
-			id = stream->loadUint32();
+			id = _loadCount();
 		}
-		if (!_currentHeader.allowMultiReferencing || !__tryGetObject(id, &dummy))
+		if (_context->header.indexed && id == LITESER_ELEMENT_REFERENCE)
 		{
-			hstr className;
-			_load(&className);
-			if (_currentHeader.allowMultiReferencing)
+			// element, object ID and schema ID
+			_loadCount();
+			_loadCount();
+			_loadCount();
+			return true;
+		}
+		if (id == LITESER_OUTER_REFERENCE && _context->outerScope != NULL)
+		{
+			// depth and object ID
+			_loadCount();
+			_loadCount();
+			return true;
+		}
+		if (id == LITESER_LAZY_REFERENCE && _context->lazySlots.size() > 0)
+		{
+			// index of the lazy object and object ID
+			_loadCount();
+			_loadCount();
+			return true;
+		}
+		if (!_context->header.allowMultiReferencing || !__tryGetObject(id, &dummy))
+		{
+			if (_hasSchemaTable())
 			{
-				__forceMapEmptyObject(); // required for proper indexing of later variables
+				StoredSchema* storedSchema = __loadStoredSchema();
+				if (_context->header.allowMultiReferencing)
+				{
+					__forceMapEmptyObject(); // required for proper indexing of later variables
+				}
+				if (_context->header.lengthPrefixed && __trySkipBlock())
+				{
+					return true;
+				}
+				foreach (Type::Identifier, it, storedSchema->identifiers)
+				{
+					__skipVariable(*it);
+				}
 			}
-			unsigned int size = stream->loadUint32();
-			hstr variableName;
-			for_itert (unsigned int, i, 0, size)
+			else
 			{
-				_load(&variableName);
-				__skipVariable(_loadIdentifier());
+				hstr className;
+				_load(&className);
+				if (_context->header.allowMultiReferencing)
+				{
+					__forceMapEmptyObject(); // required for proper indexing of later variables
+				}
+				unsigned int size = _loadCount();
+				hstr variableName;
+				for_itert (unsigned int, i, 0, size)
+				{
+					_load(&variableName);
+					__skipVariable(_loadIdentifier());
+				}
 			}
 		}
 		return true;
@@ -431,12 +1545,239 @@ namespace liteser
 		}
 	}
 
-#define DEFINE_LOAD_HARRAY(type, loadType) \
+	inline void __loadElement(unsigned int index, Serializable** object)
+	{
+		_context->element = (int)index;
+		_context->objects.clear();
+		__loadObject(object);
+		_context->elementObjects[index] = _context->objects;
+		_context->objects.clear();
+	}
+
+	int64_t _loadIndexedElements(harray<Serializable*>* value, int start, int count)
+	{
+		if (_loadIdentifier() != Type::Identifier::Harray)
+		{
+			throw Exception("Cannot load object from file that does not contain a harray<Serializable*>!");
+		}
+		int size = (int)_context->reader.loadUint32();
+		int64_t trailer = (int64_t)_context->reader.loadUint64();
+		int64_t end = (int64_t)_context->reader.loadUint64();
+		if (count < 0)
+		{
+			count = size - start;
+		}
+		if (start < 0 || count < 0 || start + count > size)
+		{
+			throw Exception(hsprintf("Element range is out of bounds: %d, %d", start, count));
+		}
+		// the trailer has the strings, class layouts and offsets that are shared by all elements
+		_context->readRange(trailer, end - trailer);
+		unsigned int stringCount = _context->reader.loadUint32();
+		for_itert (unsigned int, i, 0, stringCount)
+		{
+			__loadPooledString(NULL);
+		}
+		unsigned int schemaCount = _context->reader.loadUint32();
+		for_itert (unsigned int, i, 0, schemaCount)
+		{
+			__loadStoredSchemaLayout();
+		}
+		harray<int64_t> offsets;
+		for_iter (i, 0, size + 1)
+		{
+			offsets += (int64_t)_context->reader.loadUint64();
+		}
+		Serializable* object = NULL;
+		if (count > 0)
+		{
+			_context->readRange(offsets[start], offsets[start + count] - offsets[start]);
+			for_iter (i, start, start + count)
+			{
+				object = NULL;
+				__loadElement(i, &object);
+				value->add(object);
+			}
+		}
+		// elements with objects that are referenced by the loaded ones are loaded as well so those objects get filled,
+		// they are added after the requested ones so the caller owns all objects that were created
+		unsigned int element = 0;
+		while (_context->pendingElements.size() > 0)
+		{
+			element = _context->pendingElements.removeLast();
+			if (!_context->elementObjects.hasKey(element))
+			{
+				if ((int)element >= size)
+				{
+					throw Exception("Invalid element reference!");
+				}
+				_context->readRange(offsets[element], offsets[element + 1] - offsets[element]);
+				object = NULL;
+				__loadElement(element, &object);
+				value->add(object);
+			}
+		}
+		if (_context->referencedObjects.size() > 0)
+		{
+			throw Exception("Invalid element reference!");
+		}
+		return end;
+	}
+
+	/// @brief Loads one variable of all objects, numbers are copied into the objects in blocks.
+	inline void __loadColumn(harray<Serializable*>* objects, Schema::Field* field)
+	{
+		int size = objects->size();
+		int elementSize = (_getVarintCount(field->type->identifier) == 0 ? _getNumberSize(field->type->identifier) : 0);
+		if (elementSize == 0)
+		{
+			for_iter (i, 0, size)
+			{
+				__loadValue(field->address(objects->operator[](i)), field->type, field->name);
+			}
+			return;
+		}
+		unsigned char block[LITESER_RAW_BLOCK_SIZE];
+		int blockCount = LITESER_RAW_BLOCK_SIZE / elementSize;
+		int count = 0;
+		for (int i = 0; i < size; i += count)
+		{
+			count = hmin(size - i, blockCount);
+			__loadRaw(block, elementSize, count);
+			for_iter (j, 0, count)
+			{
+				memcpy(field->address(objects->operator[](i + j)), &block[j * elementSize], elementSize);
+			}
+		}
+	}
+
+	void _loadColumnarHarray(harray<Serializable*>* value)
+	{
+		if (_loadIdentifier() != Type::Identifier::Harray)
+		{
+			throw Exception("Cannot load object from file that does not contain a harray<Serializable*>!");
+		}
+		unsigned int size = _context->reader.loadUint32();
+		if (size == 0)
+		{
+			return;
+		}
+		StoredSchema* storedSchema = __loadStoredSchema();
+		// all objects are created first so variables can reference any of them
+		harray<Serializable*> objects;
+		Serializable* object = NULL;
+		for_itert (unsigned int, i, 0, size)
+		{
+			object = __createObject(storedSchema);
+			__addObject(object);
+			objects += object;
+		}
+		Schema* schema = Schema::get(objects.first());
+		if (storedSchema->schema != schema)
+		{
+			storedSchema->map(schema);
+		}
+		Schema::Field* field = NULL;
+		int index = -1;
+		int count = storedSchema->identifiers.size();
+		for_iter (i, 0, count)
+		{
+			index = storedSchema->indices[i];
+			if (index < 0)
+			{
+				for_itert (unsigned int, j, 0, size)
+				{
+					__skipVariable(storedSchema->identifiers[i]);
+				}
+				continue;
+			}
+			field = schema->fields[index];
+			if (field->type->identifier == storedSchema->identifiers[i] && field->type->scale == storedSchema->scales[i])
+			{
+				__loadColumn(&objects, field);
+				continue;
+			}
+			foreach (Serializable*, it, objects)
+			{
+				__loadValueCompatible(field->address(*it), field->type->identifier, storedSchema->identifiers[i], storedSchema->scales[i]);
+			}
+		}
+		value->add(objects);
+	}
+
+	void _loadDelta(Serializable* value)
+	{
+		// the objects keep the IDs they had when the snapshot was taken, new objects get IDs after them
+		harray<Serializable*> objects;
+		_dumpSnapshotObjects(value, &objects);
+		int count = (int)_context->reader.loadUint32();
+		if (count != objects.size())
+		{
+			throw Exception("Delta was not written against the current state of the object!");
+		}
+		_context->objects = objects;
+		Serializable* object = NULL;
+		Schema* schema = NULL;
+		Schema::Field* field = NULL;
+		unsigned int fieldCount = 0;
+		unsigned int index = 0;
+		int scale = 0;
+		unsigned int id = _context->reader.loadUint32();
+		while (id != 0)
+		{
+			if (id > (unsigned int)count)
+			{
+				throw Exception(hsprintf("Invalid object ID in delta: %u", id));
+			}
+			object = objects[id - 1];
+			schema = Schema::get(object);
+			fieldCount = _context->reader.loadUint32();
+			for_itert (unsigned int, i, 0, fieldCount)
+			{
+				index = _context->reader.loadUint32();
+				if (index >= (unsigned int)schema->fields.size() || _loadIdentifier(&scale) != schema->fields[index]->type->identifier ||
+					scale != schema->fields[index]->type->scale)
+				{
+					throw Exception(hsprintf("Variable %u of class '%s' does not match the delta!", index, schema->className.cStr()));
+				}
+				field = schema->fields[index];
+				// the pointer is replaced, loading into the old object would change it for everything else that references it
+				if (field->type->identifier == Type::Identifier::Object)
+				{
+					*(Serializable**)field->address(object) = NULL;
+				}
+				__loadValue(field->address(object), field->type, field->name);
+			}
+			id = _context->reader.loadUint32();
+		}
+	}
+
+#define DEFINE_LOAD_HARRAY(type) \
 	void _loadHarray(harray<type>* value, unsigned int size) \
 	{ \
-		for_itert (unsigned int, i, 0, size) \
+		if (size > 0) \
+		{ \
+			int offset = value->size(); \
+			value->add((type)0, (int)size); \
+			__loadRaw(&value->operator[](offset), sizeof(type), (int)size); \
+		} \
+	}
+
+#define DEFINE_LOAD_HARRAY_INTEGER(type) \
+	void _loadHarray(harray<type>* value, unsigned int size) \
+	{ \
+		if (size > 0) \
 		{ \
-			value->add(stream->load ## loadType()); \
+			int offset = value->size(); \
+			value->add((type)0, (int)size); \
+			if (_context->header.encodedArrays) \
+			{ \
+				__loadEncoded(&value->operator[](offset), (int)size); \
+			} \
+			else \
+			{ \
+				__loadRaw(&value->operator[](offset), sizeof(type), (int)size); \
+			} \
 		} \
 	}
 
@@ -451,16 +1792,42 @@ namespace liteser
 		} \
 	}
 
-	DEFINE_LOAD_HARRAY(char, Int8);
-	DEFINE_LOAD_HARRAY(unsigned char, Uint8);
-	DEFINE_LOAD_HARRAY(short, Int16);
-	DEFINE_LOAD_HARRAY(unsigned short, Uint16);
-	DEFINE_LOAD_HARRAY(int, Int32);
-	DEFINE_LOAD_HARRAY(unsigned int, Uint32);
-	DEFINE_LOAD_HARRAY(int64_t, Int64);
-	DEFINE_LOAD_HARRAY(uint64_t, Uint64);
-	DEFINE_LOAD_HARRAY(float, Float);
-	DEFINE_LOAD_HARRAY(double, Double);
+// compact data stores every element as a varint unless the array is encoded
+#define DEFINE_LOAD_HARRAY_VARINT(type) \
+	void _loadHarray(harray<type>* value, unsigned int size) \
+	{ \
+		if (size > 0) \
+		{ \
+			int offset = value->size(); \
+			value->add((type)0, (int)size); \
+			if (_context->header.encodedArrays) \
+			{ \
+				__loadEncoded(&value->operator[](offset), (int)size); \
+			} \
+			else if (_context->header.compactIntegers) \
+			{ \
+				for_itert (unsigned int, i, 0, size) \
+				{ \
+					_load(&value->operator[](offset + (int)i)); \
+				} \
+			} \
+			else \
+			{ \
+				__loadRaw(&value->operator[](offset), sizeof(type), (int)size); \
+			} \
+		} \
+	}
+
+	DEFINE_LOAD_HARRAY_INTEGER(char);
+	DEFINE_LOAD_HARRAY_INTEGER(unsigned char);
+	DEFINE_LOAD_HARRAY_VARINT(short);
+	DEFINE_LOAD_HARRAY_VARINT(unsigned short);
+	DEFINE_LOAD_HARRAY_VARINT(int);
+	DEFINE_LOAD_HARRAY_VARINT(unsigned int);
+	DEFINE_LOAD_HARRAY_VARINT(int64_t);
+	DEFINE_LOAD_HARRAY_VARINT(uint64_t);
+	DEFINE_LOAD_HARRAY(float);
+	DEFINE_LOAD_HARRAY(double);
 	DEFINE_LOAD_HARRAY_F(hstr);
 	DEFINE_LOAD_HARRAY_F(hversion);
 	DEFINE_LOAD_HARRAY_F(henum);
@@ -474,4 +1841,45 @@ namespace liteser
 	DEFINE_LOAD_HARRAY_F(gvec2d);
 	DEFINE_LOAD_HARRAY_F(gvec3d);
 
+	// values of generated codecs are read at the position the codec has reached
+#define DEFINE_LOAD_FIELD_VALUE(identifier, type) \
+	void _loadFieldValue(FieldReader& reader, type* value) \
+	{ \
+		_context->reader._setCursor(reader.current); \
+		_load(value); \
+		_context->reader._getCursor(&reader.current, &reader.end); \
+	}
+#define DEFINE_LOAD_FIELD(identifier, type) \
+	void _loadField(FieldReader& reader, type* value, const char* name) \
+	{ \
+		_context->reader._setCursor(reader.current); \
+		_load(value); \
+		_context->reader._getCursor(&reader.current, &reader.end); \
+	}
+
+	LITESER_NUMBER_TYPES(DEFINE_LOAD_FIELD_VALUE);
+	DEFINE_LOAD_FIELD_VALUE(Bool, bool);
+	DEFINE_LOAD_FIELD(Hstr, hstr);
+	DEFINE_LOAD_FIELD(Hversion, hversion);
+	DEFINE_LOAD_FIELD(Henum, henum);
+	DEFINE_LOAD_FIELD(Grectf, grectf);
+	DEFINE_LOAD_FIELD(Gvec2f, gvec2f);
+	DEFINE_LOAD_FIELD(Gvec3f, gvec3f);
+	DEFINE_LOAD_FIELD(Grecti, grecti);
+	DEFINE_LOAD_FIELD(Gvec2i, gvec2i);
+	DEFINE_LOAD_FIELD(Gvec3i, gvec3i);
+	DEFINE_LOAD_FIELD(Grectd, grectd);
+	DEFINE_LOAD_FIELD(Gvec2d, gvec2d);
+	DEFINE_LOAD_FIELD(Gvec3d, gvec3d);
+	DEFINE_LOAD_FIELD(ValueObject, Serializable);
+	DEFINE_LOAD_FIELD(Object, Serializable*);
+	DEFINE_LOAD_FIELD(LazyObject, LazyBase);
+
+	void _loadField(FieldReader& reader, void* value, Type* type, const char* name)
+	{
+		_context->reader._setCursor(reader.current);
+		__loadValue(value, type, name);
+		_context->reader._getCursor(&reader.current, &reader.end);
+	}
+
 }
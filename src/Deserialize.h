@@ -29,14 +29,28 @@
 
 namespace liteser
 {
+	class LazyBase;
+	class LazyScope;
 	class Serializable;
-	class Variable;
 
-	Type::Identifier _loadIdentifier();
+	Type::Identifier _loadIdentifier(int* scale);
 
-	void __loadContainer(Variable* variable, Type::Identifier loadedIdentifier);
+	void __loadContainer(void* value, Type* type, chstr name);
 	bool __skipContainer(Type::Identifier loadedIdentifier);
+	/// @brief Skips the prefix of a container block if there is one, it is only needed to skip the whole container.
+	void _skipBlockPrefix(Type::Identifier identifier);
 
+	void _load(char* value);
+	void _load(unsigned char* value);
+	void _load(short* value);
+	void _load(unsigned short* value);
+	void _load(int* value);
+	void _load(unsigned int* value);
+	void _load(int64_t* value);
+	void _load(uint64_t* value);
+	void _load(float* value);
+	void _load(double* value);
+	void _load(bool* value);
 	void _load(hstr* value);
 	void _load(hversion* value);
 	void _load(henum* value);
@@ -51,8 +65,13 @@ namespace liteser
 	void _load(gvec3d* value);
 	void _load(Serializable* value);
 	void _load(Serializable** value);
+	void _load(LazyBase* value);
 	void __loadObject(Serializable** value);
 	bool __skipObject();
+	/// @brief Decodes the object of a lazy object with its own IDs.
+	/// @param[in] scope Level of data the lazy object belongs to.
+	/// @param[out] objects Gets all objects of the lazy object in order of their IDs if not NULL.
+	void _loadLazyObject(LazyScope* scope, const unsigned char* data, int64_t size, Serializable** object, harray<Serializable*>* objects = NULL);
 
 	void _loadHarray(harray<char>* value, unsigned int size);
 	void _loadHarray(harray<unsigned char>* value, unsigned int size);
@@ -77,6 +96,13 @@ namespace liteser
 	void _loadHarray(harray<gvec2d>* value, unsigned int size);
 	void _loadHarray(harray<gvec3d>* value, unsigned int size);
 	void _loadHarray(harray<Serializable*>* value, unsigned int size);
+	/// @brief Loads a range of elements of indexed data, a negative count loads all elements from the start.
+	/// @return Offset of the end of the indexed data.
+	int64_t _loadIndexedElements(harray<Serializable*>* value, int start, int count);
+	/// @brief Loads an object array that was written column by column.
+	void _loadColumnarHarray(harray<Serializable*>* value);
+	/// @brief Applies the changed variables of a delta to the objects of a graph.
+	void _loadDelta(Serializable* value);
 
 }
 #endif
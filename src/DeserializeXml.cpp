@@ -18,11 +18,14 @@
 #include <hltypes/hversion.h>
 #include <hlxml/Node.h>
 
+#include "Context.h"
 #include "DeserializeXml.h"
 #include "Factory.h"
+#include "Lazy.h"
 #include "liteser.h"
 #include "Serializable.h"
 #include "Type.h"
+#include "TypeTable.h"
 #include "Utility.h"
 #include "Variable.h"
 
@@ -35,123 +38,308 @@ namespace liteser
 {
 	namespace xml
 	{
-		inline void __loadVariableCompatible(hlxml::Node* node, Variable* variable, Type::Identifier loadedIdentifier)
-		{
-			// these are predefined compatible types only
-			if (loadedIdentifier == Type::Identifier::Int8)			variable->setValue(node->pint8(VALUE));
-			else if (loadedIdentifier == Type::Identifier::UInt8)	variable->setValue(node->puint8(VALUE));
-			else if (loadedIdentifier == Type::Identifier::Int16)	variable->setValue(node->pint16(VALUE));
-			else if (loadedIdentifier == Type::Identifier::UInt16)	variable->setValue(node->puint16(VALUE));
-			else if (loadedIdentifier == Type::Identifier::Int32)	variable->setValue(node->pint32(VALUE));
-			else if (loadedIdentifier == Type::Identifier::UInt32)	variable->setValue(node->puint32(VALUE));
-			else if (loadedIdentifier == Type::Identifier::Int64)	variable->setValue(node->pint64(VALUE));
-			else if (loadedIdentifier == Type::Identifier::UInt64)	variable->setValue(node->puint64(VALUE));
-			else if (loadedIdentifier == Type::Identifier::Float)	variable->setValue(node->pfloat(VALUE));
-			else if (loadedIdentifier == Type::Identifier::Double)	variable->setValue(node->pdouble(VALUE));
-		}
-
-		inline void __loadVariable(hlxml::Node* node, Variable* variable, Type::Identifier loadedIdentifier)
-		{
-			if (loadedIdentifier == Type::Identifier::Int8)				*variable->value<char>()			= node->pint8(VALUE);
-			else if (loadedIdentifier == Type::Identifier::UInt8)		*variable->value<unsigned char>()	= node->puint8(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Int16)		*variable->value<short>()			= node->pint16(VALUE);
-			else if (loadedIdentifier == Type::Identifier::UInt16)		*variable->value<unsigned short>()	= node->puint16(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Int32)		*variable->value<int>()				= node->pint32(VALUE);
-			else if (loadedIdentifier == Type::Identifier::UInt32)		*variable->value<unsigned int>()	= node->puint32(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Int64)		*variable->value<int64_t>()			= node->pint64(VALUE);
-			else if (loadedIdentifier == Type::Identifier::UInt64)		*variable->value<uint64_t>()		= node->puint64(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Float)		*variable->value<float>()			= node->pfloat(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Double)		*variable->value<double>()			= node->pdouble(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Bool)		*variable->value<bool>()			= node->pbool(VALUE);
-			else if (loadedIdentifier == Type::Identifier::Hstr)		_load(node, variable->value<hstr>());
-			else if (loadedIdentifier == Type::Identifier::Hversion)	_load(node, variable->value<hversion>());
-			else if (loadedIdentifier == Type::Identifier::Henum)		_load(node, variable->value<henum>());
-			else if (loadedIdentifier == Type::Identifier::Grectf)		_load(node, variable->value<grectf>());
-			else if (loadedIdentifier == Type::Identifier::Gvec2f)		_load(node, variable->value<gvec2f>());
-			else if (loadedIdentifier == Type::Identifier::Gvec3f)		_load(node, variable->value<gvec3f>());
-			else if (loadedIdentifier == Type::Identifier::Grecti)		_load(node, variable->value<grecti>());
-			else if (loadedIdentifier == Type::Identifier::Gvec2i)		_load(node, variable->value<gvec2i>());
-			else if (loadedIdentifier == Type::Identifier::Gvec3i)		_load(node, variable->value<gvec3i>());
-			else if (loadedIdentifier == Type::Identifier::Grectd)		_load(node, variable->value<grectd>());
-			else if (loadedIdentifier == Type::Identifier::Gvec2d)		_load(node, variable->value<gvec2d>());
-			else if (loadedIdentifier == Type::Identifier::Gvec3d)		_load(node, variable->value<gvec3d>());
-			else if (loadedIdentifier == Type::Identifier::ValueObject)	_load(node, variable->value<Serializable>());
-			else if (loadedIdentifier == Type::Identifier::Object)		_load(node, variable->value<Serializable*>());
-			else if (loadedIdentifier == Type::Identifier::Harray)		__loadContainer(node, variable, loadedIdentifier);
-			else if (loadedIdentifier == Type::Identifier::Hmap)		__loadContainer(node, variable, loadedIdentifier);
+		template <typename T, typename V>
+		static void __assignTyped(void* value, T loaded)
+		{
+			*(V*)value = (V)loaded;
+		}
+
+		template <typename T>
+		static void __assignNothing(void*, T)
+		{
+		}
+
+		template <typename T>
+		class CompatibleAssigners : public DispatchTable<void (*)(void*, T)>
+		{
+		public:
+			CompatibleAssigners() : DispatchTable<void (*)(void*, T)>(&__assignNothing<T>)
+			{
+				// this is from an internal list of possible compatible types
+#define SET_ASSIGNER(name, type) this->set(Type::Identifier::name, &__assignTyped<T, type>);
+				LITESER_NUMBER_TYPES(SET_ASSIGNER)
+				LITESER_SERIES_TYPES(SET_ASSIGNER)
+#undef SET_ASSIGNER
+				// packed values are kept as full values in memory
+				this->set(Type::Identifier::HalfFloat, &__assignTyped<T, float>);
+				this->set(Type::Identifier::FixedFloat, &__assignTyped<T, float>);
+			}
+
+		};
+
+		typedef void (*CompatibleLoadFunction)(hlxml::Node*, void*, Type::Identifier);
+
+		template <typename T>
+		static void __loadCompatibleTyped(hlxml::Node* node, void* value, Type::Identifier identifier)
+		{
+			T loaded = T();
+			_load(node, &loaded);
+			const CompatibleAssigners<T>& assigners = _getTable<CompatibleAssigners<T> >();
+			assigners.get(identifier)(value, loaded);
+		}
+
+		static void __loadCompatibleNothing(hlxml::Node*, void*, Type::Identifier)
+		{
+		}
+
+		class CompatibleLoaders : public DispatchTable<CompatibleLoadFunction>
+		{
+		public:
+			CompatibleLoaders() : DispatchTable<CompatibleLoadFunction>(&__loadCompatibleNothing)
+			{
+				// these are predefined compatible types only
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadCompatibleTyped<type>);
+				LITESER_NUMBER_TYPES(SET_LOADER)
+				LITESER_SERIES_TYPES(SET_LOADER)
+#undef SET_LOADER
+				this->set(Type::Identifier::HalfFloat, &__loadCompatibleTyped<float>);
+				this->set(Type::Identifier::FixedFloat, &__loadCompatibleTyped<float>);
+			}
+
+		};
+
+		inline void __loadValueCompatible(hlxml::Node* node, void* value, Type::Identifier identifier, Type::Identifier loadedIdentifier)
+		{
+			// lazy objects are written the same way as objects
+			if (identifier == Type::Identifier::Object)
+			{
+				_load(node, (Serializable**)value);
+				return;
+			}
+			if (identifier == Type::Identifier::LazyObject)
+			{
+				_load(node, (LazyBase*)value);
+				return;
+			}
+			const CompatibleLoaders& loaders = _getTable<CompatibleLoaders>();
+			loaders.get(loadedIdentifier)(node, value, identifier);
+		}
+
+		typedef void (*LoadFunction)(hlxml::Node*, void*, Type*, chstr);
+
+		template <typename T>
+		static void __loadTyped(hlxml::Node* node, void* value, Type*, chstr)
+		{
+			_load(node, (T*)value);
+		}
+
+		static void __loadNothing(hlxml::Node*, void*, Type*, chstr)
+		{
+		}
+
+		class ValueLoaders : public DispatchTable<LoadFunction>
+		{
+		public:
+			ValueLoaders() : DispatchTable<LoadFunction>(&__loadNothing)
+			{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadTyped<type>);
+				LITESER_VALUE_TYPES(SET_LOADER)
+				// packed values are written with full precision
+				LITESER_PACKED_TYPES(SET_LOADER)
+				LITESER_SERIES_TYPES(SET_LOADER)
+#undef SET_LOADER
+				this->set(Type::Identifier::Harray, &__loadContainer);
+				this->set(Type::Identifier::Hmap, &__loadContainer);
+			}
+
+		};
+
+		inline void __loadValue(hlxml::Node* node, void* value, Type* type, chstr name)
+		{
+			const ValueLoaders& loaders = _getTable<ValueLoaders>();
+			loaders.get(type->identifier)(node, value, type, name);
 		}
 
 		inline bool __skipVariable(hlxml::Node* node, Type::Identifier loadedIdentifier)
 		{
 			if (loadedIdentifier == Type::Identifier::ValueObject)	return __skipObject(node);
 			if (loadedIdentifier == Type::Identifier::Object)		return __skipObject(node);
+			if (loadedIdentifier == Type::Identifier::LazyObject)	return __skipObject(node);
 			if (loadedIdentifier == Type::Identifier::Harray)		return __skipContainer(node, loadedIdentifier);
 			if (loadedIdentifier == Type::Identifier::Hmap)			return __skipContainer(node, loadedIdentifier);
 			return false;
 		}
 
-		void __loadContainer(hlxml::Node* node, Variable* variable, Type::Identifier identifier)
+		inline harray<Type::Identifier> __loadContainerIdentifiers(hlxml::Node* node, int count)
 		{
-			variable->containerSize = node->children.size();
-			if (variable->containerSize > 0)
+			harray<Type::Identifier> result;
+			harray<hstr> subTypes = node->pstr(SUB_TYPES).split(SEPARATOR, -1, true);
+			foreach (hstr, it, subTypes)
 			{
-				harray<Type::Identifier> loadedIdentifiers;
-				harray<hstr> subTypes = node->pstr(SUB_TYPES).split(SEPARATOR, -1, true);
-				foreach (hstr, it, subTypes)
-				{
-					loadedIdentifiers += Type::Identifier::fromUint((*it).unhex());
-				}
-				if (loadedIdentifiers.size() != variable->type->subTypes.size())
-				{
-					throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", variable->type->subTypes.size(), loadedIdentifiers.size()));
-				}
-				for_iter (i, 0, loadedIdentifiers.size())
-				{
-					if (loadedIdentifiers[i] == Type::Identifier::Harray || loadedIdentifiers[i] == Type::Identifier::Hmap)
-					{
-						throw Exception(hsprintf("Template container within a template container detected, not supported: %02X", loadedIdentifiers[i].value));
-					}
-				}
-				variable->createSubVariables(identifier);
-				if (loadedIdentifiers.size() > 1) // if more than one load-type, the sub-variables contain the actual data
-				{
-					harray<int> sizes;
-					for_iter (i, 0, variable->subVariables.size())
-					{
-						__loadVariable(node->children[i], variable->subVariables[i], variable->subVariables[i]->type->identifier);
-						sizes += variable->subVariables[i]->containerSize;
-					}
-					if (sizes.size() > 1 && sizes.removedDuplicates().size() > 1)
-					{
-						throw Exception(hsprintf("Variable '%s' has container sub-variables that have different sizes: %s", variable->name.cStr(), sizes.cast<hstr>().joined(',').cStr()));
-					}
-				}
-				else if (variable->subVariables.size() > 0)
+				result += Type::Identifier::fromUint((*it).unhex());
+			}
+			if (result.size() != count)
+			{
+				throw Exception(hsprintf("Number of types for container does not match. Expected: %d, Got: %d", count, result.size()));
+			}
+			foreach (Type::Identifier, it, result)
+			{
+				if ((*it) == Type::Identifier::Harray || (*it) == Type::Identifier::Hmap)
 				{
-					if (variable->type->subTypes[0]->identifier == loadedIdentifiers[0])
-					{
-						for_iter (i, 0, variable->subVariables.size())
-						{
-							__loadVariable(node->children[i], variable->subVariables[i], loadedIdentifiers[0]);
-						}
-					}
-					else
-					{
-						if (!_isCompatibleType(variable->type->subTypes[0]->identifier, loadedIdentifiers[0]))
-						{
-							throw Exception(hsprintf("Variable subtype of '%s' has changed. Expected: %02X, Got: %02X", variable->name.cStr(), variable->type->subTypes[0]->identifier.value, loadedIdentifiers[0].value));
-						}
-						hlog::warn(logTag, "Using compatible subtype for: " + variable->subVariables[0]->name);
-						for_iter (i, 0, variable->subVariables.size())
-						{
-							__loadVariableCompatible(node->children[i], variable->subVariables[i], loadedIdentifiers[0]);
-						}
-					}
+					throw Exception(hsprintf("Template container within a template container detected, not supported: %02X", (*it).value));
 				}
-				if (identifier == Type::Identifier::Hmap)
+			}
+			return result;
+		}
+
+		inline void __checkContainerIdentifier(Type::Identifier identifier, Type::Identifier loadedIdentifier, chstr name)
+		{
+			if (identifier != loadedIdentifier)
+			{
+				if (!_isCompatibleType(identifier, loadedIdentifier))
 				{
-					variable->applyHmapSubVariables(identifier);
+					throw Exception(hsprintf("Variable subtype of '%s' has changed. Expected: %02X, Got: %02X", name.cStr(), identifier.value, loadedIdentifier.value));
 				}
+				hlog::warn(logTag, "Using compatible subtype for: " + name);
+			}
+		}
+
+		inline void __loadElement(hlxml::Node* node, void* value, Type* type, Type::Identifier loadedIdentifier, chstr name)
+		{
+			if (type->identifier == loadedIdentifier)
+			{
+				__loadValue(node, value, type, name);
+			}
+			else
+			{
+				__loadValueCompatible(node, value, type->identifier, loadedIdentifier);
+			}
+		}
+
+		template <typename T>
+		inline void __loadHarray(hlxml::Node* node, harray<T>* value, Type* subType, chstr name)
+		{
+			if (value->size() > 0)
+			{
+				throw Exception("harray in default constructor not empty initially: " + name);
+			}
+			Type::Identifier loadedIdentifier = __loadContainerIdentifiers(node, 1).first();
+			__checkContainerIdentifier(subType->identifier, loadedIdentifier, name);
+			int size = node->children.size();
+			value->add(T(), size); // elements are loaded in place
+			for_iter (i, 0, size)
+			{
+				__loadElement(node->children[i], &value->operator[](i), subType, loadedIdentifier, name);
+			}
+		}
+
+		template <typename K, typename V>
+		inline void __loadHmap(hlxml::Node* node, hmap<K, V>* value, Type* type, chstr name)
+		{
+			if (value->size() > 0)
+			{
+				throw Exception("hmap in default constructor not empty initially: " + name);
+			}
+			__loadContainerIdentifiers(node, 2);
+			if (node->children.size() != 2)
+			{
+				throw Exception(hsprintf("Variable '%s' has an invalid number of hmap containers: %d", name.cStr(), node->children.size()));
+			}
+			// keys and values are stored as two separate containers
+			hlxml::Node* keysNode = node->children[0];
+			hlxml::Node* valuesNode = node->children[1];
+			int size = keysNode->children.size();
+			if (valuesNode->children.size() != size)
+			{
+				throw Exception(hsprintf("Variable '%s' has container sub-variables that have different sizes: %d,%d", name.cStr(), size, valuesNode->children.size()));
+			}
+			Type::Identifier loadedKeyIdentifier = __loadContainerIdentifiers(keysNode, 1).first();
+			Type::Identifier loadedValueIdentifier = __loadContainerIdentifiers(valuesNode, 1).first();
+			__checkContainerIdentifier(type->subTypes[0]->identifier, loadedKeyIdentifier, name);
+			__checkContainerIdentifier(type->subTypes[1]->identifier, loadedValueIdentifier, name);
+			K key;
+			for_iter (i, 0, size)
+			{
+				key = K();
+				__loadElement(keysNode->children[i], &key, type->subTypes[0], loadedKeyIdentifier, name);
+				__loadElement(valuesNode->children[i], &value->operator[](key), type->subTypes[1], loadedValueIdentifier, name);
+			}
+		}
+
+		static void __loadUnsupportedHarray(hlxml::Node*, void*, Type* type, chstr name)
+		{
+			throw Exception(hsprintf("Subtype is not supported within harray: %s; type: %02X", name.cStr(), type->subTypes[0]->identifier.value));
+		}
+
+		static void __loadUnsupportedHmap(hlxml::Node*, void*, Type* type, chstr name)
+		{
+			throw Exception(hsprintf("Subtype is not supported within hmap: %s; types: %02X %02X", name.cStr(), type->subTypes[0]->identifier.value, type->subTypes[1]->identifier.value));
+		}
+
+		template <typename T>
+		static void __loadHarrayTyped(hlxml::Node* node, void* value, Type* type, chstr name)
+		{
+			__loadHarray(node, (harray<T>*)value, type->subTypes[0], name);
+		}
+
+		template <typename K, typename V>
+		static void __loadHmapTyped(hlxml::Node* node, void* value, Type* type, chstr name)
+		{
+			__loadHmap(node, (hmap<K, V>*)value, type, name);
+		}
+
+		/// @brief Harrays of packed values and samples are loaded as harrays of the wrapped type since they have the same layout.
+		class HarrayLoaders : public DispatchTable<LoadFunction>
+		{
+		public:
+			HarrayLoaders() : DispatchTable<LoadFunction>(&__loadUnsupportedHarray)
+			{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadHarrayTyped<type>);
+				LITESER_ELEMENT_TYPES(SET_LOADER)
+				LITESER_PACKED_TYPES(SET_LOADER)
+				LITESER_SERIES_TYPES(SET_LOADER)
+#undef SET_LOADER
+			}
+
+		};
+
+		template <typename K>
+		class HmapLoaders : public DispatchTable<LoadFunction>
+		{
+		public:
+			HmapLoaders() : DispatchTable<LoadFunction>(&__loadUnsupportedHmap)
+			{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadHmapTyped<K, type>);
+				LITESER_ELEMENT_TYPES(SET_LOADER)
+#undef SET_LOADER
+			}
+
+		};
+
+		template <typename K>
+		static void __loadHmapKey(hlxml::Node* node, void* value, Type* type, chstr name)
+		{
+			const HmapLoaders<K>& loaders = _getTable<HmapLoaders<K> >();
+			loaders.get(type->subTypes[1]->identifier)(node, value, type, name);
+		}
+
+		class HmapKeyLoaders : public DispatchTable<LoadFunction>
+		{
+		public:
+			HmapKeyLoaders() : DispatchTable<LoadFunction>(&__loadUnsupportedHmap)
+			{
+#define SET_LOADER(name, type) this->set(Type::Identifier::name, &__loadHmapKey<type>);
+				LITESER_KEY_TYPES(SET_LOADER)
+#undef SET_LOADER
+			}
+
+		};
+
+		void __loadContainer(hlxml::Node* node, void* value, Type* type, chstr name)
+		{
+			if (node->children.size() == 0)
+			{
+				return;
+			}
+			if (type->identifier == Type::Identifier::Harray)
+			{
+				const HarrayLoaders& loaders = _getTable<HarrayLoaders>();
+				loaders.get(type->subTypes[0]->identifier)(node, value, type, name);
+			}
+			else if (type->identifier == Type::Identifier::Hmap)
+			{
+				const HmapKeyLoaders& loaders = _getTable<HmapKeyLoaders>();
+				loaders.get(type->subTypes[0]->identifier)(node, value, type, name);
 			}
 		}
 
@@ -195,6 +383,24 @@ namespace liteser
 			return result;
 		}
 
+#define DEFINE_LOAD(type, loadType) \
+		void _load(hlxml::Node* node, type* value) \
+		{ \
+			*value = node->p ## loadType(VALUE); \
+		}
+
+		DEFINE_LOAD(char, int8);
+		DEFINE_LOAD(unsigned char, uint8);
+		DEFINE_LOAD(short, int16);
+		DEFINE_LOAD(unsigned short, uint16);
+		DEFINE_LOAD(int, int32);
+		DEFINE_LOAD(unsigned int, uint32);
+		DEFINE_LOAD(int64_t, int64);
+		DEFINE_LOAD(uint64_t, uint64);
+		DEFINE_LOAD(float, float);
+		DEFINE_LOAD(double, double);
+		DEFINE_LOAD(bool, bool);
+
 		void _load(hlxml::Node* node, hstr* value)
 		{
 			*value = node->pstr(VALUE);
@@ -292,6 +498,14 @@ namespace liteser
 			__loadObject(node, value);
 		}
 
+		void _load(hlxml::Node* node, LazyBase* value)
+		{
+			// XML is not decoded on demand so the object is loaded right away
+			Serializable* object = NULL;
+			__loadObject(node, &object);
+			value->set(object);
+		}
+
 		void __loadObject(hlxml::Node* node, Serializable** value)
 		{
 			if (node->name != "Object")
@@ -311,7 +525,7 @@ namespace liteser
 				{
 					*value = Factory::create(className);
 				}
-				__tryMapObject(&id, *value);
+				__addObject(*value);
 				harray<Variable*> variables = (*value)->_lsVars();
 				harray<hstr> missingVariableNames;
 				Variable* variable = NULL;
@@ -338,7 +552,7 @@ namespace liteser
 					{
 						if (variable->type->identifier == loadedIdentifier)
 						{
-							__loadVariable(node->children[j], variable, loadedIdentifier);
+							__loadValue(node->children[j], variable->value<char>(), variable->type, variable->name);
 						}
 						else
 						{
@@ -347,7 +561,7 @@ namespace liteser
 								throw Exception(hsprintf("Variable type of '%s' has changed. Expected: %02X, Got: %02X", variable->name.cStr(), variable->type->identifier.value, loadedIdentifier.value));
 							}
 							hlog::warn(logTag, "Using compatible type for: " + variable->name);
-							__loadVariableCompatible(node->children[j], variable, loadedIdentifier);
+							__loadValueCompatible(node->children[j], variable->value<char>(), variable->type->identifier, loadedIdentifier);
 						}
 						delete variables.removeAt(variableIndex);
 					}
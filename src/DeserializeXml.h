@@ -34,14 +34,25 @@ namespace hlxml
 
 namespace liteser
 {
+	class LazyBase;
 	class Serializable;
-	class Variable;
 
 	namespace xml
 	{
-		void __loadContainer(hlxml::Node* node, Variable* variable, Type::Identifier loadedIdentifier);
+		void __loadContainer(hlxml::Node* node, void* value, Type* type, chstr name);
 		bool __skipContainer(hlxml::Node* node, Type::Identifier loadedIdentifier);
 
+		void _load(hlxml::Node* node, char* value);
+		void _load(hlxml::Node* node, unsigned char* value);
+		void _load(hlxml::Node* node, short* value);
+		void _load(hlxml::Node* node, unsigned short* value);
+		void _load(hlxml::Node* node, int* value);
+		void _load(hlxml::Node* node, unsigned int* value);
+		void _load(hlxml::Node* node, int64_t* value);
+		void _load(hlxml::Node* node, uint64_t* value);
+		void _load(hlxml::Node* node, float* value);
+		void _load(hlxml::Node* node, double* value);
+		void _load(hlxml::Node* node, bool* value);
 		void _load(hlxml::Node* node, hstr* value);
 		void _load(hlxml::Node* node, hversion* value);
 		void _load(hlxml::Node* node, henum* value);
@@ -56,6 +67,7 @@ namespace liteser
 		void _load(hlxml::Node* node, gvec3d* value);
 		void _load(hlxml::Node* node, Serializable* value);
 		void _load(hlxml::Node* node, Serializable** value);
+		void _load(hlxml::Node* node, LazyBase* value);
 		void __loadObject(hlxml::Node* node, Serializable** value);
 		bool __skipObject(hlxml::Node* node);
 
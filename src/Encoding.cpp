@@ -0,0 +1,378 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <stdint.h>
+#include <string.h>
+
+#include <hltypes/hexception.h>
+#include <hltypes/hltypesUtil.h>
+
+#include "Encoding.h"
+
+// bytes that are read at once when unpacking, one more than a word since a value can start in the middle of a byte
+#define LITESER_UNPACK_WINDOW_SIZE 9
+
+namespace liteser
+{
+	const unsigned char* _readVarint(const unsigned char* data, const unsigned char* end, uint64_t* value)
+	{
+		// most values are small so single bytes are handled right away
+		if (data < end && *data < 0x80)
+		{
+			*value = *data;
+			return (data + 1);
+		}
+		uint64_t result = 0;
+		unsigned char byte = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			if (data >= end)
+			{
+				throw Exception("Unexpected end of data while loading a varint!");
+			}
+			byte = *data;
+			++data;
+			result |= (uint64_t)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				*value = result;
+				return data;
+			}
+		}
+		throw Exception("Varint is longer than 64 bits!");
+	}
+
+	int _getBitWidth(uint64_t value)
+	{
+		int result = 0;
+		if (value >= ((uint64_t)1 << 32))	{ value >>= 32; result += 32; }
+		if (value >= ((uint64_t)1 << 16))	{ value >>= 16; result += 16; }
+		if (value >= ((uint64_t)1 << 8))	{ value >>= 8; result += 8; }
+		if (value >= ((uint64_t)1 << 4))	{ value >>= 4; result += 4; }
+		if (value >= ((uint64_t)1 << 2))	{ value >>= 2; result += 2; }
+		if (value >= ((uint64_t)1 << 1))	{ value >>= 1; result += 1; }
+		return (result + (int)value);
+	}
+
+	static inline uint64_t __getMask(int bits)
+	{
+		return (bits < 64 ? ((uint64_t)1 << bits) - 1 : ~(uint64_t)0);
+	}
+
+	static inline uint64_t __readWord(const unsigned char* data)
+	{
+		uint64_t result = 0;
+		for (int i = 7; i >= 0; --i)
+		{
+			result = (result << 8) | data[i];
+		}
+		return result;
+	}
+
+	/// @brief Reads bits at any bit position, the last bytes are copied out so nothing after the data is accessed.
+	static inline uint64_t __readBits(const unsigned char* data, int size, int64_t position, int bits)
+	{
+		int index = (int)(position >> 3);
+		int shift = (int)(position & 7);
+		const unsigned char* bytes = &data[index];
+		unsigned char tail[LITESER_UNPACK_WINDOW_SIZE];
+		if (index + LITESER_UNPACK_WINDOW_SIZE > size)
+		{
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, bytes, size - index);
+			bytes = tail;
+		}
+		uint64_t result = __readWord(bytes) >> shift;
+		if (shift + bits > 64)
+		{
+			result |= (uint64_t)bytes[8] << (64 - shift);
+		}
+		return (result & __getMask(bits));
+	}
+
+	/// @brief Writes bits one after another starting with the lowest bit of the first byte.
+	class BitWriter
+	{
+	public:
+		inline BitWriter(unsigned char* data) : data(data), word(0), filled(0)
+		{
+		}
+
+		/// @note The value must not have any bits set above the given number of bits.
+		inline void write(uint64_t value, int bits)
+		{
+			// whole words are written as soon as they are filled, the bits that did not fit start the next word
+			this->word |= value << this->filled;
+			this->filled += bits;
+			if (this->filled >= 64)
+			{
+				for_iter (i, 0, 8)
+				{
+					this->data[i] = (unsigned char)(this->word >> (i * 8));
+				}
+				this->data += 8;
+				this->filled -= 64;
+				this->word = (this->filled > 0 ? value >> (bits - this->filled) : 0);
+			}
+		}
+
+		/// @return Position after the last written byte.
+		inline unsigned char* finish()
+		{
+			for_iter (i, 0, (this->filled + 7) / 8)
+			{
+				this->data[i] = (unsigned char)(this->word >> (i * 8));
+			}
+			return (this->data + (this->filled + 7) / 8);
+		}
+
+	protected:
+		unsigned char* data;
+		uint64_t word;
+		int filled;
+
+	};
+
+	void _packBits(const uint64_t* values, int count, int bits, unsigned char* data)
+	{
+		if (bits == 0)
+		{
+			return;
+		}
+		uint64_t mask = __getMask(bits);
+		BitWriter writer(data);
+		for_iter (i, 0, count)
+		{
+			writer.write(values[i] & mask, bits);
+		}
+		writer.finish();
+	}
+
+	/// @brief Extracts one value of a group of 8, its position is known at compile time so the shifts and the check for a ninth byte are resolved there.
+	template <int bits, int index>
+	static inline uint64_t __extractBits(const unsigned char* data, uint64_t base)
+	{
+		const unsigned char* bytes = &data[index * bits / 8];
+		uint64_t result = __readWord(bytes) >> (index * bits % 8);
+		if (index * bits % 8 + bits > 64)
+		{
+			result |= (uint64_t)bytes[8] << ((64 - index * bits % 8) & 63);
+		}
+		return (base + (result & __getMask(bits)));
+	}
+
+	/// @brief Unpacks whole groups of 8 values, they take exactly as many bytes as a value has bits.
+	/// @note Reads up to 8 bytes after the last group.
+	template <int bits>
+	static void __unpackGroups(const unsigned char* data, int groups, uint64_t base, uint64_t* values)
+	{
+		for_iter (i, 0, groups)
+		{
+			values[0] = __extractBits<bits, 0>(data, base);
+			values[1] = __extractBits<bits, 1>(data, base);
+			values[2] = __extractBits<bits, 2>(data, base);
+			values[3] = __extractBits<bits, 3>(data, base);
+			values[4] = __extractBits<bits, 4>(data, base);
+			values[5] = __extractBits<bits, 5>(data, base);
+			values[6] = __extractBits<bits, 6>(data, base);
+			values[7] = __extractBits<bits, 7>(data, base);
+			data += bits;
+			values += 8;
+		}
+	}
+
+	typedef void (*UnpackGroupsFunction)(const unsigned char*, int, uint64_t, uint64_t*);
+
+#define UNPACK_GROUPS_8(bits) \
+	&__unpackGroups<bits>, &__unpackGroups<bits + 1>, &__unpackGroups<bits + 2>, &__unpackGroups<bits + 3>, \
+	&__unpackGroups<bits + 4>, &__unpackGroups<bits + 5>, &__unpackGroups<bits + 6>, &__unpackGroups<bits + 7>
+	// one unrolled kernel for every bit width
+	static const UnpackGroupsFunction __unpackGroupsFunctions[65] =
+	{
+		NULL,
+		UNPACK_GROUPS_8(1), UNPACK_GROUPS_8(9), UNPACK_GROUPS_8(17), UNPACK_GROUPS_8(25),
+		UNPACK_GROUPS_8(33), UNPACK_GROUPS_8(41), UNPACK_GROUPS_8(49), UNPACK_GROUPS_8(57)
+	};
+#undef UNPACK_GROUPS_8
+
+	void _unpackBits(const unsigned char* data, int size, int count, int bits, uint64_t base, uint64_t* values)
+	{
+		if (bits == 0)
+		{
+			for_iter (i, 0, count)
+			{
+				values[i] = base;
+			}
+			return;
+		}
+		// the kernels read a whole word for every value so the last groups are left to the bounds checked loop
+		int groups = hmin(count / 8, hmax(size - 8, 0) / bits);
+		__unpackGroupsFunctions[bits](data, groups, base, values);
+		int64_t position = (int64_t)groups * 8 * bits;
+		for_iter (i, groups * 8, count)
+		{
+			values[i] = base + __readBits(data, size, position, bits);
+			position += bits;
+		}
+	}
+
+	int _loadFrameHeader(const unsigned char** data, const unsigned char* end, int count, uint64_t* base)
+	{
+		*data = _readVarint(*data, end, base);
+		*base = (uint64_t)_unzigzag(*base);
+		if (*data >= end || **data > 64)
+		{
+			throw Exception("Invalid bit width in encoded harray data!");
+		}
+		int bits = **data;
+		++(*data);
+		if ((int64_t)(end - *data) != ((int64_t)count * bits + 7) / 8)
+		{
+			throw Exception("Encoded harray data does not match its number of elements!");
+		}
+		return bits;
+	}
+
+	/// @param[in] fieldBits Number of bits that store the leading zeros and the length of the stored bits.
+	template <typename T, typename U, int fieldBits>
+	static inline int __encodeSeries(const T* values, int count, unsigned char* data)
+	{
+		int bits = (int)sizeof(U) * 8;
+		BitWriter writer(data);
+		U previous = 0;
+		U current = 0;
+		U difference = 0;
+		int previousLeading = -1; // no bit range was stored yet
+		int previousTrailing = 0;
+		int leading = 0;
+		int trailing = 0;
+		int length = 0;
+		for_iter (i, 0, count)
+		{
+			memcpy(&current, &values[i], sizeof(U));
+			difference = current ^ previous;
+			previous = current;
+			if (difference == 0)
+			{
+				writer.write(0, 1);
+				continue;
+			}
+			leading = bits - _getBitWidth(difference);
+			trailing = _getBitWidth(difference & (~difference + 1)) - 1;
+			if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing)
+			{
+				// bits 1 and 0, the range of the previous sample is used again
+				writer.write(1, 2);
+				writer.write(difference >> previousTrailing, bits - previousLeading - previousTrailing);
+			}
+			else
+			{
+				length = bits - leading - trailing;
+				writer.write(3, 2);
+				writer.write((uint64_t)leading, fieldBits);
+				writer.write((uint64_t)(length - 1), fieldBits);
+				writer.write(difference >> trailing, length);
+				previousLeading = leading;
+				previousTrailing = trailing;
+			}
+		}
+		return (int)(writer.finish() - data);
+	}
+
+	template <typename T, typename U, int fieldBits>
+	static inline void __decodeSeries(const unsigned char* data, int size, T* values, int count)
+	{
+		int bits = (int)sizeof(U) * 8;
+		int64_t position = 0;
+		int64_t end = (int64_t)size * 8;
+		U previous = 0;
+		U difference = 0;
+		int previousLeading = -1;
+		int previousTrailing = 0;
+		int leading = 0;
+		int length = 0;
+		for_iter (i, 0, count)
+		{
+			if (position >= end)
+			{
+				throw Exception("Unexpected end of data while loading a series!");
+			}
+			// a single 0 bit repeats the previous sample
+			if (__readBits(data, size, position, 1) == 0)
+			{
+				++position;
+			}
+			else if (position + 2 > end)
+			{
+				throw Exception("Unexpected end of data while loading a series!");
+			}
+			else if (__readBits(data, size, position + 1, 1) == 0)
+			{
+				position += 2;
+				if (previousLeading < 0)
+				{
+					throw Exception("Series sample uses the bit range of a previous sample that does not exist!");
+				}
+				length = bits - previousLeading - previousTrailing;
+				if (position + length > end)
+				{
+					throw Exception("Unexpected end of data while loading a series!");
+				}
+				difference = (U)(__readBits(data, size, position, length) << previousTrailing);
+				previous ^= difference;
+				position += length;
+			}
+			else
+			{
+				position += 2;
+				if (position + fieldBits * 2 > end)
+				{
+					throw Exception("Unexpected end of data while loading a series!");
+				}
+				leading = (int)__readBits(data, size, position, fieldBits);
+				length = (int)__readBits(data, size, position + fieldBits, fieldBits) + 1;
+				position += fieldBits * 2;
+				if (leading + length > bits || position + length > end)
+				{
+					throw Exception("Invalid bit range in series data!");
+				}
+				previousLeading = leading;
+				previousTrailing = bits - leading - length;
+				difference = (U)(__readBits(data, size, position, length) << previousTrailing);
+				previous ^= difference;
+				position += length;
+			}
+			memcpy(&values[i], &previous, sizeof(U));
+		}
+		if ((position + 7) / 8 != size)
+		{
+			throw Exception("Series data has more data than samples!");
+		}
+	}
+
+	int _encodeSeries(const float* values, int count, unsigned char* data)
+	{
+		return __encodeSeries<float, uint32_t, 5>(values, count, data);
+	}
+
+	int _encodeSeries(const double* values, int count, unsigned char* data)
+	{
+		return __encodeSeries<double, uint64_t, 6>(values, count, data);
+	}
+
+	void _decodeSeries(const unsigned char* data, int size, float* values, int count)
+	{
+		__decodeSeries<float, uint32_t, 5>(data, size, values, count);
+	}
+
+	void _decodeSeries(const unsigned char* data, int size, double* values, int count)
+	{
+		__decodeSeries<double, uint64_t, 6>(data, size, values, count);
+	}
+
+}
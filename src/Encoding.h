@@ -0,0 +1,374 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines the encodings of integer arrays and of series of floats.
+
+#ifndef LITESER_ENCODING_H
+#define LITESER_ENCODING_H
+
+#include <stdint.h>
+
+#include <hltypes/hexception.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hstring.h>
+
+// encodings of integer arrays, stored in front of the elements
+#define LITESER_ENCODING_RAW 0
+#define LITESER_ENCODING_RUNS 1
+#define LITESER_ENCODING_DELTA 2
+#define LITESER_ENCODING_FRAME 3
+// arrays with less elements are always stored raw, the encoding would not save more than its own overhead
+#define LITESER_ENCODING_MIN_COUNT 16
+// the encoding is chosen from a few windows of consecutive elements spread over the array
+#define LITESER_ENCODING_SAMPLE_WINDOWS 8
+#define LITESER_ENCODING_SAMPLE_WINDOW_SIZE 32
+// number of elements that are bit packed at once, a multiple of 8 so every block starts at a whole byte
+#define LITESER_ENCODING_BLOCK_SIZE 1024
+// an unsigned 64 bit varint takes at most 10 bytes
+#define LITESER_VARINT_MAX_SIZE 10
+
+namespace liteser
+{
+	/// @brief Maps small negative and positive values to small unsigned values so they get short varints.
+	inline uint64_t _zigzag(int64_t value)
+	{
+		return (((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+	}
+
+	inline int64_t _unzigzag(uint64_t value)
+	{
+		return ((int64_t)(value >> 1) ^ -(int64_t)(value & 1));
+	}
+
+	inline int _getVarintSize(uint64_t value)
+	{
+		int result = 1;
+		while (value >= 0x80)
+		{
+			value >>= 7;
+			++result;
+		}
+		return result;
+	}
+
+	/// @brief Writes 7 bits per byte with the highest bit set if more bytes follow.
+	/// @return Position after the written bytes.
+	inline unsigned char* _writeVarint(unsigned char* data, uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			*data = (unsigned char)(value | 0x80);
+			++data;
+			value >>= 7;
+		}
+		*data = (unsigned char)value;
+		return (data + 1);
+	}
+
+	/// @return Position after the read bytes.
+	/// @note Throws an exception if the varint does not end before the data.
+	const unsigned char* _readVarint(const unsigned char* data, const unsigned char* end, uint64_t* value);
+	/// @return Number of bits needed to store the value, 0 for 0.
+	int _getBitWidth(uint64_t value);
+	/// @brief Stores the lowest bits of every value one after another starting with the lowest bit of the first byte.
+	/// @note Writes exactly (count * bits + 7) / 8 bytes.
+	void _packBits(const uint64_t* values, int count, int bits, unsigned char* data);
+	/// @brief Reads values that were stored with _packBits() and adds base to every one of them.
+	/// @param[in] size Number of bytes in data, nothing after them is accessed.
+	void _unpackBits(const unsigned char* data, int size, int count, int bits, uint64_t base, uint64_t* values);
+	/// @brief Reads the smallest value and the bit width that come before the bits of frame encoded values.
+	/// @return Number of bits of every value.
+	/// @note Throws an exception if the rest of the data does not hold exactly the given number of values.
+	int _loadFrameHeader(const unsigned char** data, const unsigned char* end, int count, uint64_t* base);
+
+	/// @return Largest number of bytes that _encodeSeries() writes, a sample takes at most 2 bytes more than its value.
+	inline int _getMaxSeriesSize(int count, int elementSize)
+	{
+		return (count * (elementSize + 2) + 8);
+	}
+
+	/// @brief Stores every sample as the XOR with the previous one, only the bits between its leading and trailing zeros are stored.
+	/// @return Number of bytes written.
+	/// @note Samples that are equal to the previous one take a single bit, samples within the bit range of the previous one take two bits more than the range.
+	int _encodeSeries(const float* values, int count, unsigned char* data);
+	int _encodeSeries(const double* values, int count, unsigned char* data);
+	/// @brief Decodes samples that were stored with _encodeSeries().
+	/// @note Throws an exception if the data does not decode to exactly the given number of samples.
+	void _decodeSeries(const unsigned char* data, int size, float* values, int count);
+	void _decodeSeries(const unsigned char* data, int size, double* values, int count);
+
+	/// @brief Integers are encoded as 64 bit values, narrower types are sign extended so differences wrap around the same way for all types.
+	template <typename T>
+	inline uint64_t __widen(T value)
+	{
+		return (uint64_t)(int64_t)value;
+	}
+
+	inline uint64_t __widen(uint64_t value)
+	{
+		return value;
+	}
+
+	/// @brief Estimates the size of every encoding from a sample of the elements since checking all of them would take as long as encoding them.
+	template <typename T>
+	inline unsigned char _chooseEncoding(const T* values, int count)
+	{
+		if (count < LITESER_ENCODING_MIN_COUNT)
+		{
+			return LITESER_ENCODING_RAW;
+		}
+		int windows = LITESER_ENCODING_SAMPLE_WINDOWS;
+		int windowSize = LITESER_ENCODING_SAMPLE_WINDOW_SIZE;
+		if (count < windows * windowSize)
+		{
+			windows = 1;
+			windowSize = count;
+		}
+		int step = count / windows;
+		int64_t runsSize = 0;
+		int64_t deltaSize = 0;
+		T minimum = values[0];
+		T maximum = values[0];
+		int start = 0;
+		int run = 0;
+		uint64_t previous = 0;
+		uint64_t current = 0;
+		for_iter (i, 0, windows)
+		{
+			start = i * step;
+			previous = (start > 0 ? __widen(values[start - 1]) : 0);
+			run = 0;
+			for_iter (j, start, start + windowSize)
+			{
+				current = __widen(values[j]);
+				deltaSize += _getVarintSize(_zigzag((int64_t)(current - previous)));
+				if (run > 0 && current != previous)
+				{
+					runsSize += _getVarintSize(run) + _getVarintSize(_zigzag((int64_t)previous));
+					run = 0;
+				}
+				++run;
+				minimum = hmin(minimum, values[j]);
+				maximum = hmax(maximum, values[j]);
+				previous = current;
+			}
+			runsSize += _getVarintSize(run) + _getVarintSize(_zigzag((int64_t)previous));
+		}
+		int64_t sampleCount = (int64_t)windows * windowSize;
+		int64_t rawSize = (int64_t)count * sizeof(T);
+		runsSize = runsSize * count / sampleCount;
+		deltaSize = deltaSize * count / sampleCount;
+		int64_t frameSize = ((int64_t)count * _getBitWidth(__widen(maximum) - __widen(minimum)) + 7) / 8 + LITESER_VARINT_MAX_SIZE + 1;
+		unsigned char result = LITESER_ENCODING_RAW;
+		int64_t size = rawSize;
+		if (runsSize < size)
+		{
+			result = LITESER_ENCODING_RUNS;
+			size = runsSize;
+		}
+		if (deltaSize < size)
+		{
+			result = LITESER_ENCODING_DELTA;
+			size = deltaSize;
+		}
+		if (frameSize < size)
+		{
+			result = LITESER_ENCODING_FRAME;
+		}
+		return result;
+	}
+
+	/// @brief Stores every run of equal values as its length and the value.
+	template <typename T>
+	inline unsigned char* __encodeRuns(const T* values, int count, unsigned char* data, unsigned char* end)
+	{
+		int start = 0;
+		for_iter (i, 1, count + 1)
+		{
+			if (i == count || values[i] != values[start])
+			{
+				// the sample only estimated the size so the data could still be larger than raw values
+				if (end - data < LITESER_VARINT_MAX_SIZE * 2)
+				{
+					return NULL;
+				}
+				data = _writeVarint(data, (uint64_t)(i - start));
+				data = _writeVarint(data, _zigzag((int64_t)__widen(values[start])));
+				start = i;
+			}
+		}
+		return data;
+	}
+
+	/// @brief Stores every value as its difference to the previous value.
+	template <typename T>
+	inline unsigned char* __encodeDelta(const T* values, int count, unsigned char* data, unsigned char* end)
+	{
+		uint64_t previous = 0;
+		uint64_t current = 0;
+		for_iter (i, 0, count)
+		{
+			if (end - data < LITESER_VARINT_MAX_SIZE)
+			{
+				return NULL;
+			}
+			current = __widen(values[i]);
+			data = _writeVarint(data, _zigzag((int64_t)(current - previous)));
+			previous = current;
+		}
+		return data;
+	}
+
+	/// @brief Stores the smallest value and every value as its difference to it with as many bits as the largest difference needs.
+	template <typename T>
+	inline unsigned char* __encodeFrame(const T* values, int count, unsigned char* data, unsigned char* end)
+	{
+		T minimum = values[0];
+		T maximum = values[0];
+		for_iter (i, 1, count)
+		{
+			minimum = hmin(minimum, values[i]);
+			maximum = hmax(maximum, values[i]);
+		}
+		uint64_t base = __widen(minimum);
+		int bits = _getBitWidth(__widen(maximum) - base);
+		if ((int64_t)(end - data) < ((int64_t)count * bits + 7) / 8 + LITESER_VARINT_MAX_SIZE + 1)
+		{
+			return NULL;
+		}
+		data = _writeVarint(data, _zigzag((int64_t)base));
+		*data = (unsigned char)bits;
+		++data;
+		uint64_t block[LITESER_ENCODING_BLOCK_SIZE];
+		int size = 0;
+		for (int i = 0; i < count; i += size)
+		{
+			size = hmin(count - i, LITESER_ENCODING_BLOCK_SIZE);
+			for_iter (j, 0, size)
+			{
+				block[j] = __widen(values[i + j]) - base;
+			}
+			_packBits(block, size, bits, data);
+			data += (size * bits + 7) / 8;
+		}
+		return data;
+	}
+
+	/// @brief Encodes integers with the encoding that was chosen for them.
+	/// @param[in] end End of the output buffer.
+	/// @return Position after the encoded data, NULL if the data would not have fit into the buffer.
+	template <typename T>
+	inline unsigned char* _encodeIntegers(unsigned char encoding, const T* values, int count, unsigned char* data, unsigned char* end)
+	{
+		if (encoding == LITESER_ENCODING_RUNS)	return __encodeRuns(values, count, data, end);
+		if (encoding == LITESER_ENCODING_DELTA)	return __encodeDelta(values, count, data, end);
+		if (encoding == LITESER_ENCODING_FRAME)	return __encodeFrame(values, count, data, end);
+		return NULL;
+	}
+
+	/// @brief Stores a decoded value, containers of other types can be filled directly by overloading this for them.
+	template <typename T>
+	inline void _storeDecoded(T* values, int index, uint64_t value)
+	{
+		values[index] = (T)value;
+	}
+
+	template <typename T>
+	inline void __decodeRuns(const unsigned char* data, const unsigned char* end, T* values, int count)
+	{
+		uint64_t size = 0;
+		uint64_t value = 0;
+		int index = 0;
+		while (index < count)
+		{
+			data = _readVarint(data, end, &size);
+			data = _readVarint(data, end, &value);
+			if (size == 0 || size > (uint64_t)(count - index))
+			{
+				throw Exception("Invalid run in encoded harray data!");
+			}
+			value = (uint64_t)_unzigzag(value);
+			for_itert (uint64_t, i, 0, size)
+			{
+				_storeDecoded(values, index, value);
+				++index;
+			}
+		}
+		if (data != end)
+		{
+			throw Exception("Encoded harray data has more runs than elements!");
+		}
+	}
+
+	template <typename T>
+	inline void __decodeDelta(const unsigned char* data, const unsigned char* end, T* values, int count)
+	{
+		uint64_t previous = 0;
+		uint64_t delta = 0;
+		for_iter (i, 0, count)
+		{
+			data = _readVarint(data, end, &delta);
+			previous += (uint64_t)_unzigzag(delta);
+			_storeDecoded(values, i, previous);
+		}
+		if (data != end)
+		{
+			throw Exception("Encoded harray data has more differences than elements!");
+		}
+	}
+
+	/// @brief Narrower types are unpacked in blocks that are converted afterwards.
+	template <typename T>
+	inline void __decodeFrame(const unsigned char* data, const unsigned char* end, T* values, int count)
+	{
+		uint64_t base = 0;
+		int bits = _loadFrameHeader(&data, end, count, &base);
+		uint64_t block[LITESER_ENCODING_BLOCK_SIZE];
+		int size = 0;
+		int blockSize = 0;
+		for (int i = 0; i < count; i += size)
+		{
+			size = hmin(count - i, LITESER_ENCODING_BLOCK_SIZE);
+			blockSize = (size * bits + 7) / 8;
+			_unpackBits(data, blockSize, size, bits, base, block);
+			for_iter (j, 0, size)
+			{
+				_storeDecoded(values, i + j, block[j]);
+			}
+			data += blockSize;
+		}
+	}
+
+	/// @brief 64 bit values are unpacked straight into the elements.
+	inline void __decodeFrame(const unsigned char* data, const unsigned char* end, uint64_t* values, int count)
+	{
+		uint64_t base = 0;
+		int bits = _loadFrameHeader(&data, end, count, &base);
+		_unpackBits(data, (int)(end - data), count, bits, base, values);
+	}
+
+	inline void __decodeFrame(const unsigned char* data, const unsigned char* end, int64_t* values, int count)
+	{
+		__decodeFrame(data, end, (uint64_t*)values, count);
+	}
+
+	/// @brief Decodes integers that were stored with _encodeIntegers().
+	/// @note Throws an exception if the data does not decode to exactly the given number of elements.
+	template <typename T>
+	inline void _decodeIntegers(unsigned char encoding, const unsigned char* data, int size, T* values, int count)
+	{
+		if (encoding == LITESER_ENCODING_RUNS)			__decodeRuns(data, data + size, values, count);
+		else if (encoding == LITESER_ENCODING_DELTA)	__decodeDelta(data, data + size, values, count);
+		else if (encoding == LITESER_ENCODING_FRAME)	__decodeFrame(data, data + size, values, count);
+		else throw Exception(hsprintf("Unknown harray encoding: %d", encoding));
+	}
+
+}
+#endif
@@ -6,17 +6,36 @@
 /// This program is free software; you can redistribute it and/or modify it under
 /// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
 
+#include <hltypes/harray.h>
 #include <hltypes/hmap.h>
 #include <hltypes/hstring.h>
 #include <hltypes/hlog.h>
 
+#include "Allocator.h"
+#include "Context.h" // LITESER_THREAD_LOCAL
 #include "Factory.h"
 #include "Serializable.h"
 
 namespace liteser
 {
+	/// @brief Ways to create an object of a registered class.
+	struct Constructor
+	{
+		hstr name;
+		Serializable* (*create)();
+		Serializable* (*construct)(void*);
+		int size;
+
+		Constructor() : create(NULL), construct(NULL), size(0)
+		{
+		}
+
+	};
+
 	// this approach is used because there is a massive problem with static linking
-	static hmap<hstr, Serializable* (*)()>* __lsConstructors = NULL;
+	static harray<Constructor>* __lsConstructors = NULL;
+	static hmap<hstr, int>* __lsClassIds = NULL;
+	static LITESER_THREAD_LOCAL Allocator* __allocator = NULL;
 
 	Factory::Factory()
 	{
@@ -28,23 +47,98 @@ namespace liteser
 
 	Serializable* Factory::create(chstr name)
 	{
-		Serializable* (*constructor)() = __lsConstructors->tryGet(name, NULL);
-		if (constructor == NULL)
+		int classId = Factory::getClassId(name);
+		if (classId < 0)
 		{
 			throw Exception("Detected class not registered as a Serializable: '" + name + "'");
 		}
-		return (*constructor)();
+		return Factory::create(classId);
+	}
+
+	Serializable* Factory::create(int classId)
+	{
+		if (__lsConstructors == NULL || classId < 0 || classId >= __lsConstructors->size())
+		{
+			throw Exception(hsprintf("Detected class ID not registered as a Serializable: %d", classId));
+		}
+		Constructor& constructor = (*__lsConstructors)[classId];
+		if (__allocator != NULL)
+		{
+			void* memory = __allocator->allocate(classId, constructor.name, constructor.size);
+			if (memory != NULL)
+			{
+				Serializable* object = NULL;
+				try
+				{
+					object = (*constructor.construct)(memory);
+				}
+				catch (...)
+				{
+					__allocator->release(memory);
+					throw;
+				}
+				__allocator->addObject(object);
+				return object;
+			}
+		}
+		return (*constructor.create)();
 	}
 
-	void Factory::_register(chstr name, Serializable* (*constructor)())
+	void Factory::release(Serializable* object)
+	{
+		if (object == NULL)
+		{
+			return;
+		}
+		// the memory starts at the most derived object, which is not the Serializable part with multiple inheritance
+		void* memory = dynamic_cast<void*>(object);
+		Allocator* allocator = Allocator::_find(memory);
+		if (allocator == NULL)
+		{
+			delete object;
+			return;
+		}
+		object->~Serializable();
+		allocator->release(memory);
+	}
+
+	int Factory::getClassId(chstr name)
+	{
+		return (__lsClassIds != NULL ? __lsClassIds->tryGet(name, -1) : -1);
+	}
+
+	void Factory::setAllocator(Allocator* allocator)
+	{
+		__allocator = allocator;
+	}
+
+	Allocator* Factory::getAllocator()
+	{
+		return __allocator;
+	}
+
+	int Factory::_register(chstr name, Serializable* (*constructor)(), Serializable* (*placementConstructor)(void*), int size)
 	{
 		if (__lsConstructors == NULL)
 		{
-			__lsConstructors = new hmap<hstr, Serializable* (*)()>();
+			__lsConstructors = new harray<Constructor>();
+			__lsClassIds = new hmap<hstr, int>();
 		}
 		// because of the order of global var initializations, mutexes get messed up
 		printf("[liteser] Registering class: %s\n", name.cStr());
-		__lsConstructors->operator[](name) = constructor;
+		int classId = __lsClassIds->tryGet(name, -1);
+		if (classId < 0)
+		{
+			classId = __lsConstructors->size();
+			__lsConstructors->add(Constructor());
+			__lsClassIds->operator[](name) = classId;
+		}
+		Constructor& entry = (*__lsConstructors)[classId];
+		entry.name = name;
+		entry.create = constructor;
+		entry.construct = placementConstructor;
+		entry.size = size;
+		return classId;
 	}
 	
 }
@@ -16,6 +16,16 @@ namespace liteser
 		this->version = liteser::version;
 		this->allowMultiReferencing = true;
 		this->stringPooling = true;
+		this->compressed = false;
+		this->indexed = false;
+		this->lengthPrefixed = false;
+		this->delta = false;
+		this->stringCount = 0;
+		this->stringSize = 0;
+		this->stringPoolSize = false;
+		this->columnar = false;
+		this->encodedArrays = false;
+		this->compactIntegers = false;
 	}
 
 	Header::Header(bool allowMultiReferencing, bool stringPooling)
@@ -23,6 +33,33 @@ namespace liteser
 		this->version = liteser::version;
 		this->allowMultiReferencing = allowMultiReferencing;
 		this->stringPooling = stringPooling;
+		this->compressed = false;
+		this->indexed = false;
+		this->lengthPrefixed = false;
+		this->delta = false;
+		this->stringCount = 0;
+		this->stringSize = 0;
+		this->stringPoolSize = false;
+		this->columnar = false;
+		this->encodedArrays = false;
+		this->compactIntegers = false;
+	}
+
+	Header::Header(const Options& options)
+	{
+		this->version = liteser::version;
+		this->allowMultiReferencing = options.allowMultiReferencing;
+		this->stringPooling = options.stringPooling;
+		this->compressed = options.compressed;
+		this->indexed = false;
+		this->lengthPrefixed = options.lengthPrefixed;
+		this->delta = false;
+		this->stringCount = 0;
+		this->stringSize = 0;
+		this->stringPoolSize = options.stringPoolSize;
+		this->columnar = false;
+		this->encodedArrays = options.encodedArrays;
+		this->compactIntegers = options.compactIntegers;
 	}
 
 	Header::~Header()
@@ -0,0 +1,174 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents a flat hash table that assigns consecutive IDs to keys.
+
+#ifndef LITESER_ID_MAP_H
+#define LITESER_ID_MAP_H
+
+#include <stdint.h>
+
+#include <hltypes/harray.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hstring.h>
+
+namespace liteser
+{
+	class Serializable;
+
+	inline unsigned int _hashKey(Serializable* const& key)
+	{
+		// pointers are aligned so the low bits have to be mixed with the high ones
+		uint64_t value = (uint64_t)(size_t)key;
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDULL;
+		value ^= value >> 33;
+		return (unsigned int)value;
+	}
+
+	inline unsigned int _hashKey(const hstr& key)
+	{
+		// FNV-1a
+		unsigned int result = 2166136261u;
+		const unsigned char* data = (const unsigned char*)key.cStr();
+		int size = key.size();
+		for_iter (i, 0, size)
+		{
+			result = (result ^ data[i]) * 16777619u;
+		}
+		return result;
+	}
+
+	/// @brief Open addressing table that maps keys to the index under which they were added.
+	/// @note Keys are stored in insertion order and their hashes are kept so growing the table never hashes a key again.
+	template <typename T>
+	class IdMap
+	{
+	public:
+		IdMap() : slotMask(0)
+		{
+		}
+
+		~IdMap()
+		{
+		}
+
+		inline int size() const { return this->keys.size(); }
+		inline int slotCount() const { return this->slots.size(); }
+		inline const T& operator[](int index) const { return this->keys[index]; }
+
+		/// @brief Makes room for the given number of keys so adding them does not grow the table.
+		void reserve(int size)
+		{
+			int slotCount = (this->slots.size() > 0 ? this->slots.size() : 16);
+			while (slotCount < size * 2)
+			{
+				slotCount *= 2;
+			}
+			this->keys.reserve(size);
+			this->hashes.reserve(size);
+			if (slotCount > this->slots.size())
+			{
+				this->_rehash(slotCount);
+			}
+		}
+
+		/// @brief Removes all keys, but keeps the allocated table.
+		void clear()
+		{
+			int slotCount = this->slots.size();
+			this->keys.clear();
+			this->hashes.clear();
+			this->slots.clear();
+			this->slots.add(-1, slotCount);
+		}
+
+		/// @return Index of the key or -1 if it is not in the table.
+		int indexOf(const T& key) const
+		{
+			if (this->slots.size() == 0)
+			{
+				return -1;
+			}
+			unsigned int hash = _hashKey(key);
+			unsigned int slot = hash & this->slotMask;
+			int current = this->slots[slot];
+			while (current >= 0)
+			{
+				if (this->hashes[current] == hash && this->keys[current] == key)
+				{
+					return current;
+				}
+				slot = (slot + 1) & this->slotMask;
+				current = this->slots[slot];
+			}
+			return -1;
+		}
+
+		/// @brief Finds the index of a key and adds the key if it is not in the table yet.
+		/// @param[in] key The key.
+		/// @param[out] index Index of the key.
+		/// @return True if the key was added.
+		bool tryAdd(const T& key, int* index)
+		{
+			// the table is kept at most half full so probe sequences stay short
+			if ((this->keys.size() + 1) * 2 > this->slots.size())
+			{
+				this->_rehash(this->slots.size() > 0 ? this->slots.size() * 2 : 16);
+			}
+			unsigned int hash = _hashKey(key);
+			unsigned int slot = hash & this->slotMask;
+			int current = this->slots[slot];
+			while (current >= 0)
+			{
+				if (this->hashes[current] == hash && this->keys[current] == key)
+				{
+					*index = current;
+					return false;
+				}
+				slot = (slot + 1) & this->slotMask;
+				current = this->slots[slot];
+			}
+			*index = this->keys.size();
+			this->slots[slot] = *index;
+			this->keys += key;
+			this->hashes += hash;
+			return true;
+		}
+
+	protected:
+		harray<T> keys;
+		harray<unsigned int> hashes;
+		/// @brief Indices of keys, -1 marks empty slots.
+		harray<int> slots;
+		unsigned int slotMask;
+
+		void _rehash(int slotCount)
+		{
+			this->slotMask = (unsigned int)slotCount - 1;
+			this->slots.clear();
+			this->slots.add(-1, slotCount);
+			int size = this->keys.size();
+			unsigned int slot = 0;
+			for_iter (i, 0, size)
+			{
+				slot = this->hashes[i] & this->slotMask;
+				while (this->slots[slot] >= 0)
+				{
+					slot = (slot + 1) & this->slotMask;
+				}
+				this->slots[slot] = i;
+			}
+		}
+
+	};
+
+}
+#endif
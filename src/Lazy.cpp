@@ -0,0 +1,79 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include "Lazy.h"
+#include "LazyScope.h"
+
+namespace liteser
+{
+	LazyBase::LazyBase() :
+		slot(NULL)
+	{
+	}
+
+	LazyBase::LazyBase(const LazyBase& other) :
+		slot(other.slot)
+	{
+		if (this->slot != NULL)
+		{
+			this->slot->retain();
+		}
+	}
+
+	LazyBase::~LazyBase()
+	{
+		if (this->slot != NULL)
+		{
+			this->slot->release();
+		}
+	}
+
+	LazyBase& LazyBase::operator=(const LazyBase& other)
+	{
+		if (other.slot != NULL)
+		{
+			other.slot->retain();
+		}
+		if (this->slot != NULL)
+		{
+			this->slot->release();
+		}
+		this->slot = other.slot;
+		return (*this);
+	}
+
+	bool LazyBase::isLoaded() const
+	{
+		return (this->slot == NULL || this->slot->scope == NULL);
+	}
+
+	Serializable* LazyBase::get()
+	{
+		if (this->slot == NULL)
+		{
+			return NULL;
+		}
+		this->slot->load();
+		return this->slot->object;
+	}
+
+	void LazyBase::set(Serializable* object)
+	{
+		this->_setSlot(object != NULL ? new LazySlot(object) : NULL);
+	}
+
+	void LazyBase::_setSlot(LazySlot* slot)
+	{
+		if (this->slot != NULL)
+		{
+			this->slot->release();
+		}
+		this->slot = slot;
+	}
+
+}
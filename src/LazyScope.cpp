@@ -0,0 +1,133 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <stdint.h>
+
+#include <hltypes/harray.h>
+#include <hltypes/hltypesUtil.h>
+
+#include "Deserialize.h"
+#include "Header.h"
+#include "LazyScope.h"
+#include "MappedFile.h"
+
+namespace liteser
+{
+	LazyScope::LazyScope(const Header& header, LazyScope* parent) :
+		header(header),
+		objects(NULL),
+		parent(parent),
+		buffer(NULL),
+		file(NULL),
+		references(1)
+	{
+		// lazy objects have their own string pools
+		this->header.stringCount = 0;
+		this->header.stringSize = 0;
+		if (this->parent != NULL)
+		{
+			this->parent->retain();
+		}
+	}
+
+	LazyScope::~LazyScope()
+	{
+		if (this->buffer != NULL)
+		{
+			delete[] this->buffer;
+		}
+		if (this->file != NULL)
+		{
+			delete this->file;
+		}
+		foreach (unsigned char*, it, this->copies)
+		{
+			delete[] (*it);
+		}
+		if (this->parent != NULL)
+		{
+			this->parent->release();
+		}
+	}
+
+	void LazyScope::retain()
+	{
+		++this->references;
+	}
+
+	void LazyScope::release()
+	{
+		--this->references;
+		if (this->references == 0)
+		{
+			delete this;
+		}
+	}
+
+	LazySlot::LazySlot(Serializable* object) :
+		object(object),
+		scope(NULL),
+		data(NULL),
+		size(0),
+		outerReferences(0),
+		references(1)
+	{
+	}
+
+	LazySlot::LazySlot(LazyScope* scope, const unsigned char* data, int64_t size, unsigned int outerReferences) :
+		object(NULL),
+		scope(scope),
+		data(data),
+		size(size),
+		outerReferences(outerReferences),
+		references(1)
+	{
+		this->scope->retain();
+	}
+
+	LazySlot::~LazySlot()
+	{
+		if (this->scope != NULL)
+		{
+			this->scope->release();
+		}
+	}
+
+	void LazySlot::retain()
+	{
+		++this->references;
+	}
+
+	void LazySlot::release()
+	{
+		--this->references;
+		if (this->references == 0)
+		{
+			delete this;
+		}
+	}
+
+	void LazySlot::load(harray<Serializable*>* objects)
+	{
+		if (this->scope == NULL)
+		{
+			return;
+		}
+		Serializable* object = NULL;
+		_loadLazyObject(this->scope, this->data, this->size, &object, objects);
+		this->object = object;
+		// the data is not needed anymore and the memory can be freed once no other lazy object needs it
+		LazyScope* scope = this->scope;
+		this->scope = NULL;
+		this->data = NULL;
+		this->size = 0;
+		this->outerReferences = 0;
+		scope->release();
+	}
+
+}
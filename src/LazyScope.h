@@ -0,0 +1,89 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents the data that lazy objects are decoded from.
+
+#ifndef LITESER_LAZY_SCOPE_H
+#define LITESER_LAZY_SCOPE_H
+
+#include <stdint.h>
+
+#include <hltypes/harray.h>
+
+#include "Header.h"
+
+// object ID that marks a reference from within a lazy object to an object of the data that encloses it
+#define LITESER_OUTER_REFERENCE 0xFFFFFFFE
+// object ID that marks a reference to an object that was written within a lazy object of the same data
+#define LITESER_LAZY_REFERENCE 0xFFFFFFFD
+
+namespace liteser
+{
+	class MappedFile;
+	class Serializable;
+
+	/// @brief One level of binary data, i.e. the data of a call or of a lazy object, that contains lazy objects.
+	/// @note Lazy objects keep their level alive, levels keep their enclosing level alive and the outermost one owns the memory.
+	class LazyScope
+	{
+	public:
+		Header header;
+		/// @brief Objects of this level in order of their IDs, complete once the whole level was loaded.
+		/// @note Points to the objects of the context while the level is loaded and to loadedObjects afterwards.
+		harray<Serializable*>* objects;
+		harray<Serializable*> loadedObjects;
+		LazyScope* parent;
+		unsigned char* buffer;
+		MappedFile* file;
+		/// @brief Copies of the data of single lazy objects if the level was read from a stream in parts.
+		harray<unsigned char*> copies;
+
+		LazyScope(const Header& header, LazyScope* parent);
+
+		void retain();
+		void release();
+
+	protected:
+		int references;
+
+		~LazyScope();
+
+	};
+
+	/// @brief The state of a lazy object that is shared by all copies of a Lazy.
+	class LazySlot
+	{
+	public:
+		Serializable* object;
+		/// @brief Level the encoded object belongs to, NULL once the object was decoded.
+		LazyScope* scope;
+		const unsigned char* data;
+		int64_t size;
+		/// @brief Number of references to objects outside of the encoded object.
+		unsigned int outerReferences;
+
+		LazySlot(Serializable* object);
+		LazySlot(LazyScope* scope, const unsigned char* data, int64_t size, unsigned int outerReferences);
+
+		void retain();
+		void release();
+		/// @brief Decodes the object if it was not decoded yet.
+		/// @param[out] objects Gets all objects of the decoded object in order of their IDs if not NULL.
+		void load(harray<Serializable*>* objects = NULL);
+
+	protected:
+		int references;
+
+		~LazySlot();
+
+	};
+
+}
+#endif
@@ -0,0 +1,128 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#ifdef _WIN32
+#ifndef _WINRT
+#include <windows.h>
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <hltypes/hstring.h>
+
+#include "MappedFile.h"
+
+namespace liteser
+{
+	MappedFile::MappedFile() :
+		data(NULL),
+		size(0)
+	{
+#ifdef _WIN32
+		this->file = NULL;
+		this->mapping = NULL;
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+		this->close();
+	}
+
+	bool MappedFile::open(chstr filename)
+	{
+		this->close();
+#ifdef _WIN32
+#ifndef _WINRT
+		HANDLE file = CreateFileW(filename.wStr().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 || (uint64_t)fileSize.QuadPart > (uint64_t)(SIZE_T)-1)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == NULL)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		this->file = file;
+		this->mapping = mapping;
+		this->data = (const unsigned char*)data;
+		this->size = (int64_t)fileSize.QuadPart;
+		return true;
+#else
+		// WinRT apps cannot map arbitrary files, the caller falls back to a stream
+		return false;
+#endif
+#else
+		int descriptor = ::open(filename.cStr(), O_RDONLY);
+		if (descriptor < 0)
+		{
+			return false;
+		}
+		struct stat info;
+		if (fstat(descriptor, &info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > (uint64_t)(size_t)-1)
+		{
+			::close(descriptor);
+			return false;
+		}
+		void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		// the mapping stays valid after the descriptor is closed
+		::close(descriptor);
+		if (data == MAP_FAILED)
+		{
+			return false;
+		}
+#ifdef MADV_SEQUENTIAL
+		madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+#endif
+		this->data = (const unsigned char*)data;
+		this->size = (int64_t)info.st_size;
+		return true;
+#endif
+	}
+
+	void MappedFile::close()
+	{
+		if (this->data == NULL)
+		{
+			return;
+		}
+#ifdef _WIN32
+#ifndef _WINRT
+		UnmapViewOfFile(this->data);
+		CloseHandle((HANDLE)this->mapping);
+		CloseHandle((HANDLE)this->file);
+#endif
+		this->file = NULL;
+		this->mapping = NULL;
+#else
+		munmap((void*)this->data, (size_t)this->size);
+#endif
+		this->data = NULL;
+		this->size = 0;
+	}
+
+}
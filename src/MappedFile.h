@@ -0,0 +1,50 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents a read-only memory mapping of a file.
+
+#ifndef LITESER_MAPPED_FILE_H
+#define LITESER_MAPPED_FILE_H
+
+#include <stdint.h>
+
+#include <hltypes/hstring.h>
+
+namespace liteser
+{
+	/// @brief Maps a whole file into memory so it can be decoded without any copying or stream calls.
+	/// @note The pages come from the OS file cache so processes loading the same file share them.
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		inline const unsigned char* getData() const { return this->data; }
+		inline int64_t getSize() const { return this->size; }
+
+		/// @brief Maps a file.
+		/// @param[in] filename Path of the file.
+		/// @return False if the file could not be mapped, e.g. if it is empty or the platform does not support mapping.
+		bool open(chstr filename);
+		void close();
+
+	protected:
+		const unsigned char* data;
+		int64_t size;
+#ifdef _WIN32
+		void* file;
+		void* mapping;
+#endif
+
+	};
+
+}
+#endif
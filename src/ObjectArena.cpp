@@ -0,0 +1,159 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <hltypes/harray.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hmutex.h>
+#include <hltypes/hstring.h>
+
+#include "ObjectArena.h"
+#include "Serializable.h"
+
+// every object starts at a multiple of this so any member is aligned
+#define LITESER_ARENA_ALIGNMENT 16
+
+namespace liteser
+{
+	ObjectArena::Pool::Pool() :
+		current(NULL),
+		remaining(0)
+	{
+	}
+
+	ObjectArena::ObjectArena(int blockSize, bool classPools) :
+		blockSize(hmax(blockSize, LITESER_ARENA_ALIGNMENT)),
+		classPools(classPools),
+		current(NULL),
+		remaining(0),
+		objectCount(0)
+	{
+	}
+
+	ObjectArena::~ObjectArena()
+	{
+		this->clear();
+	}
+
+	unsigned char* ObjectArena::_allocate(unsigned char** current, int* remaining, int size)
+	{
+		if (size > *remaining)
+		{
+			// new[] returns memory that is aligned for any fundamental type
+			int blockSize = hmax(size, this->blockSize);
+			unsigned char* block = new unsigned char[blockSize];
+			this->blocks += block;
+			this->_addBlock(block, blockSize);
+			// a large object does not waste the rest of the current block
+			if (size > this->blockSize && *remaining > 0)
+			{
+				return block;
+			}
+			*current = block;
+			*remaining = blockSize;
+		}
+		unsigned char* result = *current;
+		*current += size;
+		*remaining -= size;
+		return result;
+	}
+
+	void* ObjectArena::allocate(int classId, chstr, int size)
+	{
+		hmutex::ScopeLock lock(&this->mutex);
+		// the slot in front of the object is aligned as well
+		size = (size + LITESER_ARENA_ALIGNMENT - 1) / LITESER_ARENA_ALIGNMENT * LITESER_ARENA_ALIGNMENT + LITESER_ARENA_ALIGNMENT;
+		unsigned char* memory = NULL;
+		Pool* pool = NULL;
+		if (this->classPools)
+		{
+			if (classId >= this->pools.size())
+			{
+				this->pools.add(NULL, classId - this->pools.size() + 1);
+			}
+			pool = this->pools[classId];
+			if (pool == NULL)
+			{
+				pool = new Pool();
+				this->pools[classId] = pool;
+			}
+			memory = (pool->freeMemory.size() > 0 ? pool->freeMemory.removeLast() : this->_allocate(&pool->current, &pool->remaining, size));
+		}
+		else
+		{
+			memory = this->_allocate(&this->current, &this->remaining, size);
+		}
+		Slot* slot = (Slot*)memory;
+		slot->index = this->objects.size();
+		slot->pool = pool;
+		this->objects += (Serializable*)NULL;
+		return (memory + LITESER_ARENA_ALIGNMENT);
+	}
+
+	void ObjectArena::addObject(Serializable* object)
+	{
+		// the same memory that was passed to the constructor
+		Slot* slot = (Slot*)((unsigned char*)dynamic_cast<void*>(object) - LITESER_ARENA_ALIGNMENT);
+		hmutex::ScopeLock lock(&this->mutex);
+		this->objects[slot->index] = object;
+		++this->objectCount;
+	}
+
+	void ObjectArena::release(void* memory)
+	{
+		Slot* slot = (Slot*)((unsigned char*)memory - LITESER_ARENA_ALIGNMENT);
+		hmutex::ScopeLock lock(&this->mutex);
+		if (this->objects[slot->index] != NULL)
+		{
+			this->objects[slot->index] = NULL;
+			--this->objectCount;
+		}
+		if (slot->pool != NULL)
+		{
+			slot->pool->freeMemory += (unsigned char*)slot;
+		}
+	}
+
+	void ObjectArena::clear()
+	{
+		// owners are destroyed before the objects they were loaded with, so objects that they release are skipped
+		hmutex::ScopeLock lock(&this->mutex);
+		int size = this->objects.size();
+		Serializable* object = NULL;
+		for_iter (i, 0, size)
+		{
+			object = this->objects[i];
+			if (object != NULL)
+			{
+				this->objects[i] = NULL;
+				// destructors release other objects which takes the lock again
+				lock.release();
+				object->~Serializable();
+				lock.acquire(&this->mutex);
+			}
+		}
+		this->objects.clear();
+		this->objectCount = 0;
+		foreach (unsigned char*, it, this->blocks)
+		{
+			this->_removeBlock(*it);
+			delete[] (*it);
+		}
+		this->blocks.clear();
+		this->current = NULL;
+		this->remaining = 0;
+		foreach (Pool*, it, this->pools)
+		{
+			if ((*it) != NULL)
+			{
+				delete (*it);
+			}
+		}
+		this->pools.clear();
+	}
+
+}
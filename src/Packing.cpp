@@ -0,0 +1,140 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <string.h>
+
+#include <hltypes/hltypesUtil.h>
+
+#include "Packing.h"
+
+#define LITESER_FIXED_MIN -32768.0f
+#define LITESER_FIXED_MAX 32767.0f
+
+namespace liteser
+{
+	static inline unsigned short __packHalf(float value)
+	{
+		unsigned int bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		unsigned int sign = (bits >> 16) & 0x8000;
+		int exponent = (int)((bits >> 23) & 0xFF);
+		unsigned int mantissa = bits & 0x7FFFFF;
+		if (exponent == 0xFF) // NaN keeps a bit of its mantissa so it does not become infinity
+		{
+			return (unsigned short)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+		}
+		exponent -= 127 - 15;
+		if (exponent >= 0x1F)
+		{
+			return (unsigned short)(sign | 0x7C00);
+		}
+		unsigned int half = 0;
+		unsigned int remainder = 0;
+		unsigned int halfway = 0;
+		if (exponent > 0)
+		{
+			half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+			remainder = mantissa & 0x1FFF;
+			halfway = 0x1000;
+		}
+		else // subnormal values shift the implicit bit into the mantissa
+		{
+			if (exponent < -10)
+			{
+				return (unsigned short)sign;
+			}
+			mantissa |= 0x800000;
+			int shift = 14 - exponent;
+			half = mantissa >> shift;
+			remainder = mantissa & ((1u << shift) - 1);
+			halfway = 1u << (shift - 1);
+		}
+		// ties are rounded to even, a carry into the exponent is still the correctly rounded value
+		if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+		{
+			++half;
+		}
+		return (unsigned short)(sign | half);
+	}
+
+	static inline float __unpackHalf(unsigned short half)
+	{
+		unsigned int sign = (unsigned int)(half & 0x8000) << 16;
+		unsigned int exponent = (half >> 10) & 0x1F;
+		unsigned int mantissa = half & 0x3FF;
+		unsigned int bits = sign;
+		if (exponent == 0x1F)
+		{
+			bits |= 0x7F800000 | (mantissa << 13);
+		}
+		else if (exponent > 0)
+		{
+			bits |= ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) // subnormal values are normal floats
+		{
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits |= (exponent << 23) | ((mantissa & 0x3FF) << 13);
+		}
+		float result = 0.0f;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	static inline unsigned short __packFixed(float value, float scale)
+	{
+		float scaled = value * scale;
+		if (scaled != scaled) // NaN
+		{
+			return 0;
+		}
+		scaled = hclamp(scaled, LITESER_FIXED_MIN, LITESER_FIXED_MAX);
+		return (unsigned short)(short)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+	}
+
+	void _packFloats(const float* values, unsigned short* packed, int count, int scale)
+	{
+		if (scale == 0)
+		{
+			for_iter (i, 0, count)
+			{
+				packed[i] = __packHalf(values[i]);
+			}
+			return;
+		}
+		float factor = (float)scale;
+		for_iter (i, 0, count)
+		{
+			packed[i] = __packFixed(values[i], factor);
+		}
+	}
+
+	void _unpackFloats(const unsigned short* packed, float* values, int count, int scale)
+	{
+		if (scale == 0)
+		{
+			for_iter (i, 0, count)
+			{
+				values[i] = __unpackHalf(packed[i]);
+			}
+			return;
+		}
+		// a multiplication is faster than a division in the loop
+		float factor = 1.0f / scale;
+		for_iter (i, 0, count)
+		{
+			values[i] = (float)(short)packed[i] * factor;
+		}
+	}
+
+}
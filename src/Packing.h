@@ -0,0 +1,27 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines the conversion of floats to and from 16 bit values.
+
+#ifndef LITESER_PACKING_H
+#define LITESER_PACKING_H
+
+namespace liteser
+{
+	/// @brief Converts floats to half precision floats or fixed point numbers.
+	/// @param[in] scale Scale of fixed point numbers, 0 for half precision floats.
+	/// @note Half precision floats are rounded to the nearest value, fixed point numbers are rounded and clamped to their range.
+	void _packFloats(const float* values, unsigned short* packed, int count, int scale);
+	/// @brief Converts half precision floats or fixed point numbers to floats.
+	/// @param[in] scale Scale of fixed point numbers, 0 for half precision floats.
+	void _unpackFloats(const unsigned short* packed, float* values, int count, int scale);
+
+}
+#endif
@@ -0,0 +1,248 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents a bounds-checked decoder of binary data in memory.
+
+#ifndef LITESER_READER_H
+#define LITESER_READER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <hltypes/hexception.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hstring.h>
+
+#include "Encoding.h"
+#include "liteserExport.h" // LITESER_BIG_ENDIAN
+// skipped data that a source supplies is requested in parts of this size
+#define LITESER_READER_SKIP_SIZE 65536
+
+namespace liteser
+{
+	class Reader;
+
+	/// @brief Supplies more data to a reader that only has a part of the data in memory at a time.
+	class ReaderSource
+	{
+	public:
+		virtual ~ReaderSource()
+		{
+		}
+
+		/// @brief Gives the reader new memory that starts with the bytes it did not consume yet.
+		/// @param[in] count Number of bytes that should be available, fewer are only available at the end of the data.
+		/// @return Whether any more data became available.
+		virtual bool fill(Reader& reader, int64_t count) = 0;
+		/// @brief Number of bytes that can still be supplied in addition to those that the reader has.
+		virtual int64_t remaining() = 0;
+
+	};
+
+	/// @brief Decodes values directly from a memory range without going through a stream.
+	/// @note The same encoding as in hsbase is used so data written by hsbase::dump() can be read.
+	/// @note If the reader has a source, memory returned by readInPlace() is only valid until the next value is read.
+	class Reader
+	{
+	public:
+		Reader() : data(NULL), position(NULL), end(NULL), source(NULL)
+		{
+		}
+
+		Reader(const unsigned char* data, int64_t size) : data(data), position(data), end(data + size), source(NULL)
+		{
+		}
+
+		Reader(ReaderSource* source) : data(NULL), position(NULL), end(NULL), source(source)
+		{
+		}
+
+		~Reader()
+		{
+		}
+
+		inline int64_t size() const { return (int64_t)(this->end - this->data); }
+		inline int64_t remaining() const { return (int64_t)(this->end - this->position); }
+		/// @brief Number of bytes that are left including those that the source has not supplied yet.
+		inline int64_t available() const { return (this->remaining() + (this->source != NULL ? this->source->remaining() : 0)); }
+		inline bool hasSource() const { return (this->source != NULL); }
+
+		inline char loadInt8()				{ return (char)*this->_advance(1); }
+		inline unsigned char loadUint8()	{ return *this->_advance(1); }
+		inline short loadInt16()			{ return this->_load<short>(); }
+		inline unsigned short loadUint16()	{ return this->_load<unsigned short>(); }
+		inline int loadInt32()				{ return this->_load<int>(); }
+		inline unsigned int loadUint32()	{ return this->_load<unsigned int>(); }
+		inline int64_t loadInt64()			{ return this->_load<int64_t>(); }
+		inline uint64_t loadUint64()		{ return this->_load<uint64_t>(); }
+		inline float loadFloat()			{ return this->_load<float>(); }
+		inline double loadDouble()			{ return this->_load<double>(); }
+		inline bool loadBool()				{ return (*this->_advance(1) != 0); }
+
+		/// @brief Loads an unsigned varint, bounds are only checked for every byte close to the end of the data.
+		inline uint64_t loadVarint()
+		{
+			// most values are small so single bytes are handled right away
+			if (this->position < this->end && *this->position < 0x80)
+			{
+				return *this->position++;
+			}
+			if (this->end - this->position < LITESER_VARINT_MAX_SIZE && this->source != NULL)
+			{
+				this->source->fill(*this, LITESER_VARINT_MAX_SIZE);
+			}
+			if (this->end - this->position < LITESER_VARINT_MAX_SIZE)
+			{
+				uint64_t result = 0;
+				this->position = _readVarint(this->position, this->end, &result);
+				return result;
+			}
+			uint64_t result = 0;
+			unsigned char byte = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				byte = *this->position;
+				++this->position;
+				result |= (uint64_t)(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+				{
+					return result;
+				}
+			}
+			throw Exception("Varint is longer than 64 bits!");
+		}
+
+		inline hstr loadString()
+		{
+			unsigned int size = this->loadUint32();
+			if (size == 0)
+			{
+				return hstr();
+			}
+			return hstr((const char*)this->_advance(size), (int)size);
+		}
+
+		/// @brief Copies raw bytes into a buffer.
+		/// @return Number of bytes copied, less than requested only if the data ended.
+		inline int readRaw(void* buffer, int count)
+		{
+			unsigned char* destination = (unsigned char*)buffer;
+			int copied = 0;
+			int size = 0;
+			while (true)
+			{
+				// large blocks are copied in parts so the source does not have to hold them at once
+				size = (int)hmin((int64_t)(count - copied), this->remaining());
+				if (size > 0)
+				{
+					memcpy(destination + copied, this->position, size);
+					this->position += size;
+					copied += size;
+				}
+				if (copied == count || this->source == NULL || !this->source->fill(*this, count - copied))
+				{
+					break;
+				}
+			}
+			return copied;
+		}
+
+		/// @brief Moves forward without decoding anything.
+		inline void skip(int64_t count)
+		{
+			int64_t size = 0;
+			while (count > this->remaining() && this->source != NULL)
+			{
+				// skipped data is dropped as it is supplied instead of being collected
+				size = this->remaining();
+				this->position = this->end;
+				count -= size;
+				this->_refill(hmin(count, (int64_t)LITESER_READER_SKIP_SIZE));
+			}
+			this->_advance(count);
+		}
+
+		/// @brief Moves forward and returns the skipped bytes without copying them.
+		inline const unsigned char* readInPlace(int64_t count)
+		{
+			return this->_advance(count);
+		}
+
+		/// @brief Continues decoding in new memory, used by sources.
+		inline void _reset(const unsigned char* data, int64_t size)
+		{
+			this->data = data;
+			this->position = data;
+			this->end = data + size;
+		}
+		/// @brief Gets the data that can be decoded without refilling, so it can be decoded directly by code outside of the reader.
+		inline void _getCursor(const unsigned char** current, const unsigned char** end) const
+		{
+			*current = this->position;
+			*end = this->end;
+		}
+		/// @brief Continues after data that was decoded directly.
+		inline void _setCursor(const unsigned char* current)
+		{
+			this->position = current;
+		}
+
+	protected:
+		const unsigned char* data;
+		const unsigned char* position;
+		const unsigned char* end;
+		ReaderSource* source;
+
+		inline const unsigned char* _advance(int64_t count)
+		{
+			if (count > (int64_t)(this->end - this->position))
+			{
+				this->_refill(count);
+			}
+			const unsigned char* result = this->position;
+			this->position += count;
+			return result;
+		}
+
+		void _refill(int64_t count)
+		{
+			if (this->source != NULL)
+			{
+				this->source->fill(*this, count);
+			}
+			if (count > (int64_t)(this->end - this->position))
+			{
+				throw Exception("Unexpected end of data!");
+			}
+		}
+
+		template <typename T>
+		inline T _load()
+		{
+			T result;
+			// memcpy, because the data is not aligned
+			memcpy(&result, this->_advance(sizeof(T)), sizeof(T));
+#ifdef LITESER_BIG_ENDIAN
+			unsigned char* bytes = (unsigned char*)&result;
+			unsigned char temp = 0;
+			for_iter (i, 0, (int)sizeof(T) / 2)
+			{
+				temp = bytes[i];
+				bytes[i] = bytes[sizeof(T) - 1 - i];
+				bytes[sizeof(T) - 1 - i] = temp;
+			}
+#endif
+			return result;
+		}
+
+	};
+
+}
+#endif
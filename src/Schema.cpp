@@ -0,0 +1,288 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <hltypes/harray.h>
+#include <hltypes/hlog.h>
+#include <hltypes/hmap.h>
+#include <hltypes/hmutex.h>
+#include <hltypes/hstring.h>
+
+#include "Context.h"
+#include "liteser.h"
+#include "Schema.h"
+#include "Serializable.h"
+#include "Type.h"
+#include "Utility.h"
+#include "Variable.h"
+
+#define LITESER_FINGERPRINT_BASIS 14695981039346656037ULL
+#define LITESER_FINGERPRINT_PRIME 1099511628211ULL
+
+namespace liteser
+{
+	// same approach as in Factory, because of the order of global var initializations
+	static hmap<hstr, Schema*>* __lsSchemas = NULL;
+	static hmutex __lsSchemasMutex;
+
+	Schema::Field::Field(chstr name, Type* type, int offset) :
+		type(type),
+		offset(offset)
+	{
+		this->name = name;
+	}
+
+	Schema::Field::~Field()
+	{
+		delete this->type;
+	}
+
+	Schema::Schema(chstr className, Serializable* object) :
+		fingerprint(LITESER_FINGERPRINT_BASIS),
+		codec(false),
+		slotMask(0)
+	{
+		this->className = className;
+		// the variable list is built only once per class, only the member offsets and types are kept
+		harray<Variable*> variables = object->_lsVars();
+		// LS_VARS marks every variable it creates with its position in the generated functions, variables that were added by hand are not marked
+		this->codec = (variables.size() == object->_lsVarCount());
+		int index = 0;
+		foreach (Variable*, it, variables)
+		{
+			if ((*it)->codecIndex != index)
+			{
+				this->codec = false;
+			}
+			++index;
+			this->fields += new Field((*it)->name, (*it)->type, (int)((char*)(*it)->value<char>() - (char*)object));
+			(*it)->type = NULL; // ownership of the type was taken over
+			delete (*it);
+		}
+		foreach (Field*, it, this->fields)
+		{
+			this->fingerprint = Schema::_fingerprint(this->fingerprint, (*it)->name, (*it)->type->identifier, (*it)->type->scale);
+		}
+		// the table is kept at most half full so probe sequences stay short
+		int fieldCount = this->fields.size();
+		int slotCount = 4;
+		while (slotCount < fieldCount * 2)
+		{
+			slotCount *= 2;
+		}
+		this->slotMask = (unsigned int)slotCount - 1;
+		this->slots.add(-1, slotCount);
+		unsigned int hash = 0;
+		unsigned int slot = 0;
+		for_iter (i, 0, fieldCount)
+		{
+			hash = Schema::_hash(this->fields[i]->name);
+			this->hashes += hash;
+			slot = hash & this->slotMask;
+			while (this->slots[slot] >= 0)
+			{
+				slot = (slot + 1) & this->slotMask;
+			}
+			this->slots[slot] = i;
+		}
+	}
+
+	Schema::~Schema()
+	{
+		foreach (Field*, it, this->fields)
+		{
+			delete (*it);
+		}
+	}
+
+	int Schema::indexOf(chstr name, int hint) const
+	{
+		if (hint >= 0 && hint < this->fields.size() && this->fields[hint]->name == name)
+		{
+			return hint;
+		}
+		unsigned int hash = Schema::_hash(name);
+		unsigned int slot = hash & this->slotMask;
+		int index = this->slots[slot];
+		while (index >= 0)
+		{
+			if (this->hashes[index] == hash && this->fields[index]->name == name)
+			{
+				return index;
+			}
+			slot = (slot + 1) & this->slotMask;
+			index = this->slots[slot];
+		}
+		return -1;
+	}
+
+	unsigned int Schema::_hash(chstr name)
+	{
+		// FNV-1a
+		unsigned int result = 2166136261u;
+		const unsigned char* data = (const unsigned char*)name.cStr();
+		int size = name.size();
+		for_iter (i, 0, size)
+		{
+			result = (result ^ data[i]) * 16777619u;
+		}
+		return result;
+	}
+
+	uint64_t Schema::_fingerprint(uint64_t fingerprint, chstr name, Type::Identifier identifier, int scale)
+	{
+		// FNV-1a over the name, a terminating zero, the type identifier and the scale of fixed point numbers
+		const unsigned char* data = (const unsigned char*)name.cStr();
+		int size = name.size();
+		for_iter (i, 0, size)
+		{
+			fingerprint = (fingerprint ^ data[i]) * LITESER_FINGERPRINT_PRIME;
+		}
+		fingerprint = (fingerprint ^ 0) * LITESER_FINGERPRINT_PRIME;
+		fingerprint = (fingerprint ^ identifier.value) * LITESER_FINGERPRINT_PRIME;
+		if (scale != 0) // layouts without fixed point numbers keep their fingerprints
+		{
+			for_iter (i, 0, 4)
+			{
+				fingerprint = (fingerprint ^ (((unsigned int)scale >> (i * 8)) & 0xFF)) * LITESER_FINGERPRINT_PRIME;
+			}
+		}
+		return fingerprint;
+	}
+
+	Schema* Schema::get(Serializable* object)
+	{
+		// registered classes are found by index without creating the class name
+		int classId = object->_lsClassId();
+		Schema* schema = NULL;
+		if (classId >= 0)
+		{
+			if (_context == NULL)
+			{
+				return Schema::_get(object->_lsName(), object);
+			}
+			harray<Schema*>& classSchemas = _context->classSchemas;
+			if (classId < classSchemas.size() && classSchemas[classId] != NULL)
+			{
+				return classSchemas[classId];
+			}
+			schema = Schema::_get(object->_lsName(), object);
+			if (classId >= classSchemas.size())
+			{
+				classSchemas.add((Schema*)NULL, classId + 1 - classSchemas.size());
+			}
+			classSchemas[classId] = schema;
+			return schema;
+		}
+		hstr className = object->_lsName();
+		if (_context == NULL)
+		{
+			return Schema::_get(className, object);
+		}
+		schema = _context->schemas.tryGet(className, NULL);
+		if (schema == NULL)
+		{
+			schema = Schema::_get(className, object);
+			_context->schemas[className] = schema;
+		}
+		return schema;
+	}
+
+	Schema* Schema::_get(chstr className, Serializable* object)
+	{
+		Schema* schema = NULL;
+		hmutex::ScopeLock lock(&__lsSchemasMutex);
+		if (__lsSchemas == NULL)
+		{
+			__lsSchemas = new hmap<hstr, Schema*>();
+		}
+		schema = __lsSchemas->tryGet(className, NULL);
+		if (schema == NULL)
+		{
+			schema = new Schema(className, object);
+			__lsSchemas->operator[](className) = schema;
+		}
+		return schema;
+	}
+
+	StoredSchema::StoredSchema(chstr className) :
+		fingerprint(0),
+		schema(NULL),
+		identical(false)
+	{
+		this->className = className;
+		this->classId = Factory::getClassId(className);
+	}
+
+	StoredSchema::~StoredSchema()
+	{
+	}
+
+	void StoredSchema::map(Schema* schema)
+	{
+		this->schema = schema;
+		this->indices.clear();
+		int fieldCount = schema->fields.size();
+		this->identical = (this->fingerprint == schema->fingerprint && this->names.size() == fieldCount);
+		if (this->identical)
+		{
+			for_iter (i, 0, fieldCount)
+			{
+				this->indices += i;
+			}
+			return;
+		}
+		harray<unsigned char> mapped;
+		mapped.add(0, fieldCount);
+		harray<hstr> missingVariableNames;
+		Schema::Field* field = NULL;
+		int index = -1;
+		for_iter (i, 0, this->names.size())
+		{
+			index = schema->indexOf(this->names[i], i);
+			if (index >= 0 && mapped[index] != 0)
+			{
+				index = -1;
+			}
+			if (index >= 0)
+			{
+				field = schema->fields[index];
+				if (field->type->identifier != this->identifiers[i] || field->type->scale != this->scales[i])
+				{
+					if (!_isCompatibleType(field->type->identifier, this->identifiers[i]))
+					{
+						throw Exception(hsprintf("Variable type of '%s' has changed. Expected: %02X, Got: %02X", field->name.cStr(), field->type->identifier.value, this->identifiers[i].value));
+					}
+					hlog::warn(logTag, "Using compatible type for: " + field->name);
+				}
+				mapped[index] = 1;
+			}
+			else
+			{
+				missingVariableNames += this->names[i];
+			}
+			this->indices += index;
+		}
+		if (missingVariableNames.size() > 0)
+		{
+			hlog::warn(logTag, this->className + " - Variables not part of class definition: " + missingVariableNames.joined(','));
+		}
+		harray<hstr> names;
+		for_iter (i, 0, fieldCount)
+		{
+			if (mapped[i] == 0)
+			{
+				names += schema->fields[i]->name;
+			}
+		}
+		if (names.size() > 0)
+		{
+			hlog::warn(logTag, this->className + " - Not all variables were previously saved: " + names.joined(',').cStr());
+		}
+	}
+
+}
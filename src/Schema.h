@@ -0,0 +1,112 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents a cached serialization plan of a class.
+
+#ifndef LITESER_SCHEMA_H
+#define LITESER_SCHEMA_H
+
+#include <stdint.h>
+
+#include <hltypes/harray.h>
+#include <hltypes/hstring.h>
+
+#include "Type.h"
+
+namespace liteser
+{
+	class Serializable;
+
+	class Schema
+	{
+	public:
+		class Field
+		{
+		public:
+			hstr name;
+			Type* type;
+			/// @brief Byte offset of the member from the Serializable pointer of the object.
+			int offset;
+
+			Field(chstr name, Type* type, int offset);
+			~Field();
+
+			inline void* address(Serializable* object) const { return ((char*)object + this->offset); }
+
+		};
+
+		hstr className;
+		harray<Field*> fields;
+		/// @brief FNV-1a hash over all field names, type identifiers and fixed point scales in declaration order.
+		uint64_t fingerprint;
+		/// @brief Whether the fields are exactly the variables that the functions generated by LS_VARS handle, in the same order.
+		bool codec;
+
+		~Schema();
+
+		/// @brief Finds a field by name.
+		/// @param[in] name Name of the field.
+		/// @param[in] hint Index where the field is expected, files usually store fields in declaration order.
+		/// @return Index of the field or -1 if the class does not have it.
+		int indexOf(chstr name, int hint = -1) const;
+
+		/// @brief Gets the cached plan for the object's class and creates it on first use.
+		/// @note Classes are identified by _lsClassId() or _lsName() so every class with its own LS_VARS needs its own LS_CLASS_DECLARE.
+		static Schema* get(Serializable* object);
+
+	protected:
+		/// @brief Open addressing table of field indices, -1 marks empty slots.
+		harray<int> slots;
+		/// @brief Hashes of field names, used to avoid string compares on slot collisions.
+		harray<unsigned int> hashes;
+		unsigned int slotMask;
+
+		Schema(chstr className, Serializable* object);
+
+		/// @brief Gets the plan from the global cache which is shared by all threads.
+		static Schema* _get(chstr className, Serializable* object);
+		static unsigned int _hash(chstr name);
+
+	public:
+		/// @brief Adds a field to a layout fingerprint.
+		static uint64_t _fingerprint(uint64_t fingerprint, chstr name, Type::Identifier identifier, int scale);
+
+	};
+
+	/// @brief Field layout of a class as it was written once into a stream's schema table.
+	class StoredSchema
+	{
+	public:
+		hstr className;
+		/// @brief ID of the class in the Factory, looked up once per stream, -1 if the class is not registered.
+		int classId;
+		uint64_t fingerprint;
+		harray<hstr> names;
+		harray<Type::Identifier> identifiers;
+		/// @brief Scale of every stored fixed point field, 0 for all other fields.
+		harray<int> scales;
+		/// @brief The class schema the stored fields are currently mapped to.
+		Schema* schema;
+		/// @brief Index of the matching schema field for every stored field, -1 if the class does not have it.
+		harray<int> indices;
+		/// @brief Whether the stored layout is the same as the compiled one so variables can be loaded without any checks.
+		bool identical;
+
+		StoredSchema(chstr className);
+		~StoredSchema();
+
+		/// @brief Maps the stored fields onto the fields of a class schema.
+		/// @note Missing fields, unsaved fields and compatible types are reported once per stream instead of once per object.
+		void map(Schema* schema);
+
+	};
+
+}
+#endif
@@ -7,196 +7,915 @@
 /// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
 
 #include <stdint.h>
+#include <string.h>
 
 #include <gtypes/Rectangle.h>
 #include <gtypes/Vector2.h>
 #include <gtypes/Vector3.h>
 #include <hltypes/harray.h>
+#include <hltypes/hltypesUtil.h>
 #include <hltypes/hmap.h>
 #include <hltypes/hsbase.h>
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Context.h"
+#include "Encoding.h"
+#include "IdMap.h"
+#include "Lazy.h"
+#include "LazyScope.h"
 #include "liteser.h"
+#include "Packing.h"
+#include "Schema.h"
 #include "Serializable.h"
 #include "Serialize.h"
+#include "Snapshot.h"
 #include "Type.h"
+#include "TypeTable.h"
 #include "Utility.h"
-#include "Variable.h"
 
 namespace liteser
 {
-	void _dumpType(Type::Identifier identifier)
-	{
-		stream->dump((unsigned char)identifier.value);
-	}
-
-	inline void __dumpVariable(Variable* variable)
-	{
-		if (variable->type->identifier == Type::Identifier::Int8)				stream->dump(*variable->value<char>());
-		else if (variable->type->identifier == Type::Identifier::UInt8)			stream->dump(*variable->value<unsigned char>());
-		else if (variable->type->identifier == Type::Identifier::Int16)			stream->dump(*variable->value<short>());
-		else if (variable->type->identifier == Type::Identifier::UInt16)		stream->dump(*variable->value<unsigned short>());
-		else if (variable->type->identifier == Type::Identifier::Int32)			stream->dump(*variable->value<int>());
-		else if (variable->type->identifier == Type::Identifier::UInt32)		stream->dump(*variable->value<unsigned int>());
-		else if (variable->type->identifier == Type::Identifier::Int64)			stream->dump(*variable->value<int64_t>());
-		else if (variable->type->identifier == Type::Identifier::UInt64)		stream->dump(*variable->value<uint64_t>());
-		else if (variable->type->identifier == Type::Identifier::Float)			stream->dump(*variable->value<float>());
-		else if (variable->type->identifier == Type::Identifier::Double)		stream->dump(*variable->value<double>());
-		else if (variable->type->identifier == Type::Identifier::Bool)			stream->dump(*variable->value<bool>());
-		else if (variable->type->identifier == Type::Identifier::Hstr)			_dump(variable->value<hstr>());
-		else if (variable->type->identifier == Type::Identifier::Hversion)		_dump(variable->value<hversion>());
-		else if (variable->type->identifier == Type::Identifier::Henum)			_dump(variable->value<henum>());
-		else if (variable->type->identifier == Type::Identifier::Grectf)		_dump(variable->value<grectf>());
-		else if (variable->type->identifier == Type::Identifier::Gvec2f)		_dump(variable->value<gvec2f>());
-		else if (variable->type->identifier == Type::Identifier::Gvec3f)		_dump(variable->value<gvec3f>());
-		else if (variable->type->identifier == Type::Identifier::Grecti)		_dump(variable->value<grecti>());
-		else if (variable->type->identifier == Type::Identifier::Gvec2i)		_dump(variable->value<gvec2i>());
-		else if (variable->type->identifier == Type::Identifier::Gvec3i)		_dump(variable->value<gvec3i>());
-		else if (variable->type->identifier == Type::Identifier::Grectd)		_dump(variable->value<grectd>());
-		else if (variable->type->identifier == Type::Identifier::Gvec2d)		_dump(variable->value<gvec2d>());
-		else if (variable->type->identifier == Type::Identifier::Gvec3d)		_dump(variable->value<gvec3d>());
-		else if (variable->type->identifier == Type::Identifier::ValueObject)	_dump(variable->value<Serializable>());
-		else if (variable->type->identifier == Type::Identifier::Object)		_dump(variable->value<Serializable*>());
-		else if (variable->type->identifier == Type::Identifier::Harray)		__dumpContainer(variable);
-		else if (variable->type->identifier == Type::Identifier::Hmap)			__dumpContainer(variable);
-	}
-
-	void __dumpContainer(Variable* variable)
-	{
-		stream->dump(variable->containerSize);
-		if (variable->containerSize > 0)
-		{
-			stream->dump((unsigned int)variable->type->subTypes.size());
-			foreach (Type*, it, variable->type->subTypes)
+	void _dumpType(Type::Identifier identifier, int scale)
+	{
+		_context->writer.dump((unsigned char)identifier.value);
+		// data written with another scale is converted when it is loaded
+		if (_isFixedPoint(identifier))
+		{
+			_dumpCount((unsigned int)scale);
+		}
+	}
+
+	typedef void (*DumpFunction)(void*, Type*);
+
+	template <typename T>
+	static void __dumpTyped(void* value, Type*)
+	{
+		_dump((T*)value);
+	}
+
+	static void __dumpNothing(void*, Type*)
+	{
+	}
+
+	/// @brief Packed values are converted component by component, the number of components follows from their size.
+	static void __dumpPacked(void* value, Type* type)
+	{
+		unsigned short packed[4];
+		int count = _getFixedSize(type->identifier) / (int)sizeof(unsigned short);
+		_packFloats((float*)value, packed, count, type->scale);
+		for_iter (i, 0, count)
+		{
+			_context->writer.dump(packed[i]);
+		}
+	}
+
+	class ValueDumpers : public DispatchTable<DumpFunction>
+	{
+	public:
+		ValueDumpers() : DispatchTable<DumpFunction>(&__dumpNothing)
+		{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpTyped<type>);
+			LITESER_VALUE_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpPacked);
+			LITESER_PACKED_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpTyped<type>);
+			LITESER_SERIES_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+			this->set(Type::Identifier::Harray, &__dumpContainer);
+			this->set(Type::Identifier::Hmap, &__dumpContainer);
+		}
+
+	};
+
+	inline void __dumpValue(void* value, Type* type)
+	{
+		const ValueDumpers& dumpers = _getTable<ValueDumpers>();
+		dumpers.get(type->identifier)(value, type);
+	}
+
+	inline void __dumpRaw(void* data, int elementSize, int count)
+	{
+		unsigned char* bytes = (unsigned char*)data;
+		int size = elementSize * count;
+#ifndef LITESER_BIG_ENDIAN
+		_context->writer.writeRaw(bytes, size);
+#else
+		unsigned char block[LITESER_RAW_BLOCK_SIZE];
+		int blockSize = 0;
+		while (size > 0)
+		{
+			blockSize = hmin(size, LITESER_RAW_BLOCK_SIZE / elementSize * elementSize);
+			memcpy(block, bytes, blockSize);
+			_swapBytes(block, elementSize, blockSize / elementSize);
+			_context->writer.writeRaw(block, blockSize);
+			bytes += blockSize;
+			size -= blockSize;
+		}
+#endif
+	}
+
+	/// @brief Converts packed values in blocks so large containers are written without a call for every component.
+	inline void __dumpPackedRaw(float* values, int count, int scale)
+	{
+		unsigned short block[LITESER_RAW_BLOCK_SIZE / sizeof(unsigned short)];
+		int blockCount = LITESER_RAW_BLOCK_SIZE / sizeof(unsigned short);
+		int size = 0;
+		for (int i = 0; i < count; i += size)
+		{
+			size = hmin(count - i, blockCount);
+			_packFloats(&values[i], block, size, scale);
+			__dumpRaw(block, sizeof(unsigned short), size);
+		}
+	}
+
+	/// @brief Reserves the prefix of a block that allows skipping it without decoding it.
+	inline int64_t __beginBlock(int* objectCount, int* registrationCount)
+	{
+		*objectCount = _context->objectIds->size();
+		*registrationCount = _context->stringIds->size() + _context->schemaIds.size() + _context->lazyCount;
+		int64_t position = _context->writer.reserveUint32();
+		_context->writer.reserveUint32();
+		return position;
+	}
+
+	inline void __endBlock(int64_t position, int objectCount, int registrationCount)
+	{
+		int64_t size = _context->writer.position() - position - LITESER_BLOCK_PREFIX_SIZE;
+		if (size >= LITESER_BLOCK_REGISTERS)
+		{
+			throw Exception("Block is too large to be prefixed with its size!");
+		}
+		unsigned int prefix = (unsigned int)size;
+		// lazy objects are counted so objects after them can reference what was written within them
+		if (_context->stringIds->size() + _context->schemaIds.size() + _context->lazyCount > registrationCount)
+		{
+			prefix |= LITESER_BLOCK_REGISTERS;
+		}
+		_context->writer.patchUint32(position, prefix);
+		_context->writer.patchUint32(position + sizeof(unsigned int), (unsigned int)(_context->objectIds->size() - objectCount));
+	}
+
+	template <typename T>
+	inline void __dumpElements(harray<T>* value)
+	{
+		int size = value->size();
+		for_iter (i, 0, size)
+		{
+			_dump(&value->operator[](i));
+		}
+	}
+
+	/// @brief Gets at least the given number of bytes from the scratch memory of the call, it is only valid until the next call.
+	inline unsigned char* __getScratch(int size)
+	{
+		harray<unsigned char>& scratch = _context->scratch;
+		if (scratch.size() < size)
+		{
+			scratch.add((unsigned char)0, size - scratch.size());
+		}
+		return &scratch[0];
+	}
+
+	/// @brief Writes integers with the encoding that is expected to take the least space, prefixed with their size so they can be skipped.
+	/// @param[in] data Memory for the encoded values that can hold at least as many bytes as the raw values.
+	template <typename T>
+	inline void __dumpEncoded(T* values, int count, unsigned char* data)
+	{
+		int rawSize = count * (int)sizeof(T);
+		unsigned char encoding = _chooseEncoding(values, count);
+		if (encoding != LITESER_ENCODING_RAW)
+		{
+			// encodings that end up larger than the raw values are dropped
+			unsigned char* end = _encodeIntegers(encoding, values, count, data, data + rawSize);
+			if (end != NULL)
+			{
+				int size = (int)(end - data);
+				_context->writer.dump(encoding);
+				_dumpCount((unsigned int)size);
+				_context->writer.writeRaw(data, size);
+				return;
+			}
+		}
+		_context->writer.dump((unsigned char)LITESER_ENCODING_RAW);
+		_dumpCount((unsigned int)rawSize);
+		__dumpRaw(values, sizeof(T), count);
+	}
+
+	template <typename T>
+	inline void __dumpEncoded(harray<T>* value)
+	{
+		__dumpEncoded(&value->operator[](0), value->size(), __getScratch(value->size() * (int)sizeof(T)));
+	}
+
+#define DEFINE_DUMP_ELEMENTS_RAW(type) \
+	inline void __dumpElements(harray<type>* value) \
+	{ \
+		__dumpRaw(&value->operator[](0), sizeof(type), value->size()); \
+	}
+
+#define DEFINE_DUMP_ELEMENTS_INTEGER(type) \
+	inline void __dumpElements(harray<type>* value) \
+	{ \
+		if (_context->header.encodedArrays) \
+		{ \
+			__dumpEncoded(value); \
+		} \
+		else \
+		{ \
+			__dumpRaw(&value->operator[](0), sizeof(type), value->size()); \
+		} \
+	}
+
+// compact data stores every element as a varint unless the array is encoded
+#define DEFINE_DUMP_ELEMENTS_VARINT(type) \
+	inline void __dumpElements(harray<type>* value) \
+	{ \
+		if (_context->header.encodedArrays) \
+		{ \
+			__dumpEncoded(value); \
+		} \
+		else if (_context->header.compactIntegers) \
+		{ \
+			int size = value->size(); \
+			for_iter (i, 0, size) \
+			{ \
+				_dump(&value->operator[](i)); \
+			} \
+		} \
+		else \
+		{ \
+			__dumpRaw(&value->operator[](0), sizeof(type), value->size()); \
+		} \
+	}
+
+	DEFINE_DUMP_ELEMENTS_INTEGER(char);
+	DEFINE_DUMP_ELEMENTS_INTEGER(unsigned char);
+	DEFINE_DUMP_ELEMENTS_VARINT(short);
+	DEFINE_DUMP_ELEMENTS_VARINT(unsigned short);
+	DEFINE_DUMP_ELEMENTS_VARINT(int);
+	DEFINE_DUMP_ELEMENTS_VARINT(unsigned int);
+	DEFINE_DUMP_ELEMENTS_VARINT(int64_t);
+	DEFINE_DUMP_ELEMENTS_VARINT(uint64_t);
+	DEFINE_DUMP_ELEMENTS_RAW(float);
+	DEFINE_DUMP_ELEMENTS_RAW(double);
+
+	inline void __dumpElements(harray<hstr>* value)
+	{
+		int size = value->size();
+		if (_context->header.stringPooling)
+		{
+			_context->stringIds->reserve(_context->stringIds->size() + size);
+		}
+		for_iter (i, 0, size)
+		{
+			_dump(&value->operator[](i));
+		}
+	}
+
+	inline void __dumpElements(harray<Serializable*>* value)
+	{
+		int size = value->size();
+		if (_context->header.allowMultiReferencing)
+		{
+			_context->objectIds->reserve(_context->objectIds->size() + size);
+		}
+		for_iter (i, 0, size)
+		{
+			_dump(&value->operator[](i));
+		}
+	}
+
+	template <typename T>
+	inline void __dumpHarray(harray<T>* value, Type::Identifier subIdentifier)
+	{
+		int size = value->size();
+		_dumpCount((unsigned int)size);
+		if (size > 0)
+		{
+			_dumpCount(1u);
+			_dumpType(subIdentifier);
+			// containers of values with a fixed size can be skipped without a prefix
+			if (_hasBlockPrefix(subIdentifier))
 			{
-				_dumpType((*it)->identifier);
+				int objectCount = 0;
+				int registrationCount = 0;
+				int64_t position = __beginBlock(&objectCount, &registrationCount);
+				__dumpElements(value);
+				__endBlock(position, objectCount, registrationCount);
 			}
-			foreach (Variable*, it, variable->subVariables)
+			else
 			{
-				__dumpVariable(*it);
+				__dumpElements(value);
 			}
 		}
 	}
 
+	template <typename K, typename V>
+	inline void __dumpKeys(hmap<K, V>* value)
+	{
+		for (typename hmap<K, V>::iterator it = value->begin(); it != value->end(); ++it)
+		{
+			_dump((K*)&it->first);
+		}
+	}
+
+	template <typename K, typename V>
+	inline void __dumpValues(hmap<K, V>* value)
+	{
+		for (typename hmap<K, V>::iterator it = value->begin(); it != value->end(); ++it)
+		{
+			_dump(&it->second);
+		}
+	}
+
+// encoded integers are gathered in the scratch memory while iterating, the encoded data is written behind them
+#define DEFINE_DUMP_ENTRIES_ENCODED(type) \
+	template <typename V> \
+	inline void __dumpKeys(hmap<type, V>* value) \
+	{ \
+		if (!_context->header.encodedArrays) \
+		{ \
+			for (typename hmap<type, V>::iterator it = value->begin(); it != value->end(); ++it) \
+			{ \
+				_dump((type*)&it->first); \
+			} \
+			return; \
+		} \
+		int rawSize = value->size() * (int)sizeof(type); \
+		type* keys = (type*)__getScratch(rawSize * 2); \
+		int count = 0; \
+		for (typename hmap<type, V>::iterator it = value->begin(); it != value->end(); ++it) \
+		{ \
+			keys[count++] = it->first; \
+		} \
+		__dumpEncoded(keys, count, (unsigned char*)keys + rawSize); \
+	} \
+	\
+	template <typename K> \
+	inline void __dumpValues(hmap<K, type>* value) \
+	{ \
+		if (!_context->header.encodedArrays) \
+		{ \
+			for (typename hmap<K, type>::iterator it = value->begin(); it != value->end(); ++it) \
+			{ \
+				_dump(&it->second); \
+			} \
+			return; \
+		} \
+		int rawSize = value->size() * (int)sizeof(type); \
+		type* values = (type*)__getScratch(rawSize * 2); \
+		int count = 0; \
+		for (typename hmap<K, type>::iterator it = value->begin(); it != value->end(); ++it) \
+		{ \
+			values[count++] = it->second; \
+		} \
+		__dumpEncoded(values, count, (unsigned char*)values + rawSize); \
+	}
+
+	DEFINE_DUMP_ENTRIES_ENCODED(char);
+	DEFINE_DUMP_ENTRIES_ENCODED(unsigned char);
+	DEFINE_DUMP_ENTRIES_ENCODED(short);
+	DEFINE_DUMP_ENTRIES_ENCODED(unsigned short);
+	DEFINE_DUMP_ENTRIES_ENCODED(int);
+	DEFINE_DUMP_ENTRIES_ENCODED(unsigned int);
+	DEFINE_DUMP_ENTRIES_ENCODED(int64_t);
+	DEFINE_DUMP_ENTRIES_ENCODED(uint64_t);
+
+	template <typename K, typename V>
+	inline void __dumpHmap(hmap<K, V>* value, Type* type)
+	{
+		int size = value->size();
+		_dumpCount((unsigned int)size);
+		if (size > 0)
+		{
+			_dumpCount(2u);
+			_dumpType(type->subTypes[0]->identifier, type->subTypes[0]->scale);
+			_dumpType(type->subTypes[1]->identifier, type->subTypes[1]->scale);
+			// keys and values are stored as two separate harrays
+			_dumpCount((unsigned int)size);
+			_dumpCount(1u);
+			_dumpType(type->subTypes[0]->identifier, type->subTypes[0]->scale);
+			int objectCount = 0;
+			int registrationCount = 0;
+			int64_t position = 0;
+			int mappedCount = _context->objectIds->size();
+			bool prefixed = _hasBlockPrefix(type->subTypes[0]->identifier);
+			if (prefixed)
+			{
+				position = __beginBlock(&objectCount, &registrationCount);
+			}
+			__dumpKeys(value);
+			if (prefixed)
+			{
+				__endBlock(position, objectCount, registrationCount);
+			}
+			_dumpCount((unsigned int)size);
+			_dumpCount(1u);
+			_dumpType(type->subTypes[1]->identifier, type->subTypes[1]->scale);
+			prefixed = _hasBlockPrefix(type->subTypes[1]->identifier);
+			if (prefixed)
+			{
+				position = __beginBlock(&objectCount, &registrationCount);
+			}
+			__dumpValues(value);
+			if (prefixed)
+			{
+				__endBlock(position, objectCount, registrationCount);
+			}
+			// objects are sorted by their address so IDs of objects that are first found here would differ in every process
+			if (_context->referencesOnly && type->subTypes[0]->identifier == Type::Identifier::Object && _context->objectIds->size() > mappedCount + 1)
+			{
+				throw Exception("Objects that are first referenced from an hmap with object keys cannot be used in a snapshot!");
+			}
+		}
+	}
+
+	static void __dumpUnsupportedHarray(void*, Type* type)
+	{
+		throw Exception(hsprintf("Subtype is not supported within harray: %02X", type->subTypes[0]->identifier.value));
+	}
+
+	static void __dumpUnsupportedHmap(void*, Type* type)
+	{
+		throw Exception(hsprintf("Subtype is not supported within hmap: %02X %02X", type->subTypes[0]->identifier.value, type->subTypes[1]->identifier.value));
+	}
+
+	template <typename T>
+	static void __dumpHarrayTyped(void* value, Type* type)
+	{
+		__dumpHarray((harray<T>*)value, type->subTypes[0]->identifier);
+	}
+
+	/// @brief Harrays of packed values are accessed as harrays of the wrapped type since they have the same layout.
+	template <typename T>
+	static void __dumpPackedHarrayTyped(void* value, Type* type)
+	{
+		harray<T>* elements = (harray<T>*)value;
+		Type* subType = type->subTypes[0];
+		int size = elements->size();
+		_dumpCount((unsigned int)size);
+		if (size > 0)
+		{
+			_dumpCount(1u);
+			_dumpType(subType->identifier, subType->scale);
+			__dumpPackedRaw((float*)&elements->operator[](0), size * (int)(sizeof(T) / sizeof(float)), subType->scale);
+		}
+	}
+
+	/// @brief Harrays of samples are encoded as a whole and prefixed with their size so they can be skipped.
+	template <typename T>
+	static void __dumpSeriesHarrayTyped(void* value, Type* type)
+	{
+		harray<T>* elements = (harray<T>*)value;
+		int size = elements->size();
+		_dumpCount((unsigned int)size);
+		if (size > 0)
+		{
+			_dumpCount(1u);
+			_dumpType(type->subTypes[0]->identifier);
+			unsigned char* data = __getScratch(_getMaxSeriesSize(size, sizeof(T)));
+			int dataSize = _encodeSeries(&elements->operator[](0), size, data);
+			_dumpCount((unsigned int)dataSize);
+			_context->writer.writeRaw(data, dataSize);
+		}
+	}
+
+	template <typename K, typename V>
+	static void __dumpHmapTyped(void* value, Type* type)
+	{
+		__dumpHmap((hmap<K, V>*)value, type);
+	}
+
+	class HarrayDumpers : public DispatchTable<DumpFunction>
+	{
+	public:
+		HarrayDumpers() : DispatchTable<DumpFunction>(&__dumpUnsupportedHarray)
+		{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpHarrayTyped<type>);
+			LITESER_ELEMENT_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpPackedHarrayTyped<type>);
+			LITESER_PACKED_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpSeriesHarrayTyped<type>);
+			LITESER_SERIES_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+		}
+
+	};
+
+	template <typename K>
+	class HmapDumpers : public DispatchTable<DumpFunction>
+	{
+	public:
+		HmapDumpers() : DispatchTable<DumpFunction>(&__dumpUnsupportedHmap)
+		{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpHmapTyped<K, type>);
+			LITESER_ELEMENT_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+		}
+
+	};
+
+	template <typename K>
+	static void __dumpHmapKey(void* value, Type* type)
+	{
+		const HmapDumpers<K>& dumpers = _getTable<HmapDumpers<K> >();
+		dumpers.get(type->subTypes[1]->identifier)(value, type);
+	}
+
+	class HmapKeyDumpers : public DispatchTable<DumpFunction>
+	{
+	public:
+		HmapKeyDumpers() : DispatchTable<DumpFunction>(&__dumpUnsupportedHmap)
+		{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpHmapKey<type>);
+			LITESER_KEY_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+		}
+
+	};
+
+	void __dumpContainer(void* value, Type* type)
+	{
+		if (type->identifier == Type::Identifier::Harray)
+		{
+			const HarrayDumpers& dumpers = _getTable<HarrayDumpers>();
+			dumpers.get(type->subTypes[0]->identifier)(value, type);
+		}
+		else if (type->identifier == Type::Identifier::Hmap)
+		{
+			const HmapKeyDumpers& dumpers = _getTable<HmapKeyDumpers>();
+			dumpers.get(type->subTypes[0]->identifier)(value, type);
+		}
+	}
+
+	/// @brief Signed integers are stored zigzag encoded in compact data so small negative values take a single byte as well.
+	template <typename T>
+	inline void __dumpSigned(T value)
+	{
+		if (_context->header.compactIntegers)
+		{
+			_context->writer.dumpVarint(_zigzag((int64_t)value));
+		}
+		else
+		{
+			_context->writer.dump(value);
+		}
+	}
+
+	template <typename T>
+	inline void __dumpUnsigned(T value)
+	{
+		if (_context->header.compactIntegers)
+		{
+			_context->writer.dumpVarint((uint64_t)value);
+		}
+		else
+		{
+			_context->writer.dump(value);
+		}
+	}
+
+	inline void __dumpString(chstr value)
+	{
+		unsigned int size = value.size();
+		_dumpCount(size);
+		if (size > 0)
+		{
+			_context->writer.writeRaw(value.cStr(), (int)size);
+		}
+	}
+
+	void _dump(char* value)
+	{
+		_context->writer.dump(*value);
+	}
+
+	void _dump(unsigned char* value)
+	{
+		_context->writer.dump(*value);
+	}
+
+	void _dump(short* value)
+	{
+		__dumpSigned(*value);
+	}
+
+	void _dump(unsigned short* value)
+	{
+		__dumpUnsigned(*value);
+	}
+
+	void _dump(int* value)
+	{
+		__dumpSigned(*value);
+	}
+
+	void _dump(unsigned int* value)
+	{
+		__dumpUnsigned(*value);
+	}
+
+	void _dump(int64_t* value)
+	{
+		__dumpSigned(*value);
+	}
+
+	void _dump(uint64_t* value)
+	{
+		__dumpUnsigned(*value);
+	}
+
+	void _dump(float* value)
+	{
+		_context->writer.dump(*value);
+	}
+
+	void _dump(double* value)
+	{
+		_context->writer.dump(*value);
+	}
+
+	void _dump(bool* value)
+	{
+		_context->writer.dump(*value);
+	}
+
 	void _dump(hstr* value)
 	{
 		unsigned int id = 0;
-		if (!_currentHeader.stringPooling)
+		if (!_context->header.stringPooling)
 		{
-			stream->dump(*value);
+			__dumpString(*value);
 		}
-		else if (__tryMapString(&id, *value))
+		else if (__tryMapString(&id, *value) && !_context->header.indexed) // indexed data keeps all strings in a shared table
 		{
-			stream->dump(id);
-			stream->dump(*value);
+			_dumpCount(id);
+			__dumpString(*value);
 		}
 		else
 		{
-			stream->dump(id);
+			_dumpCount(id);
 		}
 	}
 
 	void _dump(hversion* value)
 	{
-		stream->dump(value->major);
-		stream->dump(value->minor);
-		stream->dump(value->revision);
-		stream->dump(value->build);
+		__dumpUnsigned(value->major);
+		__dumpUnsigned(value->minor);
+		__dumpUnsigned(value->revision);
+		__dumpUnsigned(value->build);
 	}
 
 	void _dump(henum* value)
 	{
-		stream->dump(value->value);
+		__dumpUnsigned(value->value);
 	}
 
 	void _dump(grectf* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
-		stream->dump(value->w);
-		stream->dump(value->h);
+		_context->writer.dump(value->x);
+		_context->writer.dump(value->y);
+		_context->writer.dump(value->w);
+		_context->writer.dump(value->h);
 	}
 
 	void _dump(gvec2f* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
+		_context->writer.dump(value->x);
+		_context->writer.dump(value->y);
 	}
 
 	void _dump(gvec3f* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
-		stream->dump(value->z);
+		_context->writer.dump(value->x);
+		_context->writer.dump(value->y);
+		_context->writer.dump(value->z);
 	}
 
 	void _dump(grecti* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
-		stream->dump(value->w);
-		stream->dump(value->h);
+		__dumpSigned(value->x);
+		__dumpSigned(value->y);
+		__dumpSigned(value->w);
+		__dumpSigned(value->h);
 	}
 
 	void _dump(gvec2i* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
+		__dumpSigned(value->x);
+		__dumpSigned(value->y);
 	}
 
 	void _dump(gvec3i* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
-		stream->dump(value->z);
+		__dumpSigned(value->x);
+		__dumpSigned(value->y);
+		__dumpSigned(value->z);
 	}
 
 	void _dump(grectd* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
-		stream->dump(value->w);
-		stream->dump(value->h);
+		_context->writer.dump(value->x);
+		_context->writer.dump(value->y);
+		_context->writer.dump(value->w);
+		_context->writer.dump(value->h);
 	}
 
 	void _dump(gvec2d* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
+		_context->writer.dump(value->x);
+		_context->writer.dump(value->y);
 	}
 
 	void _dump(gvec3d* value)
 	{
-		stream->dump(value->x);
-		stream->dump(value->y);
-		stream->dump(value->z);
+		_context->writer.dump(value->x);
+		_context->writer.dump(value->y);
+		_context->writer.dump(value->z);
+	}
+
+	inline void __dumpSchemaLayout(Schema* schema)
+	{
+		_dump(&schema->className);
+		_context->writer.dump(schema->fingerprint);
+		_dumpCount((unsigned int)schema->fields.size());
+		foreach (Schema::Field*, it, schema->fields)
+		{
+			_dump(&(*it)->name);
+			_dumpType((*it)->type->identifier, (*it)->type->scale);
+		}
+	}
+
+	/// @brief Objects that belong to another element of indexed data are written as a reference to that element.
+	inline bool __tryDumpElementReference(Serializable* value)
+	{
+		if (value == NULL)
+		{
+			return false;
+		}
+		uint64_t reference = _context->elementReferences.tryGet(value, 0);
+		if (reference == 0) // the first occurrence decides which element the object belongs to
+		{
+			_context->elementReferences[value] = __makeElementReference(_context->element, _context->objectIds->size() + 1);
+			return false;
+		}
+		if ((int)(reference >> 32) == _context->element)
+		{
+			return false;
+		}
+		unsigned int schemaId = 0;
+		__tryMapSchema(&schemaId, Schema::get(value));
+		_dumpCount((unsigned int)LITESER_ELEMENT_REFERENCE);
+		_dumpCount((unsigned int)(reference >> 32));
+		_dumpCount((unsigned int)(reference & 0xFFFFFFFF));
+		// the class is needed to create the object before its element is loaded
+		_dumpCount(schemaId);
+		return true;
+	}
+
+	/// @brief Objects of the data that encloses a lazy object are written as a reference to that data.
+	inline bool __tryDumpOuterReference(Serializable* value)
+	{
+		if (value == NULL || _context->objectIds->indexOf(value) >= 0)
+		{
+			return false;
+		}
+		int size = _context->outerObjectIds.size();
+		int index = -1;
+		for_iter (i, 1, size + 1)
+		{
+			index = _context->outerObjectIds[size - i]->indexOf(value);
+			if (index >= 0)
+			{
+				_dumpCount((unsigned int)LITESER_OUTER_REFERENCE);
+				_dumpCount((unsigned int)i);
+				_dumpCount((unsigned int)(index + 1));
+				// every lazy object that is left by the reference depends on the data outside of it
+				for_iter (j, 1, i + 1)
+				{
+					++_context->outerReferenceCounts[size - j];
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// @brief Objects that were written within a lazy object of the same level are written as a reference to that lazy object.
+	inline bool __tryDumpLazyReference(Serializable* value)
+	{
+		if (value == NULL)
+		{
+			return false;
+		}
+		uint64_t reference = _context->lazyReferences.tryGet(value, 0);
+		if (reference == 0)
+		{
+			return false;
+		}
+		_dumpCount((unsigned int)LITESER_LAZY_REFERENCE);
+		_dumpCount((unsigned int)(reference >> 32));
+		_dumpCount((unsigned int)(reference & 0xFFFFFFFF));
+		return true;
+	}
+
+	/// @brief Objects of lazy objects that are not in the same level can only be referenced from within them.
+	inline bool __isEnclosedLazyObject(Serializable* value)
+	{
+		if (_context->lazyObjects.size() > 0 && _context->lazyObjects.indexOf(value) >= 0)
+		{
+			return true;
+		}
+		int size = _context->outerLazyReferences.size();
+		for_iter (i, 0, size)
+		{
+			if (_context->outerLazyReferences[i]->hasKey(value))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline void __dumpObjectVariables(Serializable* value, Schema* schema)
+	{
+		// the functions generated by LS_VARS write the same data without looking up the type of every variable
+		if (schema->codec)
+		{
+			FieldWriter writer;
+			_context->writer._getCursor(&writer.current, &writer.end);
+			writer.compactIntegers = _context->header.compactIntegers;
+			value->_lsDumpVars(writer);
+			_context->writer._setCursor(writer.current);
+			return;
+		}
+		foreach (Schema::Field*, it, schema->fields)
+		{
+			__dumpValue((*it)->address(value), (*it)->type);
+		}
 	}
 
 	void _dump(Serializable* value)
 	{
 		unsigned int id = 0;
-		if (!_currentHeader.allowMultiReferencing || __tryMapObject(&id, value))
+		if (_context->referencesOnly) // the variables of every object are encoded on their own
+		{
+			__tryMapObject(&id, value);
+			_dumpCount(id);
+			return;
+		}
+		if (_context->header.indexed && __tryDumpElementReference(value))
+		{
+			return;
+		}
+		if (_context->header.allowMultiReferencing && _context->outerObjectIds.size() > 0 && __tryDumpOuterReference(value))
+		{
+			return;
+		}
+		if (_context->header.allowMultiReferencing && _context->lazyReferences.size() > 0 && __tryDumpLazyReference(value))
+		{
+			return;
+		}
+		if (!_context->header.allowMultiReferencing || __tryMapObject(&id, value))
 		{
-			if (_currentHeader.allowMultiReferencing)
+			if (_context->header.allowMultiReferencing && __isEnclosedLazyObject(value))
+			{
+				throw Exception("Object of class '" + value->_lsName() + "' was first written within a lazy object and can only be referenced from within it or from the data directly around it!");
+			}
+			if (_context->header.allowMultiReferencing)
+			{
+				_dumpCount(id);
+			}
+			Schema* schema = Schema::get(value);
+			unsigned int schemaId = 0;
+			bool newSchema = __tryMapSchema(&schemaId, schema);
+			_dumpCount(schemaId);
+			// the class layout is written only with the first object of the class, indexed data keeps all layouts in a shared table
+			if (newSchema && !_context->header.indexed)
+			{
+				__dumpSchemaLayout(schema);
+			}
+			if (_context->header.lengthPrefixed)
 			{
-				stream->dump(id);
+				int objectCount = 0;
+				int registrationCount = 0;
+				int64_t position = __beginBlock(&objectCount, &registrationCount);
+				__dumpObjectVariables(value, schema);
+				__endBlock(position, objectCount, registrationCount);
 			}
-			hstr name = value->_lsName();
-			_dump(&name);
-			harray<Variable*> variables = value->_lsVars();
-			stream->dump((unsigned int)variables.size());
-			foreach (Variable*, it, variables)
+			else
 			{
-				_dump(&(*it)->name);
-				_dumpType((*it)->type->identifier);
-				__dumpVariable(*it);
-				delete (*it);
+				__dumpObjectVariables(value, schema);
 			}
 		}
 		else
 		{
-			stream->dump(id);
+			_dumpCount(id);
 		}
 	}
 
@@ -205,59 +924,434 @@ namespace liteser
 		_dump(*value);
 	}
 
+	/// @brief Objects that were never accessed since they were loaded are copied without decoding them if nothing in them depends on the data around them.
+	inline bool __tryDumpLazyData(LazySlot* slot)
+	{
+		if (slot == NULL || slot->scope == NULL || slot->outerReferences > 0 || _context->header.indexed)
+		{
+			return false;
+		}
+		const Header& header = slot->scope->header;
+		if (header.indexed || header.version != _context->header.version || header.allowMultiReferencing != _context->header.allowMultiReferencing ||
+			header.stringPooling != _context->header.stringPooling || header.lengthPrefixed != _context->header.lengthPrefixed ||
+			header.encodedArrays != _context->header.encodedArrays || header.compactIntegers != _context->header.compactIntegers)
+		{
+			return false;
+		}
+		_context->writer.dump((unsigned int)(slot->size + sizeof(unsigned int)));
+		_context->writer.dump(0u);
+		_context->writer.writeRaw(slot->data, (int)slot->size);
+		return true;
+	}
+
+	void _dump(LazyBase* value)
+	{
+		if (__tryDumpLazyData(value->_getSlot()))
+		{
+			if (_context->header.allowMultiReferencing)
+			{
+				++_context->lazyCount;
+			}
+			return;
+		}
+		Serializable* object = value->get();
+		if (object == NULL)
+		{
+			_context->writer.dump(0u);
+			return;
+		}
+		int64_t position = _context->writer.reserveUint32();
+		int64_t outerReferencesPosition = _context->writer.reserveUint32();
+		unsigned int outerReferences = 0;
+		if (_context->header.indexed) // elements are already loaded on demand so the object simply belongs to its element
+		{
+			_dump(object);
+		}
+		else
+		{
+			// the object gets its own IDs, strings and class layouts so it can be decoded on its own
+			IdMap<Serializable*>* objectIds = _context->objectIds;
+			IdMap<hstr>* stringIds = _context->stringIds;
+			hmap<Schema*, unsigned int> schemaIds;
+			schemaIds.swap(_context->schemaIds);
+			bool referencesOnly = _context->referencesOnly;
+			_context->referencesOnly = false; // snapshots keep the whole lazy object as one value
+			_context->outerObjectIds += objectIds;
+			_context->outerReferenceCounts += 0;
+			// objects of the lazy object are referenced by its index in the current level
+			uint64_t lazyIndex = _context->lazyCount;
+			unsigned int lazyCount = _context->lazyCount;
+			hmap<Serializable*, uint64_t> lazyReferences;
+			if (_context->header.allowMultiReferencing)
+			{
+				++lazyCount;
+				lazyReferences.swap(_context->lazyReferences);
+				_context->outerLazyReferences += &lazyReferences;
+			}
+			_context->lazyCount = 0;
+			_context->objectIds = new IdMap<Serializable*>();
+			_context->stringIds = new IdMap<hstr>();
+			_dump(object);
+			if (_context->header.allowMultiReferencing)
+			{
+				// objects of lazy objects within the lazy object cannot be referenced from outside of it
+				int index = 0;
+				harray<Serializable*> enclosedObjects = _context->lazyReferences.keys();
+				foreach (Serializable*, it, enclosedObjects)
+				{
+					_context->lazyObjects.tryAdd((*it), &index);
+				}
+				_context->outerLazyReferences.removeLast();
+				_context->lazyReferences.swap(lazyReferences);
+				int objectCount = _context->objectIds->size();
+				for_iter (i, 0, objectCount)
+				{
+					_context->lazyReferences[(*_context->objectIds)[i]] = ((lazyIndex << 32) | (uint64_t)(i + 1));
+				}
+			}
+			_context->lazyCount = lazyCount;
+			delete _context->objectIds;
+			delete _context->stringIds;
+			_context->objectIds = objectIds;
+			_context->stringIds = stringIds;
+			_context->schemaIds.swap(schemaIds);
+			_context->referencesOnly = referencesOnly;
+			_context->outerObjectIds.removeLast();
+			outerReferences = _context->outerReferenceCounts.removeLast();
+		}
+		int64_t size = _context->writer.position() - outerReferencesPosition;
+		if (size >= LITESER_BLOCK_REGISTERS)
+		{
+			throw Exception("Lazy object is too large!");
+		}
+		_context->writer.patchUint32(position, (unsigned int)size);
+		_context->writer.patchUint32(outerReferencesPosition, outerReferences);
+	}
+
 	void _dumpHarray(harray<Serializable*>* value)
 	{
 		_dumpType(Type::Identifier::Harray);
+		__dumpHarray(value, Type::Identifier::Object);
+	}
+
+	void _dumpIndexedHarray(harray<Serializable*>* value)
+	{
 		int size = value->size();
-		stream->dump((unsigned int)size);
-		if (size > 0)
+		_dumpType(Type::Identifier::Harray);
+		_context->writer.dump((unsigned int)size);
+		// offsets of the trailer and the end are only known once all elements were written
+		int64_t trailerPosition = _context->writer.position();
+		_context->writer.dump((uint64_t)0);
+		_context->writer.dump((uint64_t)0);
+		// elements can always be found as the first object of their own element
+		for_iter (i, 0, size)
 		{
-			stream->dump(1u);
-			_dumpType(Type::Identifier::Object);
-			foreach (Serializable*, it, *value)
+			if (value->operator[](i) != NULL && !_context->elementReferences.hasKey(value->operator[](i)))
 			{
-				_dump(*it);
+				_context->elementReferences[value->operator[](i)] = __makeElementReference(i, 1);
 			}
 		}
+		harray<uint64_t> offsets;
+		for_iter (i, 0, size)
+		{
+			offsets += (uint64_t)_context->writer.position();
+			_context->element = i;
+			_context->objectIds->clear();
+			_dump(&value->operator[](i));
+		}
+		uint64_t trailer = (uint64_t)_context->writer.position();
+		offsets += trailer;
+		harray<Schema*> schemas;
+		schemas.add(NULL, _context->schemaIds.size());
+		for (hmap<Schema*, unsigned int>::iterator it = _context->schemaIds.begin(); it != _context->schemaIds.end(); ++it)
+		{
+			schemas[it->second] = it->first;
+		}
+		// the strings of the layouts are pooled as well so they have to be in the table before it is written
+		unsigned int id = 0;
+		foreach (Schema*, it, schemas)
+		{
+			__tryMapString(&id, (*it)->className);
+			foreach (Schema::Field*, it2, (*it)->fields)
+			{
+				__tryMapString(&id, (*it2)->name);
+			}
+		}
+		int stringCount = _context->stringIds->size();
+		_context->writer.dump((unsigned int)stringCount);
+		for_iter (i, 0, stringCount)
+		{
+			__dumpString(_context->stringIds->operator[](i));
+		}
+		_context->writer.dump((unsigned int)schemas.size());
+		foreach (Schema*, it, schemas)
+		{
+			__dumpSchemaLayout(*it);
+		}
+		foreach (uint64_t, it, offsets)
+		{
+			_context->writer.dump(*it);
+		}
+		_context->writer.overwriteUint64(trailerPosition, trailer);
+		_context->writer.overwriteUint64(trailerPosition + sizeof(uint64_t), (uint64_t)_context->writer.position());
 	}
 
-#define DEFINE_DUMP_HARRAY(type) \
-	void _dumpHarray(harray<type>* value) \
-	{ \
-		_dumpType(Type::Identifier::Harray); \
-		int size = value->size(); \
-		stream->dump((unsigned int)size); \
-		if (size > 0) \
-		{ \
-			stream->dump(1u); \
-			Type dumpType; \
-			dumpType.assign((VPtr<type>*)NULL); \
-			_dumpType(dumpType.identifier); \
-			foreach (type, it, *value) \
-			{ \
-				stream->dump(*it); \
-			} \
-		} \
+	/// @brief Writes one variable of all objects after each other, numbers are copied out of the objects in blocks.
+	inline void __dumpColumn(harray<Serializable*>* value, Schema::Field* field)
+	{
+		int size = value->size();
+		int elementSize = (_getVarintCount(field->type->identifier) == 0 ? _getNumberSize(field->type->identifier) : 0);
+		if (elementSize == 0)
+		{
+			for_iter (i, 0, size)
+			{
+				__dumpValue(field->address(value->operator[](i)), field->type);
+			}
+			return;
+		}
+		unsigned char block[LITESER_RAW_BLOCK_SIZE];
+		int blockCount = LITESER_RAW_BLOCK_SIZE / elementSize;
+		int count = 0;
+		for (int i = 0; i < size; i += count)
+		{
+			count = hmin(size - i, blockCount);
+			for_iter (j, 0, count)
+			{
+				memcpy(&block[j * elementSize], field->address(value->operator[](i + j)), elementSize);
+			}
+			__dumpRaw(block, elementSize, count);
+		}
+	}
+
+	bool _canDumpColumnar(harray<Serializable*>* value)
+	{
+		if (value->size() == 0 || value->first() == NULL)
+		{
+			return false;
+		}
+		Schema* schema = Schema::get(value->first());
+		IdMap<Serializable*> objects;
+		objects.reserve(value->size());
+		int index = -1;
+		foreach (Serializable*, it, *value)
+		{
+			if ((*it) == NULL || Schema::get(*it) != schema || !objects.tryAdd(*it, &index))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void _dumpColumnarHarray(harray<Serializable*>* value)
+	{
+		int size = value->size();
+		_dumpType(Type::Identifier::Harray);
+		_context->writer.dump((unsigned int)size);
+		// all elements get their IDs first so variables can reference any of them
+		_context->objectIds->reserve(_context->objectIds->size() + size);
+		unsigned int id = 0;
+		foreach (Serializable*, it, *value)
+		{
+			__tryMapObject(&id, *it);
+		}
+		Schema* schema = Schema::get(value->first());
+		unsigned int schemaId = 0;
+		__tryMapSchema(&schemaId, schema);
+		_dumpCount(schemaId);
+		__dumpSchemaLayout(schema);
+		foreach (Schema::Field*, it, schema->fields)
+		{
+			__dumpColumn(value, *it);
+		}
+	}
+
+	/// @brief Encodes every variable of an object on its own and adds it to a snapshot.
+	inline void __dumpSnapshotObject(Serializable* value, Snapshot* snapshot)
+	{
+		Schema* schema = Schema::get(value);
+		snapshot->objects += value;
+		snapshot->schemas += schema;
+		snapshot->fields += snapshot->offsets.size();
+		int offset = 0;
+		int size = 0;
+		foreach (Schema::Field*, it, schema->fields)
+		{
+			// strings are pooled per variable so the encoding of a variable does not depend on the ones before it
+			_context->stringIds->clear();
+			_context->writer.open(NULL);
+			__dumpValue((*it)->address(value), (*it)->type);
+			offset = snapshot->data.size();
+			size = (int)_context->writer.getSize();
+			snapshot->offsets += offset;
+			if (size > 0)
+			{
+				snapshot->data.add((unsigned char)0, size);
+				memcpy(&snapshot->data[offset], _context->writer.getData(), size);
+			}
+		}
+	}
+
+	/// @brief Gives the objects of a snapshot the IDs they have in it.
+	inline void __mapSnapshotObjects(Snapshot* snapshot)
+	{
+		_context->objectIds->clear();
+		_context->objectIds->reserve(snapshot->objects.size());
+		int index = 0;
+		foreach (Serializable*, it, snapshot->objects)
+		{
+			_context->objectIds->tryAdd(*it, &index);
+		}
 	}
 
-#define DEFINE_DUMP_HARRAY_C(type) \
+	/// @return True if the objects that are in both snapshots have the same IDs in both.
+	inline bool __hasSameIds(Snapshot* snapshot, Snapshot* baseline)
+	{
+		int size = hmin(snapshot->objects.size(), baseline->objects.size());
+		for_iter (i, 0, size)
+		{
+			if (snapshot->objects[i] != baseline->objects[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// @brief Encodes the objects of a snapshot again with the IDs they have in the baseline so their variables can be compared.
+	inline void __dumpSnapshotWithIds(Snapshot* snapshot, Snapshot* baseline, Snapshot* output)
+	{
+		Context context;
+		_setup(NULL, Header(true, true));
+		context.referencesOnly = true;
+		__mapSnapshotObjects(baseline);
+		foreach (Serializable*, it, snapshot->objects)
+		{
+			__dumpSnapshotObject(*it, output);
+		}
+		output->offsets += output->data.size();
+	}
+
+	inline bool __isFieldEqual(Snapshot* snapshot, int object, Snapshot* baseline, int baselineObject, int field)
+	{
+		int index = snapshot->fields[object] + field;
+		int baselineIndex = baseline->fields[baselineObject] + field;
+		int size = snapshot->offsets[index + 1] - snapshot->offsets[index];
+		if (size != baseline->offsets[baselineIndex + 1] - baseline->offsets[baselineIndex])
+		{
+			return false;
+		}
+		return (size == 0 || memcmp(&snapshot->data[snapshot->offsets[index]], &baseline->data[baseline->offsets[baselineIndex]], size) == 0);
+	}
+
+	void _dumpSnapshot(Serializable* value, Snapshot* snapshot)
+	{
+		Context context;
+		_setup(NULL, Header(true, true));
+		context.referencesOnly = true;
+		snapshot->clear();
+		unsigned int id = 0;
+		__tryMapObject(&id, value);
+		// objects are added to the IDs while the variables of the ones before them are encoded
+		for (int i = 0; i < context.objectIds->size(); ++i)
+		{
+			__dumpSnapshotObject((*context.objectIds)[i], snapshot);
+		}
+		snapshot->offsets += snapshot->data.size();
+	}
+
+	void _dumpSnapshotObjects(Serializable* value, harray<Serializable*>* objects)
+	{
+		Context context;
+		_setup(NULL, Header(true, true));
+		context.referencesOnly = true;
+		unsigned int id = 0;
+		__tryMapObject(&id, value);
+		Serializable* object = NULL;
+		for (int i = 0; i < context.objectIds->size(); ++i)
+		{
+			object = (*context.objectIds)[i];
+			objects->add(object);
+			foreach (Schema::Field*, it, Schema::get(object)->fields)
+			{
+				context.writer.open(NULL);
+				__dumpValue((*it)->address(object), (*it)->type);
+			}
+		}
+	}
+
+	void _dumpDelta(Snapshot* snapshot, Snapshot* baseline)
+	{
+		Snapshot compared;
+		Snapshot* comparedSnapshot = snapshot;
+		// objects that were added or removed in between others change the IDs that pointers are encoded with
+		if (!__hasSameIds(snapshot, baseline))
+		{
+			__dumpSnapshotWithIds(snapshot, baseline, &compared);
+			comparedSnapshot = &compared;
+		}
+		// objects of the baseline are only referenced, new objects are written completely by the first variable that references them
+		__mapSnapshotObjects(baseline);
+		int baselineCount = baseline->objects.size();
+		_context->writer.dump((unsigned int)baselineCount);
+		harray<int> changed;
+		Serializable* object = NULL;
+		Schema* schema = NULL;
+		Schema::Field* field = NULL;
+		int index = -1;
+		int fieldCount = 0;
+		int size = snapshot->objects.size();
+		for_iter (i, 0, size)
+		{
+			object = snapshot->objects[i];
+			index = _context->objectIds->indexOf(object);
+			if (index < 0 || index >= baselineCount)
+			{
+				continue;
+			}
+			schema = snapshot->schemas[i];
+			if (baseline->schemas[index] != schema)
+			{
+				throw Exception("Object of class '" + schema->className + "' was created where an object of class '" + baseline->schemas[index]->className + "' was deleted, a new snapshot has to be taken!");
+			}
+			changed.clear();
+			fieldCount = schema->fields.size();
+			for_iter (j, 0, fieldCount)
+			{
+				if (!__isFieldEqual(comparedSnapshot, i, baseline, index, j))
+				{
+					changed += j;
+				}
+			}
+			if (changed.size() > 0)
+			{
+				_context->writer.dump((unsigned int)(index + 1));
+				_context->writer.dump((unsigned int)changed.size());
+				foreach (int, it, changed)
+				{
+					field = schema->fields[*it];
+					_context->writer.dump((unsigned int)(*it));
+					_dumpType(field->type->identifier, field->type->scale);
+					__dumpValue(field->address(object), field->type);
+				}
+			}
+		}
+		_context->writer.dump(0u);
+		// the next delta is written against the state that was just saved
+		baseline->objects.swap(snapshot->objects);
+		baseline->schemas.swap(snapshot->schemas);
+		baseline->fields.swap(snapshot->fields);
+		baseline->offsets.swap(snapshot->offsets);
+		baseline->data.swap(snapshot->data);
+	}
+
+#define DEFINE_DUMP_HARRAY(type) \
 	void _dumpHarray(harray<type>* value) \
 	{ \
 		_dumpType(Type::Identifier::Harray); \
-		int size = value->size(); \
-		stream->dump((unsigned int)size); \
-		if (size > 0) \
-		{ \
-			stream->dump(1u); \
-			Type dumpType; \
-			dumpType.assign((VPtr<type>*)NULL); \
-			_dumpType(dumpType.identifier); \
-			stream->dump((unsigned int)value->size()); \
-			foreach (type, it, *value) \
-			{ \
-				_dump(&(*it)); \
-			} \
-		} \
+		Type dumpType; \
+		dumpType.assign((VPtr<type>*)NULL); \
+		__dumpHarray(value, dumpType.identifier); \
 	}
 
 	DEFINE_DUMP_HARRAY(char);
@@ -270,17 +1364,53 @@ namespace liteser
 	DEFINE_DUMP_HARRAY(uint64_t);
 	DEFINE_DUMP_HARRAY(float);
 	DEFINE_DUMP_HARRAY(double);
-	DEFINE_DUMP_HARRAY_C(hstr);
-	DEFINE_DUMP_HARRAY_C(hversion);
-	DEFINE_DUMP_HARRAY_C(henum);
-	DEFINE_DUMP_HARRAY_C(grectf);
-	DEFINE_DUMP_HARRAY_C(gvec2f);
-	DEFINE_DUMP_HARRAY_C(gvec3f);
-	DEFINE_DUMP_HARRAY_C(grecti);
-	DEFINE_DUMP_HARRAY_C(gvec2i);
-	DEFINE_DUMP_HARRAY_C(gvec3i);
-	DEFINE_DUMP_HARRAY_C(grectd);
-	DEFINE_DUMP_HARRAY_C(gvec2d);
-	DEFINE_DUMP_HARRAY_C(gvec3d);
+	DEFINE_DUMP_HARRAY(hstr);
+	DEFINE_DUMP_HARRAY(hversion);
+	DEFINE_DUMP_HARRAY(henum);
+	DEFINE_DUMP_HARRAY(grectf);
+	DEFINE_DUMP_HARRAY(gvec2f);
+	DEFINE_DUMP_HARRAY(gvec3f);
+	DEFINE_DUMP_HARRAY(grecti);
+	DEFINE_DUMP_HARRAY(gvec2i);
+	DEFINE_DUMP_HARRAY(gvec3i);
+	DEFINE_DUMP_HARRAY(grectd);
+	DEFINE_DUMP_HARRAY(gvec2d);
+	DEFINE_DUMP_HARRAY(gvec3d);
+
+	// values of generated codecs are written at the position the codec has reached
+#define DEFINE_DUMP_FIELD_F(function, type) \
+	void function(FieldWriter& writer, type* value) \
+	{ \
+		_context->writer._setCursor(writer.current); \
+		_dump(value); \
+		_context->writer._getCursor(&writer.current, &writer.end); \
+	}
+#define DEFINE_DUMP_FIELD_VALUE(identifier, type) DEFINE_DUMP_FIELD_F(_dumpFieldValue, type)
+#define DEFINE_DUMP_FIELD(identifier, type) DEFINE_DUMP_FIELD_F(_dumpField, type)
+
+	LITESER_NUMBER_TYPES(DEFINE_DUMP_FIELD_VALUE);
+	DEFINE_DUMP_FIELD_VALUE(Bool, bool);
+	DEFINE_DUMP_FIELD(Hstr, hstr);
+	DEFINE_DUMP_FIELD(Hversion, hversion);
+	DEFINE_DUMP_FIELD(Henum, henum);
+	DEFINE_DUMP_FIELD(Grectf, grectf);
+	DEFINE_DUMP_FIELD(Gvec2f, gvec2f);
+	DEFINE_DUMP_FIELD(Gvec3f, gvec3f);
+	DEFINE_DUMP_FIELD(Grecti, grecti);
+	DEFINE_DUMP_FIELD(Gvec2i, gvec2i);
+	DEFINE_DUMP_FIELD(Gvec3i, gvec3i);
+	DEFINE_DUMP_FIELD(Grectd, grectd);
+	DEFINE_DUMP_FIELD(Gvec2d, gvec2d);
+	DEFINE_DUMP_FIELD(Gvec3d, gvec3d);
+	DEFINE_DUMP_FIELD(ValueObject, Serializable);
+	DEFINE_DUMP_FIELD(Object, Serializable*);
+	DEFINE_DUMP_FIELD(LazyObject, LazyBase);
+
+	void _dumpField(FieldWriter& writer, void* value, Type* type)
+	{
+		_context->writer._setCursor(writer.current);
+		__dumpValue(value, type);
+		_context->writer._getCursor(&writer.current, &writer.end);
+	}
 
 }
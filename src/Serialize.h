@@ -29,13 +29,26 @@
 
 namespace liteser
 {
+	class LazyBase;
 	class Serializable;
-	class Variable;
+	class Snapshot;
 
-	void _dumpType(Type::Identifier identifier);
+	/// @param[in] scale Scale of fixed point numbers, it is only stored for fixed point types.
+	void _dumpType(Type::Identifier identifier, int scale = 0);
 
-	void __dumpContainer(Variable* variable);
+	void __dumpContainer(void* value, Type* type);
 
+	void _dump(char* value);
+	void _dump(unsigned char* value);
+	void _dump(short* value);
+	void _dump(unsigned short* value);
+	void _dump(int* value);
+	void _dump(unsigned int* value);
+	void _dump(int64_t* value);
+	void _dump(uint64_t* value);
+	void _dump(float* value);
+	void _dump(double* value);
+	void _dump(bool* value);
 	void _dump(hstr* value);
 	void _dump(hversion* value);
 	void _dump(henum* value);
@@ -50,6 +63,7 @@ namespace liteser
 	void _dump(gvec3d* value);
 	void _dump(Serializable* value);
 	void _dump(Serializable** value);
+	void _dump(LazyBase* value);
 
 	void _dumpHarray(harray<char>* value);
 	void _dumpHarray(harray<unsigned char>* value);
@@ -74,6 +88,19 @@ namespace liteser
 	void _dumpHarray(harray<gvec2d>* value);
 	void _dumpHarray(harray<gvec3d>* value);
 	void _dumpHarray(harray<Serializable*>* value);
+	/// @brief Every element gets its own object IDs and the trailer holds the shared strings, layouts and element offsets.
+	void _dumpIndexedHarray(harray<Serializable*>* value);
+	/// @return True if all elements are different objects of the same class so they can be written column by column.
+	bool _canDumpColumnar(harray<Serializable*>* value);
+	/// @brief The class layout is written once and then every variable of all elements together, in the order of the layout.
+	void _dumpColumnarHarray(harray<Serializable*>* value);
+
+	/// @brief Encodes every variable of every object of a graph on its own, pointers as the IDs of the objects.
+	void _dumpSnapshot(Serializable* value, Snapshot* snapshot);
+	/// @brief Gets the objects of a graph in the order of their IDs in a snapshot.
+	void _dumpSnapshotObjects(Serializable* value, harray<Serializable*>* objects);
+	/// @brief Writes the variables that changed since the baseline and makes the snapshot the new baseline.
+	void _dumpDelta(Snapshot* snapshot, Snapshot* baseline);
 
 }
 #endif
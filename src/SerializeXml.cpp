@@ -17,55 +17,82 @@
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Context.h"
+#include "Lazy.h"
 #include "liteser.h"
 #include "Serializable.h"
 #include "SerializeXml.h"
 #include "Type.h"
+#include "TypeTable.h"
 #include "Utility.h"
 #include "Variable.h"
 
 #define WRITE_NODE(string) \
-	stream->writeLine(_indent + "<" + hstr(string) + "/>");
+	_context->stream->writeLine(_context->indent + "<" + hstr(string) + "/>");
 #define OPEN_NODE(string) \
-	stream->writeLine(_indent + "<" + hstr(string) + ">"); \
-	_indent += "\t";
+	_context->stream->writeLine(_context->indent + "<" + hstr(string) + ">"); \
+	_context->indent += "\t";
 #define CLOSE_NODE(string) \
-	_indent = _indent(0, _indent.size() - 1); \
-	stream->writeLine(_indent + "</" + hstr(string) + ">");
+	_context->indent = _context->indent(0, _context->indent.size() - 1); \
+	_context->stream->writeLine(_context->indent + "</" + hstr(string) + ">");
 #define START_LINE(string) \
-	stream->write(_indent + "<" + hstr(string));
+	_context->stream->write(_context->indent + "<" + hstr(string));
 #define FINISH_LINE(string) \
-	stream->writeLine(hstr(string) + "/>");
+	_context->stream->writeLine(hstr(string) + "/>");
 
 namespace liteser
 {
 	namespace xml
 	{
-		inline void __dumpVariableStart(Variable* variable)
+		/// @brief Values are written with full precision, the scale of fixed point types is only stored so the data can be converted to binary.
+		inline hstr __getScale(Type* type)
 		{
-			if (variable->type->identifier == Type::Identifier::Harray || variable->type->identifier == Type::Identifier::Hmap)
+			return (_isFixedPoint(type->identifier) ? hsprintf(" scale=\"%d\"", type->scale) : hstr());
+		}
+
+		inline hstr __getSubTypes(const harray<Type*>& subTypes)
+		{
+			harray<hstr> types;
+			harray<hstr> scales;
+			bool fixedPoint = false;
+			foreach (Type*, it, subTypes)
 			{
-				harray<hstr> types;
-				foreach (Type*, it, variable->type->subTypes)
+				types += hsprintf("%02X", (*it)->identifier.value);
+				scales += hsprintf("%d", (*it)->scale);
+				if (_isFixedPoint((*it)->identifier))
 				{
-					types += hsprintf("%02X", (*it)->identifier.value);
+					fixedPoint = true;
 				}
+			}
+			hstr result = hsprintf(" sub_types=\"%s\"", types.joined(',').cStr());
+			if (fixedPoint)
+			{
+				result += hsprintf(" sub_scales=\"%s\"", scales.joined(',').cStr());
+			}
+			return result;
+		}
+
+		inline void __dumpVariableStart(Variable* variable)
+		{
+			if (variable->type->identifier == Type::Identifier::Harray || variable->type->identifier == Type::Identifier::Hmap)
+			{
 				if (variable->containerSize > 0)
 				{
-					OPEN_NODE(hsprintf("Variable name=\"%s\" type=\"%02X\" sub_types=\"%s\"", variable->name.cStr(), variable->type->identifier.value, types.joined(',').cStr()));
+					OPEN_NODE(hsprintf("Variable name=\"%s\" type=\"%02X\"", variable->name.cStr(), variable->type->identifier.value) + __getSubTypes(variable->type->subTypes));
 				}
 				else
 				{
-					WRITE_NODE(hsprintf("Variable name=\"%s\" type=\"%02X\" sub_types=\"%s\"", variable->name.cStr(), variable->type->identifier.value, types.joined(',').cStr()));
+					WRITE_NODE(hsprintf("Variable name=\"%s\" type=\"%02X\"", variable->name.cStr(), variable->type->identifier.value) + __getSubTypes(variable->type->subTypes));
 				}
 			}
-			else if (variable->type->identifier == Type::Identifier::ValueObject || variable->type->identifier == Type::Identifier::Object)
+			else if (variable->type->identifier == Type::Identifier::ValueObject || variable->type->identifier == Type::Identifier::Object ||
+				variable->type->identifier == Type::Identifier::LazyObject)
 			{
 				OPEN_NODE(hsprintf("Variable name=\"%s\" type=\"%02X\"", variable->name.cStr(), variable->type->identifier.value));
 			}
 			else
 			{
-				START_LINE(hsprintf("Variable name=\"%s\" type=\"%02X\" value=\"", variable->name.cStr(), variable->type->identifier.value));
+				START_LINE(hsprintf("Variable name=\"%s\" type=\"%02X\"", variable->name.cStr(), variable->type->identifier.value) + __getScale(variable->type) + " value=\"");
 			}
 		}
 
@@ -78,7 +105,8 @@ namespace liteser
 					CLOSE_NODE("Variable");
 				}
 			}
-			else if (variable->type->identifier == Type::Identifier::ValueObject || variable->type->identifier == Type::Identifier::Object)
+			else if (variable->type->identifier == Type::Identifier::ValueObject || variable->type->identifier == Type::Identifier::Object ||
+				variable->type->identifier == Type::Identifier::LazyObject)
 			{
 				CLOSE_NODE("Variable");
 			}
@@ -88,160 +116,276 @@ namespace liteser
 			}
 		}
 		
-		inline void __dumpVariable(Variable* variable)
-		{
-			if (variable->type->identifier == Type::Identifier::Int8)				stream->write((int)*variable->value<char>());
-			else if (variable->type->identifier == Type::Identifier::UInt8)			stream->write(*variable->value<unsigned char>());
-			else if (variable->type->identifier == Type::Identifier::Int16)			stream->write(*variable->value<short>());
-			else if (variable->type->identifier == Type::Identifier::UInt16)		stream->write(*variable->value<unsigned short>());
-			else if (variable->type->identifier == Type::Identifier::Int32)			stream->write(*variable->value<int>());
-			else if (variable->type->identifier == Type::Identifier::UInt32)		stream->write(*variable->value<unsigned int>());
-			else if (variable->type->identifier == Type::Identifier::Int64)			stream->write(*variable->value<int64_t>());
-			else if (variable->type->identifier == Type::Identifier::UInt64)		stream->write(*variable->value<uint64_t>());
-			else if (variable->type->identifier == Type::Identifier::Float)			stream->write(hsprintf("%g", *variable->value<float>()));
-			else if (variable->type->identifier == Type::Identifier::Double)		stream->write(hsprintf("%g", *variable->value<double>()));
-			else if (variable->type->identifier == Type::Identifier::Bool)			stream->write(*variable->value<bool>());
-			else if (variable->type->identifier == Type::Identifier::Hstr)			_dump(variable->value<hstr>());
-			else if (variable->type->identifier == Type::Identifier::Hversion)		_dump(variable->value<hversion>());
-			else if (variable->type->identifier == Type::Identifier::Henum)			_dump(variable->value<henum>());
-			else if (variable->type->identifier == Type::Identifier::Grectf)		_dump(variable->value<grectf>());
-			else if (variable->type->identifier == Type::Identifier::Gvec2f)		_dump(variable->value<gvec2f>());
-			else if (variable->type->identifier == Type::Identifier::Gvec3f)		_dump(variable->value<gvec3f>());
-			else if (variable->type->identifier == Type::Identifier::Grecti)		_dump(variable->value<grecti>());
-			else if (variable->type->identifier == Type::Identifier::Gvec2i)		_dump(variable->value<gvec2i>());
-			else if (variable->type->identifier == Type::Identifier::Gvec3i)		_dump(variable->value<gvec3i>());
-			else if (variable->type->identifier == Type::Identifier::Grectd)		_dump(variable->value<grectd>());
-			else if (variable->type->identifier == Type::Identifier::Gvec2d)		_dump(variable->value<gvec2d>());
-			else if (variable->type->identifier == Type::Identifier::Gvec3d)		_dump(variable->value<gvec3d>());
-			else if (variable->type->identifier == Type::Identifier::ValueObject)	_dump(variable->value<Serializable>());
-			else if (variable->type->identifier == Type::Identifier::Object)		_dump(variable->value<Serializable*>());
-			else if (variable->type->identifier == Type::Identifier::Harray)		__dumpContainer(variable);
-			else if (variable->type->identifier == Type::Identifier::Hmap)			__dumpContainer(variable);
-		}
-
-		inline void __dumpContainerVariableStart(Variable* variable)
+		typedef void (*DumpFunction)(void*, Type*);
+
+		template <typename T>
+		static void __dumpTyped(void* value, Type*)
 		{
-			if (variable->type->identifier == Type::Identifier::Harray || variable->type->identifier == Type::Identifier::Hmap)
+			_dump((T*)value);
+		}
+
+		static void __dumpNothing(void*, Type*)
+		{
+		}
+
+		class ValueDumpers : public DispatchTable<DumpFunction>
+		{
+		public:
+			ValueDumpers() : DispatchTable<DumpFunction>(&__dumpNothing)
 			{
-				harray<hstr> types;
-				foreach (Type*, it, variable->type->subTypes)
-				{
-					types += hsprintf("%02X", (*it)->identifier.value);
-				}
-				if (variable->containerSize > 0)
-				{
-					OPEN_NODE(hsprintf("Container sub_types=\"%s\"", types.joined(',').cStr()));
-				}
-				else
-				{
-					WRITE_NODE(hsprintf("Container sub_types=\"%s\"", types.joined(',').cStr()));
-				}
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpTyped<type>);
+				LITESER_VALUE_TYPES(SET_DUMPER)
+				// packed values are written with full precision since text does not benefit from it
+				LITESER_PACKED_TYPES(SET_DUMPER)
+				LITESER_SERIES_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+				this->set(Type::Identifier::Harray, &__dumpContainer);
+				this->set(Type::Identifier::Hmap, &__dumpContainer);
 			}
-			else if (variable->type->identifier != Type::Identifier::ValueObject && variable->type->identifier != Type::Identifier::Object)
+
+		};
+
+		inline void __dumpValue(void* value, Type* type)
+		{
+			const ValueDumpers& dumpers = _getTable<ValueDumpers>();
+			dumpers.get(type->identifier)(value, type);
+		}
+
+		inline void __dumpElementStart(Type* type)
+		{
+			if (type->identifier != Type::Identifier::ValueObject && type->identifier != Type::Identifier::Object)
 			{
 				START_LINE("Element value=\"");
 			}
 		}
 
-		inline void __dumpContainerVariableFinish(Variable* variable)
+		inline void __dumpElementFinish(Type* type)
 		{
-			if (variable->type->identifier == Type::Identifier::Harray || variable->type->identifier == Type::Identifier::Hmap)
+			if (type->identifier != Type::Identifier::ValueObject && type->identifier != Type::Identifier::Object)
 			{
-				if (variable->containerSize > 0)
-				{
-					CLOSE_NODE("Container");
-				}
+				FINISH_LINE("\"");
 			}
-			else if (variable->type->identifier != Type::Identifier::ValueObject && variable->type->identifier != Type::Identifier::Object)
+		}
+
+		template <typename T>
+		inline void __dumpHarray(harray<T>* value, Type* subType)
+		{
+			int size = value->size();
+			for_iter (i, 0, size)
 			{
-				FINISH_LINE("\"");
+				__dumpElementStart(subType);
+				__dumpValue(&value->operator[](i), subType);
+				__dumpElementFinish(subType);
 			}
 		}
 
-		inline void __dumpContainer(Variable* variable)
+		template <typename K, typename V>
+		inline void __dumpHmap(hmap<K, V>* value, Type* type)
 		{
-			if (variable->containerSize > 0)
+			// keys and values are stored as two separate containers
+			if (value->size() > 0)
 			{
-				foreach (Variable*, it, variable->subVariables)
+				OPEN_NODE("Container" + __getSubTypes(type->subTypes(0, 1)));
+				for (typename hmap<K, V>::iterator it = value->begin(); it != value->end(); ++it)
+				{
+					__dumpElementStart(type->subTypes[0]);
+					__dumpValue((K*)&it->first, type->subTypes[0]);
+					__dumpElementFinish(type->subTypes[0]);
+				}
+				CLOSE_NODE("Container");
+				OPEN_NODE("Container" + __getSubTypes(type->subTypes(1, 1)));
+				for (typename hmap<K, V>::iterator it = value->begin(); it != value->end(); ++it)
 				{
-					__dumpContainerVariableStart(*it);
-					__dumpVariable(*it);
-					__dumpContainerVariableFinish(*it);
+					__dumpElementStart(type->subTypes[1]);
+					__dumpValue(&it->second, type->subTypes[1]);
+					__dumpElementFinish(type->subTypes[1]);
 				}
+				CLOSE_NODE("Container");
 			}
 		}
 
+		static void __dumpUnsupportedHarray(void*, Type* type)
+		{
+			throw Exception(hsprintf("Subtype is not supported within harray: %02X", type->subTypes[0]->identifier.value));
+		}
+
+		static void __dumpUnsupportedHmap(void*, Type* type)
+		{
+			throw Exception(hsprintf("Subtype is not supported within hmap: %02X %02X", type->subTypes[0]->identifier.value, type->subTypes[1]->identifier.value));
+		}
+
+		template <typename T>
+		static void __dumpHarrayTyped(void* value, Type* type)
+		{
+			__dumpHarray((harray<T>*)value, type->subTypes[0]);
+		}
+
+		template <typename K, typename V>
+		static void __dumpHmapTyped(void* value, Type* type)
+		{
+			__dumpHmap((hmap<K, V>*)value, type);
+		}
+
+		/// @brief Harrays of packed values and samples are written as harrays of the wrapped type since they have the same layout.
+		class HarrayDumpers : public DispatchTable<DumpFunction>
+		{
+		public:
+			HarrayDumpers() : DispatchTable<DumpFunction>(&__dumpUnsupportedHarray)
+			{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpHarrayTyped<type>);
+				LITESER_ELEMENT_TYPES(SET_DUMPER)
+				LITESER_PACKED_TYPES(SET_DUMPER)
+				LITESER_SERIES_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+			}
+
+		};
+
+		template <typename K>
+		class HmapDumpers : public DispatchTable<DumpFunction>
+		{
+		public:
+			HmapDumpers() : DispatchTable<DumpFunction>(&__dumpUnsupportedHmap)
+			{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpHmapTyped<K, type>);
+				LITESER_ELEMENT_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+			}
+
+		};
+
+		template <typename K>
+		static void __dumpHmapKey(void* value, Type* type)
+		{
+			const HmapDumpers<K>& dumpers = _getTable<HmapDumpers<K> >();
+			dumpers.get(type->subTypes[1]->identifier)(value, type);
+		}
+
+		class HmapKeyDumpers : public DispatchTable<DumpFunction>
+		{
+		public:
+			HmapKeyDumpers() : DispatchTable<DumpFunction>(&__dumpUnsupportedHmap)
+			{
+#define SET_DUMPER(name, type) this->set(Type::Identifier::name, &__dumpHmapKey<type>);
+				LITESER_KEY_TYPES(SET_DUMPER)
+#undef SET_DUMPER
+			}
+
+		};
+
+		void __dumpContainer(void* value, Type* type)
+		{
+			if (type->identifier == Type::Identifier::Harray)
+			{
+				const HarrayDumpers& dumpers = _getTable<HarrayDumpers>();
+				dumpers.get(type->subTypes[0]->identifier)(value, type);
+			}
+			else if (type->identifier == Type::Identifier::Hmap)
+			{
+				const HmapKeyDumpers& dumpers = _getTable<HmapKeyDumpers>();
+				dumpers.get(type->subTypes[0]->identifier)(value, type);
+			}
+		}
+
+#define DEFINE_DUMP(type) \
+		void _dump(type* value) \
+		{ \
+			_context->stream->write(*value); \
+		}
+
+#define DEFINE_DUMP_FLOAT(type) \
+		void _dump(type* value) \
+		{ \
+			_context->stream->write(hsprintf("%g", *value)); \
+		}
+
+		void _dump(char* value)
+		{
+			_context->stream->write((int)*value);
+		}
+
+		DEFINE_DUMP(unsigned char);
+		DEFINE_DUMP(short);
+		DEFINE_DUMP(unsigned short);
+		DEFINE_DUMP(int);
+		DEFINE_DUMP(unsigned int);
+		DEFINE_DUMP(int64_t);
+		DEFINE_DUMP(uint64_t);
+		DEFINE_DUMP_FLOAT(float);
+		DEFINE_DUMP_FLOAT(double);
+		DEFINE_DUMP(bool);
+
 		void _dump(hstr* value)
 		{
-			stream->write(*value);
+			_context->stream->write(*value);
 		}
 
 		void _dump(hversion* value)
 		{
-			stream->write(value->toString(4));
+			_context->stream->write(value->toString(4));
 		}
 
 		void _dump(henum* value)
 		{
-			stream->write(value->value);
+			_context->stream->write(value->value);
 		}
 
 		void _dump(grectf* value)
 		{
-			stream->write(hsprintf("%g,%g,%g,%g", value->x, value->y, value->w, value->h));
+			_context->stream->write(hsprintf("%g,%g,%g,%g", value->x, value->y, value->w, value->h));
 		}
 
 		void _dump(gvec2f* value)
 		{
-			stream->write(hsprintf("%g,%g", value->x, value->y));
+			_context->stream->write(hsprintf("%g,%g", value->x, value->y));
 		}
 
 		void _dump(gvec3f* value)
 		{
-			stream->write(hsprintf("%g,%g,%g", value->x, value->y, value->z));
+			_context->stream->write(hsprintf("%g,%g,%g", value->x, value->y, value->z));
 		}
 
 		void _dump(grecti* value)
 		{
-			stream->write(hsprintf("%d,%d,%d,%d", value->x, value->y, value->w, value->h));
+			_context->stream->write(hsprintf("%d,%d,%d,%d", value->x, value->y, value->w, value->h));
 		}
 
 		void _dump(gvec2i* value)
 		{
-			stream->write(hsprintf("%d,%d", value->x, value->y));
+			_context->stream->write(hsprintf("%d,%d", value->x, value->y));
 		}
 
 		void _dump(gvec3i* value)
 		{
-			stream->write(hsprintf("%d,%d,%d", value->x, value->y, value->z));
+			_context->stream->write(hsprintf("%d,%d,%d", value->x, value->y, value->z));
 		}
 
 		void _dump(grectd* value)
 		{
-			stream->write(hsprintf("%g,%g,%g,%g", value->x, value->y, value->w, value->h));
+			_context->stream->write(hsprintf("%g,%g,%g,%g", value->x, value->y, value->w, value->h));
 		}
 
 		void _dump(gvec2d* value)
 		{
-			stream->write(hsprintf("%g,%g", value->x, value->y));
+			_context->stream->write(hsprintf("%g,%g", value->x, value->y));
 		}
 
 		void _dump(gvec3d* value)
 		{
-			stream->write(hsprintf("%g,%g,%g", value->x, value->y, value->z));
+			_context->stream->write(hsprintf("%g,%g,%g", value->x, value->y, value->z));
 		}
 
 		void _dump(Serializable* value)
 		{
 			unsigned int id = 0;
-			if (!_currentHeader.allowMultiReferencing || __tryMapObject(&id, value))
+			if (!_context->header.allowMultiReferencing || __tryMapObject(&id, value))
 			{
 				hstr name = value->_lsName();
 				harray<Variable*> variables = value->_lsVars();
 				int variablesSize = variables.size();
 				if (variablesSize > 0)
 				{
-					if (_currentHeader.allowMultiReferencing)
+					if (_context->header.allowMultiReferencing)
 					{
 						OPEN_NODE(hsprintf("Object name=\"%s\" id=\"%d\"", name.cStr(), id));
 					}
@@ -252,13 +396,13 @@ namespace liteser
 					foreach (Variable*, it, variables)
 					{
 						__dumpVariableStart(*it);
-						__dumpVariable(*it);
+						__dumpValue((*it)->value<char>(), (*it)->type);
 						__dumpVariableFinish(*it);
 						delete (*it);
 					}
 					CLOSE_NODE("Object");
 				}
-				else if (_currentHeader.allowMultiReferencing)
+				else if (_context->header.allowMultiReferencing)
 				{
 					WRITE_NODE(hsprintf("Object name=\"%s\" id=\"%d\"", name.cStr(), id));
 				}
@@ -278,6 +422,11 @@ namespace liteser
 			_dump(*value);
 		}
 
+		void _dump(LazyBase* value)
+		{
+			_dump(value->get());
+		}
+
 		void _dumpHarray(harray<Serializable*>* value)
 		{
 			foreach (Serializable*, it, *value)
@@ -291,7 +440,7 @@ namespace liteser
 			foreach (char, it, *value)
 			{
 				START_LINE("Element value=\"");
-				stream->write((int)(*it));
+				_context->stream->write((int)(*it));
 				FINISH_LINE("\"");
 			}
 		}
@@ -302,7 +451,7 @@ namespace liteser
 			foreach (type, it, *value) \
 			{ \
 				START_LINE("Element value=\""); \
-				stream->write(*it); \
+				_context->stream->write(*it); \
 				FINISH_LINE("\""); \
 			} \
 		}
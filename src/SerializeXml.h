@@ -29,13 +29,24 @@
 
 namespace liteser
 {
+	class LazyBase;
 	class Serializable;
-	class Variable;
 
 	namespace xml
 	{
-		void __dumpContainer(Variable* variable);
+		void __dumpContainer(void* value, Type* type);
 
+		void _dump(char* value);
+		void _dump(unsigned char* value);
+		void _dump(short* value);
+		void _dump(unsigned short* value);
+		void _dump(int* value);
+		void _dump(unsigned int* value);
+		void _dump(int64_t* value);
+		void _dump(uint64_t* value);
+		void _dump(float* value);
+		void _dump(double* value);
+		void _dump(bool* value);
 		void _dump(hstr* value);
 		void _dump(hversion* value);
 		void _dump(henum* value);
@@ -50,6 +61,7 @@ namespace liteser
 		void _dump(gvec3d* value);
 		void _dump(Serializable* value);
 		void _dump(Serializable** value);
+		void _dump(LazyBase* value);
 
 		void _dumpHarray(harray<char>* value);
 		void _dumpHarray(harray<unsigned char>* value);
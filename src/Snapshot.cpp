@@ -0,0 +1,37 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <hltypes/harray.h>
+
+#include "Snapshot.h"
+
+namespace liteser
+{
+	Snapshot::Snapshot()
+	{
+	}
+
+	Snapshot::~Snapshot()
+	{
+	}
+
+	bool Snapshot::isEmpty() const
+	{
+		return (this->objects.size() == 0);
+	}
+
+	void Snapshot::clear()
+	{
+		this->objects.clear();
+		this->schemas.clear();
+		this->fields.clear();
+		this->offsets.clear();
+		this->data.clear();
+	}
+
+}
@@ -10,9 +10,11 @@
 
 #include <hltypes/harray.h>
 #include <hltypes/hmap.h>
+#include <hltypes/hmutex.h>
 #include <hltypes/hstring.h>
 #include <hltypes/hversion.h>
 
+#include "Codec.h"
 #include "liteser.h"
 #include "Type.h"
 
@@ -34,6 +36,7 @@ namespace liteser
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Bool, 0x41);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, ValueObject, 0x61);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Object, 0x62);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, LazyObject, 0x63);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Hstr, 0x81);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Hversion, 0x82);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Henum, 0x83);
@@ -46,12 +49,23 @@ namespace liteser
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Grectd, 0x97);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Gvec2d, 0x98);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Gvec3d, 0x99);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, HalfFloat, 0xB1);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, HalfGvec2f, 0xB2);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, HalfGvec3f, 0xB3);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, HalfGrectf, 0xB4);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, FixedFloat, 0xB5);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, FixedGvec2f, 0xB6);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, FixedGvec3f, 0xB7);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, FixedGrectf, 0xB8);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, SeriesFloat, 0xB9);
+		HL_ENUM_DEFINE_VALUE(Type::Identifier, SeriesDouble, 0xBA);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Harray, 0xA1);
 		HL_ENUM_DEFINE_VALUE(Type::Identifier, Hmap, 0xC1);
 	));
 
 	Type::Type() :
-		identifier(Identifier::None)
+		identifier(Identifier::None),
+		scale(0)
 	{
 	}
 
@@ -188,4 +202,77 @@ namespace liteser
 		this->identifier = Identifier::Object;
 	}
 
+	void Type::assign(VPtr<LazyBase>* arg)
+	{
+		this->identifier = Identifier::LazyObject;
+	}
+
+	void Type::assign(VPtr<Half<float> >* arg)
+	{
+		this->identifier = Identifier::HalfFloat;
+	}
+
+	void Type::assign(VPtr<Half<gvec2f> >* arg)
+	{
+		this->identifier = Identifier::HalfGvec2f;
+	}
+
+	void Type::assign(VPtr<Half<gvec3f> >* arg)
+	{
+		this->identifier = Identifier::HalfGvec3f;
+	}
+
+	void Type::assign(VPtr<Half<grectf> >* arg)
+	{
+		this->identifier = Identifier::HalfGrectf;
+	}
+
+	void Type::assign(VPtr<Series<float> >* arg)
+	{
+		this->identifier = Identifier::SeriesFloat;
+	}
+
+	void Type::assign(VPtr<Series<double> >* arg)
+	{
+		this->identifier = Identifier::SeriesDouble;
+	}
+
+	void Type::_assignFixed(VPtr<float>* arg, int scale)
+	{
+		this->identifier = Identifier::FixedFloat;
+		this->scale = scale;
+	}
+
+	void Type::_assignFixed(VPtr<gvec2f>* arg, int scale)
+	{
+		this->identifier = Identifier::FixedGvec2f;
+		this->scale = scale;
+	}
+
+	void Type::_assignFixed(VPtr<gvec3f>* arg, int scale)
+	{
+		this->identifier = Identifier::FixedGvec3f;
+		this->scale = scale;
+	}
+
+	void Type::_assignFixed(VPtr<grectf>* arg, int scale)
+	{
+		this->identifier = Identifier::FixedGrectf;
+		this->scale = scale;
+	}
+
+	static hmutex __fieldTypesMutex;
+
+	Type* _getSharedFieldType(Type** type, void (*assign)(Type*))
+	{
+		hmutex::ScopeLock lock(&__fieldTypesMutex);
+		if (*type == NULL)
+		{
+			Type* result = new Type();
+			(*assign)(result);
+			*type = result;
+		}
+		return (*type);
+	}
+
 }
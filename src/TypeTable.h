@@ -0,0 +1,141 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Defines the lists of types that all tables indexed by type identifiers are generated from.
+
+#ifndef LITESER_TYPE_TABLE_H
+#define LITESER_TYPE_TABLE_H
+
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hmutex.h>
+
+#include "Context.h"
+#include "Type.h"
+
+// identifiers are stored as a single byte
+#define LITESER_IDENTIFIER_COUNT 256
+
+// a new type is added to one of these lists and gets its entry in every table, X is called with the identifier and the C++ type
+#define LITESER_NUMBER_TYPES(X) \
+	X(Int8, char) \
+	X(UInt8, unsigned char) \
+	X(Int16, short) \
+	X(UInt16, unsigned short) \
+	X(Int32, int) \
+	X(UInt32, unsigned int) \
+	X(Int64, int64_t) \
+	X(UInt64, uint64_t) \
+	X(Float, float) \
+	X(Double, double)
+/// @brief Types that can be keys of an hmap.
+#define LITESER_KEY_TYPES(X) \
+	LITESER_NUMBER_TYPES(X) \
+	X(Hstr, hstr) \
+	X(Hversion, hversion) \
+	X(Henum, henum) \
+	X(Object, Serializable*)
+/// @brief Types that can be elements of an harray or values of an hmap.
+#define LITESER_ELEMENT_TYPES(X) \
+	LITESER_KEY_TYPES(X) \
+	X(Grectf, grectf) \
+	X(Gvec2f, gvec2f) \
+	X(Gvec3f, gvec3f) \
+	X(Grecti, grecti) \
+	X(Gvec2i, gvec2i) \
+	X(Gvec3i, gvec3i) \
+	X(Grectd, grectd) \
+	X(Gvec2d, gvec2d) \
+	X(Gvec3d, gvec3d)
+/// @brief Types that can be variables, containers are handled separately.
+#define LITESER_VALUE_TYPES(X) \
+	LITESER_ELEMENT_TYPES(X) \
+	X(Bool, bool) \
+	X(ValueObject, Serializable) \
+	X(LazyObject, LazyBase)
+/// @brief Types that are stored with less precision, X is called with the type in memory since the wrappers have the same layout.
+#define LITESER_PACKED_TYPES(X) \
+	X(HalfFloat, float) \
+	X(HalfGvec2f, gvec2f) \
+	X(HalfGvec3f, gvec3f) \
+	X(HalfGrectf, grectf) \
+	X(FixedFloat, float) \
+	X(FixedGvec2f, gvec2f) \
+	X(FixedGvec3f, gvec3f) \
+	X(FixedGrectf, grectf)
+/// @brief Types of samples that are stored as the XOR with the previous sample in harrays and as usual otherwise.
+#define LITESER_SERIES_TYPES(X) \
+	X(SeriesFloat, float) \
+	X(SeriesDouble, double)
+
+namespace liteser
+{
+	/// @brief Maps every possible type identifier to a function or a value so dispatching costs a single lookup.
+	template <typename F>
+	class DispatchTable
+	{
+	public:
+		/// @param[in] fallback Entry for identifiers that are not set.
+		inline DispatchTable(F fallback)
+		{
+			for_iter (i, 0, LITESER_IDENTIFIER_COUNT)
+			{
+				this->entries[i] = fallback;
+			}
+		}
+
+		inline void set(const Type::Identifier& identifier, F entry) { this->entries[identifier.value & 0xFF] = entry; }
+		inline const F& get(const Type::Identifier& identifier) const { return this->entries[identifier.value & 0xFF]; }
+
+	protected:
+		F entries[LITESER_IDENTIFIER_COUNT];
+
+	};
+
+	/// @brief Guards the creation of the tables that are shared by all threads.
+	extern hmutex _tablesMutex;
+
+	/// @brief Gets a table that is shared by all threads, created on first use since the identifiers are only initialized during static initialization.
+	/// @note Every thread takes the lock only once and keeps a pointer to the table, so this does not rely on thread-safe local statics which e.g. VS2013 does not have.
+	template <typename T>
+	inline const T& _getTable()
+	{
+		static LITESER_THREAD_LOCAL const T* table = NULL;
+		if (table == NULL)
+		{
+			hmutex::ScopeLock lock(&_tablesMutex);
+			static T sharedTable;
+			table = &sharedTable;
+		}
+		return (*table);
+	}
+
+	/// @brief Properties of a type that do not depend on the format of the data.
+	struct TypeInfo
+	{
+		/// @brief Number of bytes a value always takes, 0 if the size depends on the value.
+		int fixedSize;
+		/// @brief Types of the same group can be loaded into each other, 0 if the type can only be loaded into itself.
+		int compatibilityGroup;
+		/// @brief Number of integers a value consists of that are stored as varints in compact data, 0 if it is always stored with its fixed size.
+		int varintCount;
+
+		inline TypeInfo(int fixedSize = 0, int compatibilityGroup = 0, int varintCount = 0) : fixedSize(fixedSize), compatibilityGroup(compatibilityGroup), varintCount(varintCount)
+		{
+		}
+
+	};
+
+	/// @brief Gets the properties of all types, created on first use.
+	const DispatchTable<TypeInfo>& _getTypeInfos();
+	/// @brief Gets the sizes of all number types, 0 for all other types, created on first use.
+	const DispatchTable<int>& _getNumberSizes();
+
+}
+#endif
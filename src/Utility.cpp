@@ -9,8 +9,10 @@
 #include <hltypes/harray.h>
 #include <hltypes/hlog.h>
 #include <hltypes/hmap.h>
+#include <hltypes/hmutex.h>
 #include <hltypes/hsbase.h>
 
+#include "Context.h"
 #include "liteser.h"
 #include "Serializable.h"
 #include "Utility.h"
@@ -18,43 +20,113 @@
 namespace liteser
 {
 	unsigned char fileDescriptor[4] = { 'L', 'S', 'B', 'D' }; // Lite Serializer Binary Data
-	harray<harray<Type::Identifier> > compatibleIdentifiers;
-	hsbase* stream = NULL;
-	Header _currentHeader;
 
-	// this hybrid implementation for indexing gave the best results in benchmarking with larger files
-	harray<Serializable*> objects;
-	harray<hstr> strings;
-	hmap<Serializable*, unsigned int> objectIds;
-	hmap<hstr, unsigned int> stringIds;
-	hstr _indent = "\t";
+	class TypeInfos : public DispatchTable<TypeInfo>
+	{
+	public:
+		TypeInfos() : DispatchTable<TypeInfo>(TypeInfo())
+		{
+			// single bytes are never stored as varints
+			this->set(Type::Identifier::Int8, TypeInfo(1, 1));
+			this->set(Type::Identifier::UInt8, TypeInfo(1, 1));
+			this->set(Type::Identifier::Int16, TypeInfo(2, 1, 1));
+			this->set(Type::Identifier::UInt16, TypeInfo(2, 1, 1));
+			this->set(Type::Identifier::Int32, TypeInfo(4, 1, 1));
+			this->set(Type::Identifier::UInt32, TypeInfo(4, 1, 1));
+			this->set(Type::Identifier::Int64, TypeInfo(8, 1, 1));
+			this->set(Type::Identifier::UInt64, TypeInfo(8, 1, 1));
+			this->set(Type::Identifier::Float, TypeInfo(4, 2));
+			this->set(Type::Identifier::Double, TypeInfo(8, 2));
+			this->set(Type::Identifier::Bool, TypeInfo(1, 0));
+			this->set(Type::Identifier::Hversion, TypeInfo(16, 0, 4));
+			this->set(Type::Identifier::Henum, TypeInfo(4, 0, 1));
+			this->set(Type::Identifier::Gvec2f, TypeInfo(8, 3));
+			this->set(Type::Identifier::Gvec2i, TypeInfo(8, 3, 2));
+			this->set(Type::Identifier::Gvec2d, TypeInfo(16, 3));
+			this->set(Type::Identifier::Gvec3f, TypeInfo(12, 4));
+			this->set(Type::Identifier::Gvec3i, TypeInfo(12, 4, 3));
+			this->set(Type::Identifier::Gvec3d, TypeInfo(24, 4));
+			this->set(Type::Identifier::Grectf, TypeInfo(16, 5));
+			this->set(Type::Identifier::Grecti, TypeInfo(16, 5, 4));
+			this->set(Type::Identifier::Grectd, TypeInfo(32, 5));
+			// packed values can be loaded into the full types of the same shape and back
+			this->set(Type::Identifier::HalfFloat, TypeInfo(2, 2));
+			this->set(Type::Identifier::HalfGvec2f, TypeInfo(4, 3));
+			this->set(Type::Identifier::HalfGvec3f, TypeInfo(6, 4));
+			this->set(Type::Identifier::HalfGrectf, TypeInfo(8, 5));
+			this->set(Type::Identifier::FixedFloat, TypeInfo(2, 2));
+			this->set(Type::Identifier::FixedGvec2f, TypeInfo(4, 3));
+			this->set(Type::Identifier::FixedGvec3f, TypeInfo(6, 4));
+			this->set(Type::Identifier::FixedGrectf, TypeInfo(8, 5));
+			this->set(Type::Identifier::SeriesFloat, TypeInfo(4, 2));
+			this->set(Type::Identifier::SeriesDouble, TypeInfo(8, 2));
+			// object variables can be changed to lazy objects and back
+			this->set(Type::Identifier::Object, TypeInfo(0, 6));
+			this->set(Type::Identifier::LazyObject, TypeInfo(0, 6));
+		}
+
+	};
+
+	hmutex _tablesMutex;
+
+	const DispatchTable<TypeInfo>& _getTypeInfos()
+	{
+		return _getTable<TypeInfos>();
+	}
+
+	class NumberSizes : public DispatchTable<int>
+	{
+	public:
+		NumberSizes() : DispatchTable<int>(0)
+		{
+#define SET_SIZE(name, type) this->set(Type::Identifier::name, (int)sizeof(type));
+			LITESER_NUMBER_TYPES(SET_SIZE)
+#undef SET_SIZE
+		}
+
+	};
+
+	const DispatchTable<int>& _getNumberSizes()
+	{
+		return _getTable<NumberSizes>();
+	}
 
 	void _checkVersion()
 	{
-		if (_currentHeader.version.major >= 3)
+		if (_context->header.version.major >= 3)
 		{
-			if (_currentHeader.version.major != liteser::version.major)
+			if (_context->header.version.major != liteser::version.major)
 			{
 				throw Exception(hsprintf("Liteser Read Error! Version mismatch: expected %d.%d, got %d.%d",
-					liteser::version.major, liteser::version.minor, _currentHeader.version.major, _currentHeader.version.minor));
+					liteser::version.major, liteser::version.minor, _context->header.version.major, _context->header.version.minor));
 			}
-			if (_currentHeader.version.minor < liteser::version.minor)
+			if (_context->header.version.minor < liteser::version.minor)
 			{
 				hlog::warnf(logTag, "Minor version mismatch while loading: expected %d.%d, got %d.%d",
-					liteser::version.major, liteser::version.minor, _currentHeader.version.major, _currentHeader.version.minor);
+					liteser::version.major, liteser::version.minor, _context->header.version.major, _context->header.version.minor);
 			}
 		}
 		else
 		{
-			if (_currentHeader.version.major != 2)
+			if (_context->header.version.major != 2)
 			{
-				throw Exception(hsprintf("Liteser Read Error! Version mismatch: expected 2.7, got %d.%d", _currentHeader.version.major, _currentHeader.version.minor));
+				throw Exception(hsprintf("Liteser Read Error! Version mismatch: expected 2.7, got %d.%d", _context->header.version.major, _context->header.version.minor));
 			}
-			if (_currentHeader.version.minor < 7)
+			if (_context->header.version.minor < 7)
 			{
-				hlog::warnf(logTag, "Minor version mismatch while loading: expected 2.7, got %d.%d", _currentHeader.version.major, _currentHeader.version.minor);
+				hlog::warnf(logTag, "Minor version mismatch while loading: expected 2.7, got %d.%d", _context->header.version.major, _context->header.version.minor);
 			}
 		}
 	}
 
+	void _beginCompression()
+	{
+		// the outermost block is only finished at the end, so nothing can be compressed before that
+		if (_context->header.lengthPrefixed)
+		{
+			hlog::warn(logTag, "Length prefixed data is kept in memory until it is finished and only compressed then!");
+		}
+		_context->writer.beginCompression();
+	}
+
 }
@@ -13,31 +13,44 @@
 #ifndef LITESER_UTILITY_H
 #define LITESER_UTILITY_H
 
+#include <stdint.h>
+#include <string.h>
+
 #include <hltypes/harray.h>
+#include <hltypes/hltypesUtil.h>
 #include <hltypes/hmap.h>
 #include <hltypes/hsbase.h>
 #include <hltypes/hstring.h>
 #include <hlxml/Node.h>
 
+#include "Context.h"
 #include "Header.h"
+#include "Reader.h"
+#include "Schema.h"
 #include "Type.h"
+#include "TypeTable.h"
 #include "Variable.h"
 
+// max number of bytes transferred with a single raw read/write call
+#define LITESER_RAW_BLOCK_SIZE 65536
+// sizeof(unsigned int) * 2 + 2 bools
+#define LITESER_HEADER_SIZE 10
+// object ID that marks a reference to an object of another element in indexed data
+#define LITESER_ELEMENT_REFERENCE 0xFFFFFFFF
+// size of a block and the number of object IDs it assigns
+#define LITESER_BLOCK_PREFIX_SIZE 8
+// set in the size of a block that adds pooled strings or class layouts, these have to be decoded even if the block is skipped
+#define LITESER_BLOCK_REGISTERS 0x80000000
+
 namespace liteser
 {
 	class Serializable;
 
 	extern unsigned char fileDescriptor[4]; // Lite Serializer Binary Data
-	extern harray<harray<Type::Identifier> > compatibleIdentifiers;
-	extern hsbase* stream;
-	extern Header _currentHeader;
-	extern harray<Serializable*> objects;
-	extern harray<hstr> strings;
-	extern hmap<Serializable*, unsigned int> objectIds;
-	extern hmap<hstr, unsigned int> stringIds;
-	extern hstr _indent;
 
 	void _checkVersion();
+	/// @brief Everything that is written from now on is compressed.
+	void _beginCompression();
 
 	inline bool __tryGetObject(unsigned int id, Serializable** object)
 	{
@@ -46,11 +59,11 @@ namespace liteser
 			*object = NULL;
 			return true;
 		}
-		if ((int)id - 1 >= objects.size())
+		if ((int)id - 1 >= _context->objects.size())
 		{
 			return false;
 		}
-		*object = objects[id - 1];
+		*object = _context->objects[id - 1];
 		return true;
 	}
 
@@ -61,16 +74,10 @@ namespace liteser
 			*id = 0;
 			return false;
 		}
-		int index = objectIds.tryGet(object, -1);
-		if (index < 0)
-		{
-			objects += object;
-			*id = objects.size();
-			objectIds[object] = *id - 1;
-			return true;
-		}
+		int index = -1;
+		bool added = _context->objectIds->tryAdd(object, &index);
 		*id = index + 1;
-		return false;
+		return added;
 	}
 
 	inline bool __tryGetString(unsigned int id, hstr* string)
@@ -80,11 +87,21 @@ namespace liteser
 			*string = "";
 			return true;
 		}
-		if ((int)id - 1 >= strings.size())
+		int count = _context->stringOffsets.size();
+		if ((int)id - 1 >= count)
 		{
 			return false;
 		}
-		*string = strings[id - 1];
+		int offset = _context->stringOffsets[id - 1];
+		int end = ((int)id < count ? _context->stringOffsets[id] : _context->stringData.size());
+		if (end > offset)
+		{
+			string->assign(&_context->stringData[offset], (size_t)(end - offset));
+		}
+		else
+		{
+			string->clear();
+		}
 		return true;
 	}
 	
@@ -95,53 +112,111 @@ namespace liteser
 			*id = 0;
 			return false;
 		}
-		int index = stringIds.tryGet(string, -1);
+		int index = -1;
+		bool added = _context->stringIds->tryAdd(string, &index);
+		*id = index + 1;
+		return added;
+	}
+
+	inline bool __tryGetStoredSchema(unsigned int id, StoredSchema** schema)
+	{
+		if (id == 0)
+		{
+			throw Exception("Invalid schema ID!");
+		}
+		if ((int)id - 1 >= _context->storedSchemas.size())
+		{
+			return false;
+		}
+		*schema = _context->storedSchemas[id - 1];
+		return true;
+	}
+
+	inline bool __tryMapSchema(unsigned int* id, Schema* schema)
+	{
+		int index = _context->schemaIds.tryGet(schema, -1);
 		if (index < 0)
 		{
-			strings += string;
-			*id = strings.size();
-			stringIds[string] = *id - 1;
+			*id = _context->schemaIds.size() + 1;
+			_context->schemaIds[schema] = *id - 1;
 			return true;
 		}
 		*id = index + 1;
 		return false;
 	}
 
-	inline void __forceMapEmptyObject()
+	inline uint64_t __makeElementReference(unsigned int element, unsigned int id)
+	{
+		return (((uint64_t)element << 32) | id);
+	}
+
+	/// @brief Since version 3.2 every class layout is stored only once and objects store their variables by position.
+	inline bool _hasSchemaTable()
+	{
+		return (_context->header.version.major > 3 || (_context->header.version.major == 3 && _context->header.version.minor >= 2));
+	}
+
+	inline void _swapBytes(unsigned char* data, int elementSize, int count)
+	{
+		unsigned char temp = 0;
+		for_iter (i, 0, count)
+		{
+			for_iter (j, 0, elementSize / 2)
+			{
+				temp = data[j];
+				data[j] = data[elementSize - 1 - j];
+				data[elementSize - 1 - j] = temp;
+			}
+			data += elementSize;
+		}
+	}
+
+	/// @brief Registers a loaded object under the next ID.
+	inline void __addObject(Serializable* object)
 	{
-		objects += NULL;
+		_context->objects += object;
 	}
 
-	inline void _start(hsbase* stream)
+	/// @brief Allocates the whole string pool at once, the sizes from the header are only trusted as far as the remaining data could hold them.
+	inline void __reserveStrings()
 	{
-		objects.clear();
-		strings.clear();
-		objectIds.clear();
-		stringIds.clear();
-		liteser::stream = stream;
-		_indent = "\t";
+		int64_t remaining = _context->reader.available();
+		// every pooled string takes at least its ID, its size and one character
+		_context->stringOffsets.reserve((int)hmin((int64_t)_context->header.stringCount, remaining / 9 + 1));
+		_context->stringData.reserve((int)hmin((int64_t)_context->header.stringSize, remaining));
+	}
+
+	/// @brief Registers a loaded string under the next ID.
+	inline void __addString(const char* data, int size)
+	{
+		if (_context->stringOffsets.size() == 0)
+		{
+			__reserveStrings();
+		}
+		int offset = _context->stringData.size();
+		_context->stringOffsets += offset;
+		if (size > 0)
+		{
+			_context->stringData.add((char)0, size);
+			memcpy(&_context->stringData[offset], data, size);
+		}
 	}
 
-	inline void _finish(hsbase* stream)
+	inline void __forceMapEmptyObject()
 	{
-		objects.clear();
-		strings.clear();
-		objectIds.clear();
-		stringIds.clear();
-		liteser::stream = NULL;
-		_indent = "\t";
+		_context->objects += NULL;
 	}
 
 	inline void _setup(hsbase* stream, const Header& header)
 	{
-		_currentHeader = header;
+		_context->header = header;
 	}
 
-	inline void _readHeader(hsbase* stream, Header& header)
+	inline void _readHeader(Reader& reader, Header& header)
 	{
 		unsigned char readFileDescriptor[sizeof(fileDescriptor)];
-		stream->readRaw(readFileDescriptor, sizeof(fileDescriptor));
-		if (readFileDescriptor[0] != fileDescriptor[0] || readFileDescriptor[1] != fileDescriptor[1])
+		if (reader.readRaw(readFileDescriptor, sizeof(fileDescriptor)) != sizeof(fileDescriptor) ||
+			readFileDescriptor[0] != fileDescriptor[0] || readFileDescriptor[1] != fileDescriptor[1])
 		{
 			throw Exception("Invalid file descriptor!");
 		}
@@ -149,13 +224,60 @@ namespace liteser
 		unsigned char compatibilityVersionMinor = readFileDescriptor[3];
 		if (compatibilityVersionMajor == fileDescriptor[2] && compatibilityVersionMinor == fileDescriptor[3])
 		{
-			stream->loadUint32();
+			unsigned int headerSize = reader.loadUint32();
 			// this is for version 3.0, header size should be sizeof(unsigned int) * 2 + 2 bools (no checks currently performed)
 			header.version.set(0);
-			header.version.major = stream->loadUint32();
-			header.version.minor = stream->loadUint32();
-			header.allowMultiReferencing = stream->loadBool();
-			header.stringPooling = stream->loadBool();
+			header.version.major = reader.loadUint32();
+			header.version.minor = reader.loadUint32();
+			header.allowMultiReferencing = reader.loadBool();
+			header.stringPooling = reader.loadBool();
+			header.compressed = false;
+			header.indexed = false;
+			header.lengthPrefixed = false;
+			header.delta = false;
+			header.columnar = false;
+			header.encodedArrays = false;
+			header.compactIntegers = false;
+			// later fields are only stored if they or a field after them are used so data without them stays the same as before
+			if (headerSize > LITESER_HEADER_SIZE)
+			{
+				header.compressed = reader.loadBool();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 1)
+			{
+				header.indexed = reader.loadBool();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 2)
+			{
+				header.lengthPrefixed = reader.loadBool();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 3)
+			{
+				header.delta = reader.loadBool();
+			}
+			header.stringCount = 0;
+			header.stringSize = 0;
+			if (headerSize >= LITESER_HEADER_SIZE + 12)
+			{
+				header.stringCount = reader.loadUint32();
+				header.stringSize = reader.loadUint32();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 12)
+			{
+				header.columnar = reader.loadBool();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 13)
+			{
+				header.encodedArrays = reader.loadBool();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 14)
+			{
+				header.compactIntegers = reader.loadBool();
+			}
+			if (headerSize > LITESER_HEADER_SIZE + 15)
+			{
+				reader.skip(headerSize - LITESER_HEADER_SIZE - 15);
+			}
 		}
 		else // backwards compatibility with 2.x versions
 		{
@@ -165,14 +287,107 @@ namespace liteser
 		}
 	}
 
-	inline void _writeHeader(hsbase* stream, Header& header)
+	inline void _writeHeader(Writer& writer, Header& header)
 	{
-		stream->writeRaw(fileDescriptor, sizeof(fileDescriptor));
-		stream->dump((unsigned int)(sizeof(unsigned int) * 2 + 2)); // sizeof(unsigned int) * 2 + 2 bools
-		stream->dump(header.version.major);
-		stream->dump(header.version.minor);
-		stream->dump(header.allowMultiReferencing);
-		stream->dump(header.stringPooling);
+		writer.writeRaw(fileDescriptor, sizeof(fileDescriptor));
+		unsigned int headerSize = LITESER_HEADER_SIZE;
+		if (header.compactIntegers)
+		{
+			headerSize += 15;
+		}
+		else if (header.encodedArrays)
+		{
+			headerSize += 14;
+		}
+		else if (header.columnar)
+		{
+			headerSize += 13;
+		}
+		else if (header.stringPooling && header.stringPoolSize)
+		{
+			headerSize += 12;
+		}
+		else if (header.delta)
+		{
+			headerSize += 4;
+		}
+		else if (header.lengthPrefixed)
+		{
+			headerSize += 3;
+		}
+		else if (header.indexed)
+		{
+			headerSize += 2;
+		}
+		else if (header.compressed)
+		{
+			headerSize += 1;
+		}
+		writer.dump(headerSize);
+		writer.dump(header.version.major);
+		writer.dump(header.version.minor);
+		writer.dump(header.allowMultiReferencing);
+		writer.dump(header.stringPooling);
+		if (headerSize > LITESER_HEADER_SIZE)
+		{
+			writer.dump(header.compressed);
+		}
+		if (headerSize > LITESER_HEADER_SIZE + 1)
+		{
+			writer.dump(header.indexed);
+		}
+		if (headerSize > LITESER_HEADER_SIZE + 2)
+		{
+			writer.dump(header.lengthPrefixed);
+		}
+		if (headerSize > LITESER_HEADER_SIZE + 3)
+		{
+			writer.dump(header.delta);
+		}
+		// the size of the string pool is only known at the end and stored by _finishHeader(), it stays 0 if it was not requested
+		if (headerSize > LITESER_HEADER_SIZE + 4)
+		{
+			writer.dump(header.stringCount);
+			writer.dump(header.stringSize);
+		}
+		if (headerSize > LITESER_HEADER_SIZE + 12)
+		{
+			writer.dump(header.columnar);
+		}
+		if (headerSize > LITESER_HEADER_SIZE + 13)
+		{
+			writer.dump(header.encodedArrays);
+		}
+		if (headerSize > LITESER_HEADER_SIZE + 14)
+		{
+			writer.dump(header.compactIntegers);
+		}
+	}
+
+	/// @brief Gets the size of the string pool after all strings were written.
+	inline void _countStrings(Header& header)
+	{
+		int count = _context->stringIds->size();
+		int64_t size = 0;
+		for_iter (i, 0, count)
+		{
+			size += (*_context->stringIds)[i].size();
+		}
+		header.stringCount = (unsigned int)count;
+		header.stringSize = (unsigned int)hmin(size, (int64_t)0xFFFFFFFF);
+	}
+
+	/// @brief Stores the size of the string pool in the header that was written at the start of the output if it was requested.
+	/// @note The stream has to be sought back for this, without it the output is written to the stream strictly in order.
+	inline void _finishHeader(Writer& writer, Header& header)
+	{
+		if (header.stringPooling && header.stringPoolSize)
+		{
+			_countStrings(header);
+			int64_t position = sizeof(fileDescriptor) + sizeof(unsigned int) + LITESER_HEADER_SIZE + 4;
+			writer.overwriteUint32(position, header.stringCount);
+			writer.overwriteUint32(position + sizeof(unsigned int), header.stringSize);
+		}
 	}
 
 	inline void _readXmlHeader(hlxml::Node* root, Header& header)
@@ -199,61 +414,92 @@ namespace liteser
 
 	inline bool _isActive()
 	{
-		return (stream != NULL);
+		return (_context != NULL);
 	}
 
-	inline Type::Identifier _loadIdentifier()
+	/// @brief Gets the number of varints a value of the type is stored as, 0 if it is stored with its fixed size.
+	inline int _getVarintCount(const Type::Identifier& identifier)
 	{
-		return Type::Identifier::fromUint((unsigned int)stream->loadUint8());
+		return (_context->header.compactIntegers ? _getTypeInfos().get(identifier).varintCount : 0);
 	}
 
-	inline void __setupCompatibleIdentifiers()
+	/// @brief Gets the number of bytes a value of the type always takes, 0 if the size depends on the value.
+	inline int _getFixedSize(const Type::Identifier& identifier)
 	{
-		harray<Type::Identifier> identifiers;
-		identifiers += Type::Identifier::Int8;
-		identifiers += Type::Identifier::UInt8;
-		identifiers += Type::Identifier::Int16;
-		identifiers += Type::Identifier::UInt16;
-		identifiers += Type::Identifier::Int32;
-		identifiers += Type::Identifier::UInt32;
-		identifiers += Type::Identifier::Int64;
-		identifiers += Type::Identifier::UInt64;
-		compatibleIdentifiers += identifiers;
-		identifiers.clear();
-		identifiers += Type::Identifier::Float;
-		identifiers += Type::Identifier::Double;
-		compatibleIdentifiers += identifiers;
-		identifiers.clear();
-		identifiers += Type::Identifier::Gvec2f;
-		identifiers += Type::Identifier::Gvec2i;
-		identifiers += Type::Identifier::Gvec2d;
-		compatibleIdentifiers += identifiers;
-		identifiers.clear();
-		identifiers += Type::Identifier::Gvec3f;
-		identifiers += Type::Identifier::Gvec3i;
-		identifiers += Type::Identifier::Gvec3d;
-		compatibleIdentifiers += identifiers;
-		identifiers.clear();
-		identifiers += Type::Identifier::Grectf;
-		identifiers += Type::Identifier::Grecti;
-		identifiers += Type::Identifier::Grectd;
-		compatibleIdentifiers += identifiers;
+		const TypeInfo& info = _getTypeInfos().get(identifier);
+		return ((info.varintCount > 0 && _context->header.compactIntegers) ? 0 : info.fixedSize);
 	}
 
-	inline bool _isCompatibleType(const Type::Identifier& variableIdentifier, const Type::Identifier& loadedIdentifier)
+	/// @brief Gets the size of a number type that is stored the same way it is kept in memory, 0 for all other types.
+	inline int _getNumberSize(const Type::Identifier& identifier)
+	{
+		return _getNumberSizes().get(identifier);
+	}
+
+	/// @brief Whether the elements of a harray are stored with an encoding, only integers are encoded.
+	inline bool _isEncodedArray(const Type::Identifier& subIdentifier)
+	{
+		return (_context->header.encodedArrays && _getNumberSize(subIdentifier) > 0 &&
+			subIdentifier != Type::Identifier::Float && subIdentifier != Type::Identifier::Double);
+	}
+
+	/// @brief Whether a harray of the type is prefixed with its size in length prefixed data, values with a fixed size and encoded integers can be skipped without it.
+	inline bool _hasBlockPrefix(const Type::Identifier& subIdentifier)
 	{
-		if (compatibleIdentifiers.size() == 0)
+		return (_context->header.lengthPrefixed && _getFixedSize(subIdentifier) == 0 && !_isEncodedArray(subIdentifier));
+	}
+
+	/// @brief Writes an ID, a size or a count, most of them are small so compact data stores them as varints.
+	inline void _dumpCount(unsigned int value)
+	{
+		if (_context->header.compactIntegers)
 		{
-			__setupCompatibleIdentifiers();
+			_context->writer.dumpVarint(value);
 		}
-		foreach (harray<Type::Identifier>, it, compatibleIdentifiers)
+		else
 		{
-			if ((*it).has(variableIdentifier) && (*it).has(loadedIdentifier))
-			{
-				return true;
-			}
+			_context->writer.dump(value);
 		}
-		return false;
+	}
+
+	inline unsigned int _loadCount()
+	{
+		if (!_context->header.compactIntegers)
+		{
+			return _context->reader.loadUint32();
+		}
+		uint64_t value = _context->reader.loadVarint();
+		if (value > 0xFFFFFFFF)
+		{
+			throw Exception("Invalid varint for an ID, a size or a count!");
+		}
+		return (unsigned int)value;
+	}
+
+	/// @brief Whether values of the type are stored as fixed point numbers, the scale is stored after their type identifier.
+	inline bool _isFixedPoint(const Type::Identifier& identifier)
+	{
+		return (identifier == Type::Identifier::FixedFloat || identifier == Type::Identifier::FixedGvec2f ||
+			identifier == Type::Identifier::FixedGvec3f || identifier == Type::Identifier::FixedGrectf);
+	}
+
+	/// @param[out] scale Scale of fixed point numbers, 0 for all other types. The scale is always read so it can be NULL if not needed.
+	inline Type::Identifier _loadIdentifier(int* scale = NULL)
+	{
+		Type::Identifier identifier = Type::Identifier::fromUint((unsigned int)_context->reader.loadUint8());
+		int loadedScale = (_isFixedPoint(identifier) ? (int)_loadCount() : 0);
+		if (scale != NULL)
+		{
+			*scale = loadedScale;
+		}
+		return identifier;
+	}
+
+	inline bool _isCompatibleType(const Type::Identifier& variableIdentifier, const Type::Identifier& loadedIdentifier)
+	{
+		const DispatchTable<TypeInfo>& infos = _getTypeInfos();
+		int group = infos.get(variableIdentifier).compatibilityGroup;
+		return (group != 0 && group == infos.get(loadedIdentifier).compatibilityGroup);
 	}
 
 }
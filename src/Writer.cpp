@@ -0,0 +1,337 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+
+#include <string.h>
+
+#include <hltypes/hexception.h>
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hsbase.h>
+
+#include "Compression.h"
+#include "Writer.h"
+
+// the buffer starts small so small objects don't allocate much
+#define LITESER_WRITE_BUFFER_MIN 4096
+// the buffer is flushed once it would have to grow past this
+#define LITESER_WRITE_BUFFER_MAX 262144
+// compressed output is collected until there are enough blocks for all compression threads, the next part is collected while it is compressed
+#define LITESER_WRITE_BUFFER_MAX_COMPRESSED (LITESER_COMPRESSION_BLOCK_SIZE * LITESER_COMPRESSION_THREADS)
+// the buffer grows by at most this much at once once it is this large
+#define LITESER_WRITE_BUFFER_GROWTH_LIMIT 268435456
+// output is passed to streams in parts of this size
+#define LITESER_WRITE_BLOCK_SIZE 1073741824
+
+namespace liteser
+{
+	/// @brief Passes output to a stream in parts that fit the size hsbase::writeRaw() takes.
+	static void __writeStream(hsbase* stream, const unsigned char* data, int64_t size)
+	{
+		int blockSize = 0;
+		while (size > 0)
+		{
+			blockSize = (int)hmin(size, (int64_t)LITESER_WRITE_BLOCK_SIZE);
+			stream->writeRaw(data, blockSize);
+			data += blockSize;
+			size -= blockSize;
+		}
+	}
+
+	Writer::Writer() :
+		stream(NULL),
+		buffer(NULL),
+		size(0),
+		capacity(0),
+		flushed(0),
+		written(0),
+		compressedFrom(-1),
+		pendingPatches(0),
+		compressed(false),
+		compressionBuffer(NULL),
+		compressionCapacity(0),
+		spareBuffer(NULL),
+		spareCapacity(0),
+		compressing(false)
+	{
+	}
+
+	Writer::~Writer()
+	{
+		// the threads could still be reading the buffer and writing into the compression buffer
+		if (this->compressing)
+		{
+			CompressionPool::getShared().wait(&this->compressionJob);
+		}
+		if (this->buffer != NULL)
+		{
+			delete[] this->buffer;
+		}
+		if (this->compressionBuffer != NULL)
+		{
+			delete[] this->compressionBuffer;
+		}
+		if (this->spareBuffer != NULL)
+		{
+			delete[] this->spareBuffer;
+		}
+	}
+
+	void Writer::open(hsbase* stream)
+	{
+		// blocks of output that was not finished are dropped
+		if (this->compressing)
+		{
+			this->compressing = false;
+			CompressionPool::getShared().wait(&this->compressionJob);
+		}
+		this->stream = stream;
+		this->size = 0;
+		this->flushed = 0;
+		this->written = 0;
+		this->compressedFrom = -1;
+		this->pendingPatches = 0;
+		this->compressed = false;
+	}
+
+	void Writer::writeRaw(const void* data, int count)
+	{
+		if (count <= 0)
+		{
+			return;
+		}
+		// large blocks go directly to the stream instead of being copied into the buffer first
+		if (count >= LITESER_WRITE_BUFFER_MAX && !this->compressed && this->_canFlush())
+		{
+			this->flush();
+			this->stream->writeRaw(data, count);
+			this->flushed += count;
+			this->written += count;
+			return;
+		}
+		memcpy(this->_advance(count), data, count);
+	}
+
+	int64_t Writer::reserveUint32()
+	{
+		int64_t result = this->position();
+		this->_dump(0u);
+		++this->pendingPatches;
+		return result;
+	}
+
+	void Writer::patchUint32(int64_t position, unsigned int value)
+	{
+		if (position < this->flushed)
+		{
+			// the block was already passed to the stream before it was finished
+			this->overwriteUint32(position, value);
+			--this->pendingPatches;
+			return;
+		}
+		if (position + (int64_t)sizeof(unsigned int) > this->position())
+		{
+			throw Exception("Cannot patch data that is not in the write buffer!");
+		}
+		int64_t size = this->size;
+		this->size = position - this->flushed;
+		this->_dump(value);
+		this->size = size;
+		--this->pendingPatches;
+	}
+
+	void Writer::overwriteUint32(int64_t position, unsigned int value)
+	{
+		unsigned char data[sizeof(unsigned int)];
+		Writer::_encodeUint32(data, value);
+		this->_overwrite(position, data, sizeof(data));
+	}
+
+	void Writer::overwriteUint64(int64_t position, uint64_t value)
+	{
+		unsigned char data[sizeof(uint64_t)];
+		Writer::_encodeUint64(data, value);
+		this->_overwrite(position, data, sizeof(data));
+	}
+
+	void Writer::_overwrite(int64_t position, const unsigned char* data, int count)
+	{
+		if (position < 0 || position + count > this->position())
+		{
+			throw Exception("Cannot overwrite data that was not written yet!");
+		}
+		if (position >= this->flushed)
+		{
+			memcpy(this->buffer + (position - this->flushed), data, count);
+			return;
+		}
+		// compressed output has a different size in the stream, only what is before it stays where it was written
+		if (this->compressedFrom >= 0 && position + count > this->compressedFrom)
+		{
+			throw Exception("Cannot overwrite data that was already compressed!");
+		}
+		// the stream is at the end of the output that was passed to it
+		this->stream->seek(position - this->written);
+		this->stream->writeRaw(data, count);
+		this->stream->seek(this->written - position - count);
+	}
+
+	void Writer::flush()
+	{
+		if (this->compressed)
+		{
+			this->_flushCompressed();
+		}
+		else if (this->size > 0 && this->stream != NULL)
+		{
+			__writeStream(this->stream, this->buffer, this->size);
+			this->flushed += this->size;
+			this->written += this->size;
+			this->size = 0;
+		}
+	}
+
+	void Writer::beginCompression()
+	{
+		this->flush();
+		if (this->compressedFrom < 0)
+		{
+			this->compressedFrom = this->position();
+		}
+		this->compressed = true;
+	}
+
+	void Writer::endCompression()
+	{
+		this->flush();
+		this->_writeCompressed();
+		this->compressed = false;
+		this->_dump(0u); // a block with no data ends the compressed blocks
+	}
+
+	void Writer::_flushCompressed()
+	{
+		if (this->size == 0 || this->stream == NULL)
+		{
+			return;
+		}
+		// the previous part has to be written first and its buffer becomes the spare buffer again
+		this->_writeCompressed();
+		int64_t count = (this->size + LITESER_COMPRESSION_BLOCK_SIZE - 1) / LITESER_COMPRESSION_BLOCK_SIZE;
+		if (this->compressionCapacity < count * LITESER_COMPRESSION_BLOCK_SIZE)
+		{
+			if (this->compressionBuffer != NULL)
+			{
+				delete[] this->compressionBuffer;
+			}
+			this->compressionCapacity = hmax(count * LITESER_COMPRESSION_BLOCK_SIZE, (int64_t)LITESER_WRITE_BUFFER_MAX_COMPRESSED);
+			this->compressionBuffer = new unsigned char[(size_t)this->compressionCapacity];
+		}
+		this->compressionJob.blocks.clear();
+		this->compressionJob.compress = true;
+		int64_t offset = 0;
+		int blockSize = 0;
+		for_itert (int64_t, i, 0, count)
+		{
+			offset = i * LITESER_COMPRESSION_BLOCK_SIZE;
+			blockSize = (int)hmin(this->size - offset, (int64_t)LITESER_COMPRESSION_BLOCK_SIZE);
+			// a block is stored uncompressed if it does not get smaller
+			this->compressionJob.blocks += CompressionBlock(this->buffer + offset, blockSize, this->compressionBuffer + offset, blockSize - 1);
+		}
+		CompressionPool::getShared().start(&this->compressionJob);
+		this->compressing = true;
+		// serializing continues in the other buffer while this one is compressed
+		unsigned char* buffer = this->buffer;
+		this->buffer = this->spareBuffer;
+		this->spareBuffer = buffer;
+		int64_t capacity = this->capacity;
+		this->capacity = this->spareCapacity;
+		this->spareCapacity = capacity;
+		this->flushed += this->size;
+		this->size = 0;
+	}
+
+	void Writer::_writeCompressed()
+	{
+		if (!this->compressing)
+		{
+			return;
+		}
+		this->compressing = false;
+		CompressionPool::getShared().wait(&this->compressionJob);
+		unsigned char blockHeader[sizeof(unsigned int) * 2];
+		foreach (CompressionBlock, it, this->compressionJob.blocks)
+		{
+			Writer::_encodeUint32(blockHeader, (unsigned int)(*it).sourceSize);
+			Writer::_encodeUint32(blockHeader + sizeof(unsigned int), (unsigned int)(*it).result);
+			this->stream->writeRaw(blockHeader, sizeof(blockHeader));
+			if ((*it).result > 0)
+			{
+				this->stream->writeRaw((*it).destination, (*it).result);
+				this->written += sizeof(blockHeader) + (*it).result;
+			}
+			else
+			{
+				this->stream->writeRaw((*it).source, (*it).sourceSize);
+				this->written += sizeof(blockHeader) + (*it).sourceSize;
+			}
+		}
+	}
+
+	void Writer::_encodeUint32(unsigned char* data, unsigned int value)
+	{
+		data[0] = (unsigned char)(value & 0xFF);
+		data[1] = (unsigned char)((value >> 8) & 0xFF);
+		data[2] = (unsigned char)((value >> 16) & 0xFF);
+		data[3] = (unsigned char)((value >> 24) & 0xFF);
+	}
+
+	void Writer::_encodeUint64(unsigned char* data, uint64_t value)
+	{
+		Writer::_encodeUint32(data, (unsigned int)(value & 0xFFFFFFFF));
+		Writer::_encodeUint32(data + sizeof(unsigned int), (unsigned int)(value >> 32));
+	}
+
+	void Writer::_makeRoom(int64_t count)
+	{
+		int64_t maxCapacity = (this->compressed ? LITESER_WRITE_BUFFER_MAX_COMPRESSED : LITESER_WRITE_BUFFER_MAX);
+		if (this->capacity >= maxCapacity && this->_canFlush())
+		{
+			this->flush();
+			if (this->size + count <= this->capacity)
+			{
+				return;
+			}
+		}
+		// without a stream the output stays in memory
+		int64_t required = this->size + count;
+		if (count < 0 || required < this->size || (uint64_t)required > (uint64_t)(size_t)-1)
+		{
+			throw Exception("Output is too large to be kept in memory!");
+		}
+		int64_t capacity = hmax(this->capacity, (int64_t)LITESER_WRITE_BUFFER_MIN);
+		while (capacity < required)
+		{
+			capacity = (capacity <= LITESER_WRITE_BUFFER_GROWTH_LIMIT ? capacity * 2 : capacity + LITESER_WRITE_BUFFER_GROWTH_LIMIT);
+		}
+		if ((uint64_t)capacity > (uint64_t)(size_t)-1)
+		{
+			capacity = required;
+		}
+		unsigned char* buffer = new unsigned char[(size_t)capacity];
+		if (this->size > 0)
+		{
+			memcpy(buffer, this->buffer, (size_t)this->size);
+		}
+		if (this->buffer != NULL)
+		{
+			delete[] this->buffer;
+		}
+		this->buffer = buffer;
+		this->capacity = capacity;
+	}
+
+}
@@ -0,0 +1,173 @@
+/// @file
+/// @version 3.1
+/// 
+/// @section LICENSE
+/// 
+/// This program is free software; you can redistribute it and/or modify it under
+/// the terms of the BSD license: http://opensource.org/licenses/BSD-3-Clause
+/// 
+/// @section DESCRIPTION
+/// 
+/// Represents a write-combining buffer in front of a stream.
+
+#ifndef LITESER_WRITER_H
+#define LITESER_WRITER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <hltypes/hltypesUtil.h>
+#include <hltypes/hsbase.h>
+#include <hltypes/hstring.h>
+
+#include "Compression.h"
+#include "Encoding.h"
+#include "liteserExport.h" // LITESER_BIG_ENDIAN
+
+namespace liteser
+{
+	/// @brief Collects binary output in memory and passes it to the stream in large chunks.
+	/// @note The same encoding as in hsbase is used so the data can be read by hsbase::load*() as well.
+	class Writer
+	{
+	public:
+		Writer();
+		~Writer();
+
+		/// @brief Position in the whole output, including data that was already flushed.
+		inline int64_t position() const { return (this->flushed + this->size); }
+		/// @brief Output that was not passed to the stream yet, i.e. all output if there is no stream.
+		inline const unsigned char* getData() const { return this->buffer; }
+		inline int64_t getSize() const { return this->size; }
+		/// @brief Gets the free memory in the buffer, so code outside of the writer can encode directly into it.
+		inline void _getCursor(unsigned char** current, unsigned char** end) const
+		{
+			*current = this->buffer + this->size;
+			*end = this->buffer + this->capacity;
+		}
+		/// @brief Continues after data that was encoded directly.
+		inline void _setCursor(unsigned char* current)
+		{
+			this->size = current - this->buffer;
+		}
+
+		inline void dump(char value)			{ *this->_advance(1) = (unsigned char)value; }
+		inline void dump(unsigned char value)	{ *this->_advance(1) = value; }
+		inline void dump(short value)			{ this->_dump(value); }
+		inline void dump(unsigned short value)	{ this->_dump(value); }
+		inline void dump(int value)				{ this->_dump(value); }
+		inline void dump(unsigned int value)	{ this->_dump(value); }
+		inline void dump(int64_t value)			{ this->_dump(value); }
+		inline void dump(uint64_t value)		{ this->_dump(value); }
+		inline void dump(float value)			{ this->_dump(value); }
+		inline void dump(double value)			{ this->_dump(value); }
+		inline void dump(bool value)			{ *this->_advance(1) = (value ? 1 : 0); }
+
+		inline void dumpVarint(uint64_t value)
+		{
+			if (value < 0x80)
+			{
+				*this->_advance(1) = (unsigned char)value;
+				return;
+			}
+			unsigned char data[LITESER_VARINT_MAX_SIZE];
+			int size = (int)(_writeVarint(data, value) - data);
+			memcpy(this->_advance(size), data, size);
+		}
+
+		inline void dump(chstr value)
+		{
+			unsigned int size = value.size();
+			this->_dump(size);
+			if (size > 0)
+			{
+				this->writeRaw(value.cStr(), (int)size);
+			}
+		}
+
+		void writeRaw(const void* data, int count);
+
+		/// @brief Writes a placeholder for a value that is only known after more data was written.
+		/// @return Position of the placeholder to be used with patchUint32().
+		/// @note Compressed output is not flushed while there are placeholders that were not patched yet, other output is patched in the stream.
+		int64_t reserveUint32();
+		void patchUint32(int64_t position, unsigned int value);
+		/// @brief Overwrites a value anywhere in the output, even if it was already passed to the stream.
+		/// @note The stream has to support seeking if the value was already passed to it. Compressed output cannot be overwritten once it was passed to the stream.
+		void overwriteUint32(int64_t position, unsigned int value);
+		void overwriteUint64(int64_t position, uint64_t value);
+
+		/// @brief Starts collecting output for a stream.
+		/// @note Without a stream all output is kept in memory.
+		void open(hsbase* stream);
+		/// @brief Writes all collected output to the stream.
+		void flush();
+		/// @brief Everything written from now on is split into blocks that are compressed independently.
+		void beginCompression();
+		/// @brief Compresses the remaining output and marks the end of the compressed blocks.
+		void endCompression();
+
+	protected:
+		hsbase* stream;
+		unsigned char* buffer;
+		int64_t size;
+		int64_t capacity;
+		int64_t flushed;
+		/// @brief Number of bytes that were passed to the stream, less than flushed if output was compressed.
+		int64_t written;
+		/// @brief Position where compressed output starts, -1 if nothing was compressed.
+		int64_t compressedFrom;
+		int pendingPatches;
+		bool compressed;
+		unsigned char* compressionBuffer;
+		int64_t compressionCapacity;
+		/// @brief Buffer that output is collected in while the previous buffer is compressed.
+		unsigned char* spareBuffer;
+		int64_t spareCapacity;
+		CompressionJob compressionJob;
+		/// @brief Whether compressionJob is still running or its blocks were not written yet.
+		bool compressing;
+
+		/// @brief Starts compressing the collected output in the background and continues in the spare buffer.
+		void _flushCompressed();
+		/// @brief Waits for the blocks that are compressed in the background and writes them to the stream.
+		void _writeCompressed();
+		void _overwrite(int64_t position, const unsigned char* data, int count);
+		static void _encodeUint32(unsigned char* data, unsigned int value);
+		static void _encodeUint64(unsigned char* data, uint64_t value);
+		/// @brief Whether the collected output can be passed to the stream now.
+		inline bool _canFlush() const { return (this->stream != NULL && (this->pendingPatches == 0 || !this->compressed)); }
+		/// @brief Makes room for the given number of bytes, either by flushing or by growing the buffer.
+		void _makeRoom(int64_t count);
+
+		inline unsigned char* _advance(int64_t count)
+		{
+			if (this->size + count > this->capacity)
+			{
+				this->_makeRoom(count);
+			}
+			unsigned char* result = this->buffer + this->size;
+			this->size += count;
+			return result;
+		}
+
+		template <typename T>
+		inline void _dump(T value)
+		{
+#ifdef LITESER_BIG_ENDIAN
+			unsigned char* bytes = (unsigned char*)&value;
+			unsigned char temp = 0;
+			for_iter (i, 0, (int)sizeof(T) / 2)
+			{
+				temp = bytes[i];
+				bytes[i] = bytes[sizeof(T) - 1 - i];
+				bytes[sizeof(T) - 1 - i] = temp;
+			}
+#endif
+			memcpy(this->_advance(sizeof(T)), &value, sizeof(T));
+		}
+
+	};
+
+}
+#endif
@@ -20,13 +20,16 @@
 #include <hlxml/Document.h>
 #include <hlxml/Node.h>
 
+#include "Context.h"
 #include "Deserialize.h"
 #include "DeserializeXml.h"
 #include "Header.h"
 #include "liteser.h"
+#include "MappedFile.h"
 #include "Serializable.h"
 #include "Serialize.h"
 #include "SerializeXml.h"
+#include "Snapshot.h"
 #include "Utility.h"
 #include "Variable.h"
 
@@ -38,93 +41,131 @@
 #define LITESER_XML_ROOT_END "\n</Liteser>"
 
 #define DEFINE_HARRAY_SERIALIZER(type) \
-	bool serialize(hsbase* stream, harray<type>& value, bool allowMultiReferencing, bool stringPooling) \
+	bool serialize(hsbase* stream, harray<type>& value, const Options& options) \
 	{ \
 		if (!stream->isOpen()) \
 		{ \
 			throw FileNotOpenException("Liteser Stream"); \
 		} \
-		_start(stream); \
-		Header header(allowMultiReferencing, stringPooling); \
+		Context context(stream); \
+		context.beginWriting(); \
+		Header header(options); \
 		_setup(stream, header); \
-		_writeHeader(stream, header); \
+		_writeHeader(context.writer, header); \
+		if (header.compressed) \
+		{ \
+			_beginCompression(); \
+		} \
 		_dumpHarray(&value); \
-		_finish(stream); \
+		_finishHeader(context.writer, header); \
+		context.finishWriting(); \
 		return true; \
+	} \
+	\
+	bool serialize(hsbase* stream, harray<type>& value, bool allowMultiReferencing, bool stringPooling) \
+	{ \
+		return serialize(stream, value, Options(allowMultiReferencing, stringPooling)); \
 	}
 	
 #define DEFINE_HARRAY_DESERIALIZER(type) \
-	bool deserialize(hsbase* stream, harray<type>* value) \
+	static void _deserialize(harray<type>* value) \
 	{ \
-		if (!stream->isOpen()) \
-		{ \
-			throw FileNotOpenException("Liteser Stream"); \
-		} \
 		if (value->size() > 0) \
 		{ \
 			throw Exception("Output harray is not empty!"); \
 		} \
-		_start(stream); \
+		_context->beginReading(); \
 		unsigned int size = 0; \
 		Header header; \
-		_readHeader(stream, header); \
-		_setup(stream, header); \
+		_readHeader(_context->reader, header); \
+		_setup(_context->stream, header); \
+		if (header.compressed) \
+		{ \
+			_context->beginDecompression(); \
+		} \
 		_checkVersion(); \
+		if (header.delta) \
+		{ \
+			throw Exception("Cannot load delta data, it has to be applied with applyDelta()!"); \
+		} \
+		if (header.indexed) \
+		{ \
+			_context->finishReading(_loadIndexedHarray(value)); \
+			return; \
+		} \
+		if (header.columnar) \
+		{ \
+			_loadColumnarHarray(value); \
+			_context->finishReading(); \
+			return; \
+		} \
 		if (header.version.major > 2 || (header.version.major == 2 && header.version.minor >= 7)) \
 		{ \
 			if (_loadIdentifier() != Type::Identifier::Harray) \
 			{ \
-				_finish(stream); \
 				throw Exception("Cannot load object from file that does not contain a harray<" #type ">!"); \
 			} \
-			size = stream->loadUint32(); \
+			size = _loadCount(); \
 			if (size > 0) \
 			{ \
-				if (stream->loadUint32() != 1) \
+				if (_loadCount() != 1) \
 				{ \
-					_finish(stream); \
 					throw Exception("Cannot load object from file that does not contain a harray<" #type ">!"); \
 				} \
 				Type subType; \
 				subType.assign((VPtr<type>*)NULL); \
 				if (_loadIdentifier() != subType.identifier) \
 				{ \
-					_finish(stream); \
 					throw Exception("Cannot load object from file that does not contain a harray<" #type ">!"); \
 				} \
+				_skipBlockPrefix(subType.identifier); \
 			} \
 		} \
 		else \
 		{ \
-			size = stream->loadUint32(); \
+			size = _context->reader.loadUint32(); \
 		} \
 		_loadHarray(value, size); \
-		_finish(stream); \
+		_context->finishReading(); \
+	} \
+	\
+	bool deserialize(hsbase* stream, harray<type>* value) \
+	{ \
+		if (!stream->isOpen()) \
+		{ \
+			throw FileNotOpenException("Liteser Stream"); \
+		} \
+		Context context(stream); \
+		_deserialize(value); \
 		return true; \
 	}
 
 #define DEFINE_HARRAY_SERIALIZER_XML(type) \
-	bool serialize(hsbase* stream, harray<type>& value, bool allowMultiReferencing) \
+	bool serialize(hsbase* stream, harray<type>& value, const Options& options) \
 	{ \
 		if (!stream->isOpen()) \
 		{ \
 			throw FileNotOpenException("Liteser XML Stream"); \
 		} \
-		_start(stream); \
-		Header header(allowMultiReferencing, false); \
+		Context context(stream); \
+		Header header(options.allowMultiReferencing, false); \
 		_setup(stream, header); \
 		stream->writeLine(XML_HEADER); \
 		stream->writeLine(LITESER_XML_ROOT_BEGIN); \
 		Type subType; \
 		subType.assign((VPtr<type>*)NULL); \
 		stream->writeLine("\t<Container type=\"" + hsprintf("%02X", Type::Identifier::Harray.value) + "\" sub_types=\"" + hsprintf("%02X", subType.identifier.value) + "\">"); \
-		_indent += "\t"; \
+		_context->indent += "\t"; \
 		xml::_dumpHarray(&value); \
-		_indent = _indent(0, _indent.size() - 1); \
+		_context->indent = _context->indent(0, _context->indent.size() - 1); \
 		stream->writeLine("\t</Container>"); \
 		stream->writeLine(LITESER_XML_ROOT_END); \
-		_finish(stream); \
 		return true; \
+	} \
+	\
+	bool serialize(hsbase* stream, harray<type>& value, bool allowMultiReferencing) \
+	{ \
+		return xml::serialize(stream, value, Options(allowMultiReferencing, true)); \
 	}
 	
 #define DEFINE_HARRAY_DESERIALIZER_XML(type) \
@@ -138,7 +179,7 @@
 		{ \
 			throw Exception("Output harray is not empty!"); \
 		} \
-		_start(stream); \
+		Context context(stream); \
 		hlxml::Document doc(*stream); \
 		hlxml::Node* root = doc.root(); \
 		Header header; \
@@ -150,7 +191,6 @@
 		{ \
 			if (root->children.size() != 1 || root->children.first()->name != "Container" || root->children.first()->pstr("type", "00").unhex() != Type::Identifier::Harray.value) \
 			{ \
-				_finish(stream); \
 				throw Exception("Cannot load object from file that does not contain a harray<\"" #type "\">!"); \
 			} \
 			node = root->children.first(); \
@@ -159,37 +199,62 @@
 			harray<hstr> subTypes = node->pstr("sub_types", "00").split(',', -1, true); \
 			if (subTypes.size() != 1 || subTypes.first().unhex() != subType.identifier.value) \
 			{ \
-				_finish(stream); \
 				throw Exception("Cannot load object from file that does not contain a harray<" #type ">!"); \
 			} \
 		} \
 		xml::_loadHarray(node, value); \
-		_finish(stream); \
 		return true; \
 	}
 
 namespace liteser
 {
+	static int64_t _loadIndexedHarray(harray<Serializable*>* value)
+	{
+		return _loadIndexedElements(value, 0, -1);
+	}
+
+	template <typename T>
+	static int64_t _loadIndexedHarray(harray<T>*)
+	{
+		throw Exception("Indexed data can only be loaded into a harray<Serializable*>!");
+	}
+
+	template <typename T>
+	static void _loadColumnarHarray(harray<T>*)
+	{
+		throw Exception("Columnar data can only be loaded into a harray<Serializable*>!");
+	}
+
 	hstr logTag = "liteser";
-	hversion version(3, 1);
+	hversion version(3, 2);
 
-	bool serialize(hsbase* stream, Serializable* object, bool allowMultiReferencing, bool stringPooling)
+	bool serialize(hsbase* stream, Serializable* object, const Options& options)
 	{
 		if (!stream->isOpen())
 		{
 			throw FileNotOpenException("Liteser Stream");
 		}
-		// TODO - add exception handling
-		_start(stream);
-		Header header(allowMultiReferencing, stringPooling);
+		Context context(stream);
+		context.beginWriting();
+		Header header(options);
 		_setup(stream, header);
-		_writeHeader(stream, header);
+		_writeHeader(context.writer, header);
+		if (header.compressed)
+		{
+			_beginCompression();
+		}
 		_dumpType(Type::Identifier::Object);
 		_dump(&object);
-		_finish(stream);
+		_finishHeader(context.writer, header);
+		context.finishWriting();
 		return true;
 	}
 
+	bool serialize(hsbase* stream, Serializable* object, bool allowMultiReferencing, bool stringPooling)
+	{
+		return serialize(stream, object, Options(allowMultiReferencing, stringPooling));
+	}
+
 	DEFINE_HARRAY_SERIALIZER(Serializable*);
 	DEFINE_HARRAY_SERIALIZER(char);
 	DEFINE_HARRAY_SERIALIZER(unsigned char);
@@ -214,33 +279,45 @@ namespace liteser
 	DEFINE_HARRAY_SERIALIZER(gvec2d);
 	DEFINE_HARRAY_SERIALIZER(gvec3d);
 
-	bool deserialize(hsbase* stream, Serializable** object)
+	static void _deserialize(Serializable** object)
 	{
-		if (!stream->isOpen())
-		{
-			throw FileNotOpenException("Liteser Stream");
-		}
 		if (*object != NULL)
 		{
 			throw Exception("Given pointer to object for deserialization is not NULL.");
 		}
-		// TODO - add exception handling
-		_start(stream);
+		_context->beginReading();
 		Header header;
-		_readHeader(stream, header);
-		_setup(stream, header);
+		_readHeader(_context->reader, header);
+		_setup(_context->stream, header);
+		if (header.compressed)
+		{
+			_context->beginDecompression();
+		}
 		_checkVersion();
+		if (header.delta)
+		{
+			throw Exception("Cannot load delta data, it has to be applied with applyDelta()!");
+		}
 		if (header.version.major > 2 || (header.version.major == 2 && header.version.minor >= 7)) // this compatibility could be limited to only 2.7 at some point
 		{
 			Type::Identifier identifier = _loadIdentifier();
 			if (identifier != Type::Identifier::Object)
 			{
-				_finish(stream);
 				throw Exception("Cannot load object from file that does not contain an object!");
 			}
 		}
 		_load(object);
-		_finish(stream);
+		_context->finishReading();
+	}
+
+	bool deserialize(hsbase* stream, Serializable** object)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		Context context(stream);
+		_deserialize(object);
 		return true;
 	}
 
@@ -268,26 +345,225 @@ namespace liteser
 	DEFINE_HARRAY_DESERIALIZER(gvec2d);
 	DEFINE_HARRAY_DESERIALIZER(gvec3d);
 
+	bool serializeIndexed(hsbase* stream, harray<Serializable*>& value)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		Context context(stream);
+		context.beginWriting();
+		// elements are decoded on their own so all objects and strings have to be referenced by IDs
+		Header header;
+		header.indexed = true;
+		_setup(stream, header);
+		_writeHeader(context.writer, header);
+		_dumpIndexedHarray(&value);
+		_finishHeader(context.writer, header);
+		context.finishWriting();
+		return true;
+	}
+
+	bool serializeColumnar(hsbase* stream, harray<Serializable*>& value, const Options& options)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		Context context(stream);
+		context.beginWriting();
+		// variables reference the elements by their IDs, arrays with objects of different classes are written as usual
+		Header header;
+		header.stringPooling = options.stringPooling;
+		header.compressed = options.compressed;
+		header.stringPoolSize = options.stringPoolSize;
+		header.columnar = _canDumpColumnar(&value);
+		_setup(stream, header);
+		_writeHeader(context.writer, header);
+		if (header.compressed)
+		{
+			_beginCompression();
+		}
+		if (header.columnar)
+		{
+			_dumpColumnarHarray(&value);
+		}
+		else
+		{
+			_dumpHarray(&value);
+		}
+		_finishHeader(context.writer, header);
+		context.finishWriting();
+		return true;
+	}
+
+	static void _readIndexedHeader()
+	{
+		// only the header is read at first, everything else is read from where the index says it is
+		_context->readRange(0, sizeof(fileDescriptor) + sizeof(unsigned int));
+		_context->reader.skip(sizeof(fileDescriptor));
+		unsigned int headerSize = _context->reader.loadUint32();
+		// the header is followed by the harray identifier, the element count and the offsets of the trailer and the end
+		_context->readRange(0, sizeof(fileDescriptor) + sizeof(unsigned int) + headerSize + 1 + sizeof(unsigned int) + sizeof(uint64_t) * 2);
+		Header header;
+		_readHeader(_context->reader, header);
+		_setup(_context->stream, header);
+		_checkVersion();
+		if (!header.indexed)
+		{
+			throw Exception("Cannot load elements from data that does not have an index!");
+		}
+	}
+
+	static void _deserializeElements(int start, int count, harray<Serializable*>* output)
+	{
+		_readIndexedHeader();
+		_context->finishReading(_loadIndexedElements(output, start, count));
+	}
+
+	bool deserializeElements(hsbase* stream, int start, int count, harray<Serializable*>* output)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		Context context(stream);
+		_deserializeElements(start, count, output);
+		return true;
+	}
+
+	bool deserializeElement(hsbase* stream, int index, Serializable** object, harray<Serializable*>* referencedElements)
+	{
+		if (*object != NULL)
+		{
+			throw Exception("Given pointer to object for deserialization is not NULL.");
+		}
+		harray<Serializable*> output;
+		deserializeElements(stream, index, 1, &output);
+		if (output.size() > 1 && referencedElements == NULL)
+		{
+			// the element references objects within the other elements so they cannot be released on their own
+			foreach (Serializable*, it, output)
+			{
+				Factory::release(*it);
+			}
+			throw Exception(hsprintf("Element %d references objects in other elements, they have to be loaded as well!", index));
+		}
+		*object = output.removeFirst();
+		if (referencedElements != NULL)
+		{
+			(*referencedElements) += output;
+		}
+		return true;
+	}
+
+	int getElementCount(hsbase* stream)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		Context context(stream);
+		_readIndexedHeader();
+		if (_loadIdentifier() != Type::Identifier::Harray)
+		{
+			throw Exception("Cannot load object from file that does not contain a harray<Serializable*>!");
+		}
+		int result = (int)_context->reader.loadUint32();
+		_context->finishReading(0);
+		return result;
+	}
+
+	bool takeSnapshot(Serializable* object, Snapshot* snapshot)
+	{
+		_dumpSnapshot(object, snapshot);
+		return true;
+	}
+
+	bool serializeDelta(hsbase* stream, Serializable* object, Snapshot* snapshot, const Options& options)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		if (snapshot->isEmpty() || snapshot->objects.first() != object)
+		{
+			throw Exception("The snapshot was not taken of the given object!");
+		}
+		Snapshot current;
+		_dumpSnapshot(object, &current);
+		Context context(stream);
+		context.beginWriting();
+		Header header;
+		header.stringPooling = options.stringPooling;
+		header.compressed = options.compressed;
+		header.stringPoolSize = options.stringPoolSize;
+		header.delta = true;
+		_setup(stream, header);
+		_writeHeader(context.writer, header);
+		if (header.compressed)
+		{
+			_beginCompression();
+		}
+		_dumpDelta(&current, snapshot);
+		_finishHeader(context.writer, header);
+		context.finishWriting();
+		return true;
+	}
+
+	static void _applyDelta(Serializable* object)
+	{
+		_context->beginReading();
+		Header header;
+		_readHeader(_context->reader, header);
+		_setup(_context->stream, header);
+		if (header.compressed)
+		{
+			_context->beginDecompression();
+		}
+		_checkVersion();
+		if (!header.delta)
+		{
+			throw Exception("Cannot apply data that is not a delta!");
+		}
+		_loadDelta(object);
+		_context->finishReading();
+	}
+
+	bool applyDelta(hsbase* stream, Serializable* object)
+	{
+		if (!stream->isOpen())
+		{
+			throw FileNotOpenException("Liteser Stream");
+		}
+		Context context(stream);
+		_applyDelta(object);
+		return true;
+	}
+
 	namespace xml
 	{
-		bool serialize(hsbase* stream, Serializable* object, bool allowMultiReferencing)
+		bool serialize(hsbase* stream, Serializable* object, const Options& options)
 		{
 			if (!stream->isOpen())
 			{
 				throw FileNotOpenException("Liteser Stream");
 			}
-			// TODO - add exception handling
-			_start(stream);
-			Header header(allowMultiReferencing, false);
+			Context context(stream);
+			Header header(options.allowMultiReferencing, false);
 			_setup(stream, header);
 			stream->writeLine(XML_HEADER);
 			stream->writeLine(LITESER_XML_ROOT_BEGIN);
 			xml::_dump(&object);
 			stream->writeLine(LITESER_XML_ROOT_END);
-			_finish(stream);
 			return true;
 		}
 
+		bool serialize(hsbase* stream, Serializable* object, bool allowMultiReferencing)
+		{
+			return xml::serialize(stream, object, Options(allowMultiReferencing, true));
+		}
+
 		DEFINE_HARRAY_SERIALIZER_XML(Serializable*);
 		DEFINE_HARRAY_SERIALIZER_XML(char);
 		DEFINE_HARRAY_SERIALIZER_XML(unsigned char);
@@ -322,8 +598,7 @@ namespace liteser
 			{
 				throw Exception("Given pointer to object for deserialization is not NULL.");
 			}
-			// TODO - add exception handling
-			_start(stream);
+			Context context(stream);
 			hlxml::Document doc(*stream);
 			hlxml::Node* root = doc.root();
 			Header header;
@@ -335,13 +610,11 @@ namespace liteser
 			{
 				if (root->children.size() != 1 || root->children.first()->name != "Object")
 				{
-					_finish(stream);
 					throw Exception("Cannot load object from file that does not contain one object!");
 				}
 				node = root->children.first();
 			}
 			xml::_load(node, object);
-			_finish(stream);
 			return true;
 		}
 
@@ -379,6 +652,15 @@ namespace liteser
 		if (hfile::exists(pathLsb))
 		{
 			hlog::write(logTag, "Loading: " + pathLsb);
+			// the context keeps the file mapped for lazy objects
+			MappedFile* file = new MappedFile();
+			if (file->open(pathLsb))
+			{
+				Context context(file);
+				_deserialize(object);
+				return true;
+			}
+			delete file;
 			stream.open(pathLsb);
 			deserialize(&stream, object);
 			return true;
@@ -431,6 +713,14 @@ namespace liteser
 		if (hfile::exists(pathLsb))
 		{
 			hlog::write(logTag, "Loading: " + pathLsb);
+			MappedFile* file = new MappedFile();
+			if (file->open(pathLsb))
+			{
+				Context context(file);
+				_deserialize(dataArray);
+				return true;
+			}
+			delete file;
 			stream.open(pathLsb);
 			deserialize(&stream, dataArray);
 			return true;
@@ -449,6 +739,32 @@ namespace liteser
 		return false;
 	}
 
+	bool loadElementsFromFile(chstr path, int start, int count, harray<liteser::Serializable*>* dataArray, bool warn)
+	{
+		hstr pathLsb = path + LS3_EXTENSION;
+		if (hfile::exists(pathLsb))
+		{
+			hlog::write(logTag, "Loading: " + pathLsb);
+			MappedFile* file = new MappedFile();
+			if (file->open(pathLsb))
+			{
+				Context context(file);
+				_deserializeElements(start, count, dataArray);
+				return true;
+			}
+			delete file;
+			hfile stream;
+			stream.open(pathLsb);
+			deserializeElements(&stream, start, count, dataArray);
+			return true;
+		}
+		if (warn)
+		{
+			hlog::warn(logTag, "Could not load: " + path);
+		}
+		return false;
+	}
+
 	bool loadArrayFromResource(chstr path, harray<liteser::Serializable*>* dataArray, bool warn)
 	{
 		hstr pathLsb = path + LS3_EXTENSION;
@@ -556,16 +872,22 @@ namespace liteser
 			throw Exception("Output does not point to NULL!");
 		}
 		hstream stream;
-		_start(&stream);
 		Header header(true, true);
-		_setup(&stream, header);
-		_dump(&input);
-		_finish(&stream);
+		{
+			Context context(&stream);
+			context.beginWriting();
+			_setup(&stream, header);
+			_dump(&input);
+			context.finishWriting();
+			_countStrings(header);
+		}
 		stream.rewind();
-		_start(&stream);
-		_setup(&stream, header);
-		_load(output);
-		_finish(&stream);
+		{
+			Context context(&stream);
+			context.beginReading();
+			_setup(&stream, header);
+			_load(output);
+		}
 		return true;
 	}
 